@@ -0,0 +1,510 @@
+// Copyright 2023 Mustafa Serdar Sanli
+//
+// This file is part of FloatInfo.
+//
+// FloatInfo is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// FloatInfo is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with FloatInfo.  If not, see <https://www.gnu.org/licenses/>.
+
+// IEEE 754 decimal interchange formats, decimal32, decimal64 and decimal128. An encoding is the
+// sign, a combination field with the exponent and the leading digit (or leading bits) of the
+// coefficient, and a trailing field with the rest of the coefficient. The coefficient is either a
+// binary integer (BID) or densely packed decimal (DPD), three digits per 10-bit declet.
+//
+// Declets are decoded and encoded through lookup tables built at compile time. Binary coefficients
+// are split into groups of three digits with reciprocal multiplications, so neither direction
+// has a division.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <type_traits>
+
+// Value of a declet, from its bits pqr stu v wxy as in table 3.3 of IEEE 754-2008. The 24
+// non-canonical declets, those with v = 1, wx = 11, st = 11 and pq other than 00, decode as if pq
+// were 00.
+constexpr uint16_t DecodeDeclet(uint32_t d)
+{
+    uint32_t pqr = d >> 7, stu = (d >> 4) & 7, wxy = d & 7;
+    uint32_t pq = d >> 8, r = (d >> 7) & 1, st = (d >> 5) & 3, u = (d >> 4) & 1, wx = (d >> 1) & 3, y = d & 1;
+
+    uint32_t d1 = pqr, d2 = stu, d3 = wxy;
+    if ((d >> 3) & 1)
+    {
+        switch (wx)
+        {
+        case 0: d3 = 8 + y; break;
+        case 1: d2 = 8 + u; d3 = st << 1 | y; break;
+        case 2: d1 = 8 + r; d3 = pq << 1 | y; break;
+        case 3:
+            switch (st)
+            {
+            case 0: d1 = 8 + r; d2 = 8 + u; d3 = pq << 1 | y; break;
+            case 1: d1 = 8 + r; d2 = pq << 1 | u; d3 = 8 + y; break;
+            case 2: d1 = pqr; d2 = 8 + u; d3 = 8 + y; break;
+            case 3: d1 = 8 + r; d2 = 8 + u; d3 = 8 + y; break;
+            }
+            break;
+        }
+    }
+    return d1 * 100 + d2 * 10 + d3;
+}
+
+// Canonical declet of 0..999, by which of the three digits are 8 or 9
+constexpr uint16_t EncodeDeclet(uint32_t n)
+{
+    uint32_t d1 = n / 100, d2 = n / 10 % 10, d3 = n % 10;
+    uint32_t big = (d1 >= 8) << 2 | (d2 >= 8) << 1 | (d3 >= 8);
+    uint32_t m = d3 & 1;
+    switch (big)
+    {
+    case 0: return d1 << 7 | d2 << 4 | d3;
+    case 1: return d1 << 7 | d2 << 4 | 0b1000 | m;
+    case 2: return d1 << 7 | (d3 >> 1) << 5 | (d2 & 1) << 4 | 0b1010 | m;
+    case 3: return d1 << 7 | 0b10 << 5 | (d2 & 1) << 4 | 0b1110 | m;
+    case 4: return (d3 >> 1) << 8 | (d1 & 1) << 7 | d2 << 4 | 0b1100 | m;
+    case 5: return (d2 >> 1) << 8 | (d1 & 1) << 7 | 0b01 << 5 | (d2 & 1) << 4 | 0b1110 | m;
+    case 6: return (d3 >> 1) << 8 | (d1 & 1) << 7 | 0b00 << 5 | (d2 & 1) << 4 | 0b1110 | m;
+    default: return (d1 & 1) << 7 | 0b11 << 5 | (d2 & 1) << 4 | 0b1110 | m;
+    }
+}
+
+struct DpdTables
+{
+    uint16_t toBinary[1024]; // every declet, the non-canonical ones too
+    uint16_t toDpd[1000];
+
+    constexpr DpdTables()
+        : toBinary()
+        , toDpd()
+    {
+        for (uint32_t d = 0; d < 1024; ++d)
+        {
+            toBinary[d] = DecodeDeclet(d);
+        }
+        for (uint32_t n = 0; n < 1000; ++n)
+        {
+            toDpd[n] = EncodeDeclet(n);
+        }
+    }
+};
+
+inline constexpr DpdTables Dpd;
+
+// floor(x / D) and the remainder. The quotient estimated with the reciprocal is at most one
+// below, which the remainder corrects.
+template <uint64_t D>
+inline uint64_t DivRemSmall(uint64_t x, uint64_t &rem)
+{
+    constexpr uint64_t Reciprocal = ~0ull / D;
+    uint64_t q = (uint64_t)(((unsigned __int128)x * Reciprocal) >> 64);
+    uint64_t r = x - q * D;
+    uint64_t over = r >= D;
+    rem = r - over * D;
+    return q + over;
+}
+
+// floor(x / 10**18) and the remainder for x below 10**34, from the top 64 bits of x, which is at
+// most two below
+inline uint64_t DivRem1e18(unsigned __int128 x, uint64_t &rem)
+{
+    constexpr uint64_t D = 1000000000000000000ull;
+    constexpr uint64_t Reciprocal = (uint64_t)(((unsigned __int128)1 << 113) / D);
+    uint64_t q = (uint64_t)(((unsigned __int128)(uint64_t)(x >> 49) * Reciprocal) >> 64);
+    unsigned __int128 r = x - (unsigned __int128)q * D;
+    while (r >= D)
+    {
+        r -= D;
+        ++q;
+    }
+    rem = (uint64_t)r;
+    return q;
+}
+
+// Writes the groups of three digits of x below 10**9, least significant first. x / 1000 is a
+// multiplication that is exact for every uint32.
+inline void SplitThousands9(uint32_t x, uint16_t *groups)
+{
+    for (int i = 0; i < 3; ++i)
+    {
+        uint32_t q = (uint32_t)(((uint64_t)x * 274877907) >> 38);
+        groups[i] = x - q * 1000;
+        x = q;
+    }
+}
+
+template <int NumBits, bool IsDpd>
+struct DecimalCodec
+{
+    static_assert(NumBits == 32 || NumBits == 64 || NumBits == 128);
+
+    using Storage = std::conditional_t<(NumBits > 64), unsigned __int128, uint64_t>;
+
+    static constexpr int NumDeclets = NumBits == 32 ? 2 : NumBits == 64 ? 5 : 11;
+    static constexpr int Precision = 3 * NumDeclets + 1;
+    static constexpr int NumTrailingBits = 10 * NumDeclets;
+    static constexpr int NumExponentContinuationBits = NumBits - 6 - NumTrailingBits;
+    static constexpr int NumCombinationBits = NumExponentContinuationBits + 5;
+
+    static constexpr int Emax = 3 << (NumExponentContinuationBits - 1);
+    static constexpr int Bias = Emax + Precision - 2;
+    static constexpr int MaxBiasedExponent = (3 << NumExponentContinuationBits) - 1;
+
+    static constexpr Storage Pow10(int n)
+    {
+        Storage res = 1;
+        for (int i = 0; i < n; ++i)
+        {
+            res *= 10;
+        }
+        return res;
+    }
+    static constexpr Storage MaxCoefficient = Pow10(Precision) - 1;
+
+    struct PowerTable
+    {
+        Storage values[Precision + 1];
+
+        constexpr PowerTable()
+            : values()
+        {
+            for (int i = 0; i <= Precision; ++i)
+            {
+                values[i] = Pow10(i);
+            }
+        }
+    };
+    static constexpr PowerTable PowersOf10 = {};
+    static constexpr Storage TrailingMask = ((Storage)1 << NumTrailingBits) - 1;
+
+    enum Kind { Finite, Infinite, QuietNaN, SignalingNaN };
+
+    // Value is (-1)**sign * coefficient * 10**(exponent - Bias). NaNs have their payload as the
+    // coefficient.
+    struct Fields
+    {
+        Kind kind;
+        bool sign;
+        int exponent;
+        Storage coefficient;
+
+        bool operator==(const Fields &ot) const
+        {
+            return kind == ot.kind && sign == ot.sign && exponent == ot.exponent && coefficient == ot.coefficient;
+        }
+    };
+
+    // Groups of three digits of a coefficient, least significant first, and the leading digit
+    struct Digits
+    {
+        uint16_t groups[NumDeclets];
+        uint32_t leading;
+    };
+
+    static Digits Split(Storage c)
+    {
+        Digits res;
+        if constexpr (NumBits == 32)
+        {
+            uint32_t q = (uint32_t)(((uint64_t)c * 274877907) >> 38);
+            res.groups[0] = c - q * 1000;
+            uint32_t q2 = (uint32_t)(((uint64_t)q * 274877907) >> 38);
+            res.groups[1] = q - q2 * 1000;
+            res.leading = q2;
+        }
+        else if constexpr (NumBits == 64)
+        {
+            uint64_t low;
+            uint64_t high = DivRemSmall<1000000000>(c, low);
+            uint16_t highGroups[3];
+            SplitThousands9(low, res.groups);
+            SplitThousands9(high, highGroups);
+            res.groups[3] = highGroups[0];
+            res.groups[4] = highGroups[1];
+            res.leading = highGroups[2];
+        }
+        else
+        {
+            // 18 low digits in two halves of nine, and 16 high digits as in decimal64
+            uint64_t low;
+            uint64_t high = DivRem1e18(c, low);
+            uint64_t lowLow;
+            uint64_t lowHigh = DivRemSmall<1000000000>(low, lowLow);
+            SplitThousands9(lowLow, res.groups);
+            SplitThousands9(lowHigh, res.groups + 3);
+            uint64_t highLow;
+            uint64_t highHigh = DivRemSmall<1000000000>(high, highLow);
+            uint16_t highGroups[3];
+            SplitThousands9(highLow, res.groups + 6);
+            SplitThousands9(highHigh, highGroups);
+            res.groups[9] = highGroups[0];
+            res.groups[10] = highGroups[1];
+            res.leading = highGroups[2];
+        }
+        return res;
+    }
+
+    // Coefficient of the leading digit and the declets of a trailing field. Decimal128 sums two
+    // halves of at most 18 digits in 64 bits and only joins them in 128 bits.
+    static Storage FromDeclets(Storage trailing, uint32_t leading)
+    {
+        constexpr int HighDeclets = NumDeclets <= 5 ? NumDeclets : 5;
+        uint64_t high = leading;
+        for (int i = NumDeclets - 1; i >= NumDeclets - HighDeclets; --i)
+        {
+            high = high * 1000 + Dpd.toBinary[(uint32_t)(trailing >> (10 * i)) & 1023];
+        }
+        if constexpr (NumDeclets <= 5)
+        {
+            return high;
+        }
+        else
+        {
+            uint64_t low = 0;
+            for (int i = NumDeclets - HighDeclets - 1; i >= 0; --i)
+            {
+                low = low * 1000 + Dpd.toBinary[(uint32_t)(trailing >> (10 * i)) & 1023];
+            }
+            return (Storage)high * 1000000000000000000ull + low;
+        }
+    }
+
+    static Storage ToDeclets(const Digits &digits)
+    {
+        Storage res = 0;
+        for (int i = NumDeclets - 1; i >= 0; --i)
+        {
+            res = res << 10 | Dpd.toDpd[digits.groups[i]];
+        }
+        return res;
+    }
+
+    // Non-canonical coefficients, BID ones past MaxCoefficient and NaN payloads of Precision
+    // digits or more, are zero.
+    static Fields Decode(Storage val)
+    {
+        Fields res = {};
+        res.sign = (val >> (NumBits - 1)) & 1;
+        uint32_t g = (uint32_t)(val >> NumTrailingBits) & ((1u << NumCombinationBits) - 1);
+        uint32_t top = g >> NumExponentContinuationBits;
+        Storage trailing = val & TrailingMask;
+
+        if (top >= 0b11110)
+        {
+            if (top == 0b11110)
+            {
+                res.kind = Infinite;
+                return res;
+            }
+            res.kind = ((g >> (NumExponentContinuationBits - 1)) & 1) ? SignalingNaN : QuietNaN;
+            Storage payload = IsDpd ? FromDeclets(trailing, 0) : trailing;
+            res.coefficient = payload <= MaxCoefficient / 10 ? payload : 0;
+            return res;
+        }
+
+        res.kind = Finite;
+        constexpr int W = NumExponentContinuationBits;
+        if constexpr (IsDpd)
+        {
+            uint32_t exponentHigh = (top >> 3) == 3 ? (top >> 1) & 3 : top >> 3;
+            uint32_t leading = (top >> 3) == 3 ? 8 + (top & 1) : top & 7;
+            res.exponent = exponentHigh << W | (g & ((1u << W) - 1));
+            res.coefficient = FromDeclets(trailing, leading);
+        }
+        else
+        {
+            Storage coefficient;
+            if ((top >> 3) == 3)
+            {
+                res.exponent = (g >> 1) & ((1u << (W + 2)) - 1);
+                coefficient = (Storage)(8 | (g & 1)) << NumTrailingBits | trailing;
+            }
+            else
+            {
+                res.exponent = g >> 3;
+                coefficient = (Storage)(g & 7) << NumTrailingBits | trailing;
+            }
+            res.coefficient = coefficient <= MaxCoefficient ? coefficient : 0;
+        }
+        return res;
+    }
+
+    // Canonical encoding, the coefficient needs to be at most MaxCoefficient and the exponent at
+    // most MaxBiasedExponent. NaN payloads past the trailing field are dropped.
+    static Storage Encode(const Fields &f)
+    {
+        constexpr int W = NumExponentContinuationBits;
+        Storage sign = (Storage)f.sign << (NumBits - 1);
+        if (f.kind == Infinite)
+        {
+            return sign | (Storage)0b11110 << (NumBits - 6);
+        }
+        if (f.kind != Finite)
+        {
+            Storage nan = (Storage)(f.kind == SignalingNaN ? 0b111111 : 0b111110) << (NumBits - 7);
+            Storage payload = f.coefficient <= MaxCoefficient / 10 ? f.coefficient : 0;
+            return sign | nan | (IsDpd ? ToDeclets(Split(payload)) : payload);
+        }
+
+        uint32_t e = f.exponent;
+        if constexpr (IsDpd)
+        {
+            Digits digits = Split(f.coefficient);
+            uint32_t g = digits.leading < 8
+                ? (e >> W) << (W + 3) | digits.leading << W | (e & ((1u << W) - 1))
+                : 0b11u << (W + 3) | (e >> W) << (W + 1) | (digits.leading & 1) << W | (e & ((1u << W) - 1));
+            return sign | (Storage)g << NumTrailingBits | ToDeclets(digits);
+        }
+        else
+        {
+            if ((f.coefficient >> (NumTrailingBits + 3)) == 0)
+            {
+                return sign | (Storage)e << (NumTrailingBits + 3) | f.coefficient;
+            }
+            Storage low = f.coefficient & (((Storage)1 << (NumTrailingBits + 1)) - 1);
+            return sign | (Storage)0b11 << (NumBits - 3) | (Storage)e << (NumTrailingBits + 1) | low;
+        }
+    }
+};
+
+
+#ifdef RUN_TEST
+
+#include <stdio.h>
+#include <random>
+
+static int gFailures = 0;
+
+static void Expect(bool ok, const char *what)
+{
+    if (!ok)
+    {
+        fprintf(stderr, "failed: %s\n", what);
+        ++gFailures;
+    }
+}
+
+// Digits by repeated division, to check Split against
+template <typename Codec>
+static bool SplitMatches(typename Codec::Storage c)
+{
+    typename Codec::Digits digits = Codec::Split(c);
+    for (int i = 0; i < Codec::NumDeclets; ++i)
+    {
+        if (digits.groups[i] != c % 1000)
+        {
+            return false;
+        }
+        c /= 1000;
+    }
+    return digits.leading == c;
+}
+
+template <int NumBits>
+static void CheckFormat(std::mt19937_64 &rng)
+{
+    using Bid = DecimalCodec<NumBits, false>;
+    using Dpd = DecimalCodec<NumBits, true>;
+    using Storage = typename Bid::Storage;
+    using Fields = typename Bid::Fields;
+
+    auto random = [&]() { return NumBits == 128 ? (Storage)rng() << 64 | rng() : (Storage)(rng() >> (64 - (NumBits > 64 ? 64 : NumBits))); };
+
+    // Coefficients of every length, and around the powers of ten
+    bool splitOk = true;
+    for (int digits = 0; digits <= Bid::Precision; ++digits)
+    {
+        Storage p = Bid::Pow10(digits);
+        for (Storage c : { p - 1, p, p + 1 })
+        {
+            splitOk &= c > Bid::MaxCoefficient || SplitMatches<Bid>(c);
+        }
+    }
+    for (int i = 0; i < 200000; ++i)
+    {
+        splitOk &= SplitMatches<Bid>(random() % (Bid::MaxCoefficient + 1));
+    }
+    Expect(splitOk, "split");
+
+    // Every field combination encodes and decodes back in both encodings, and the BID and DPD
+    // decodings of a value agree
+    bool roundTripOk = true;
+    for (int i = 0; i < 200000; ++i)
+    {
+        Fields f = {};
+        f.kind = (typename Bid::Kind)(i % 16 == 0 ? rng() % 4 : 0);
+        f.sign = rng() & 1;
+        f.exponent = f.kind == Bid::Finite ? rng() % (Bid::MaxBiasedExponent + 1) : 0;
+        Storage limit = f.kind == Bid::Finite ? Bid::MaxCoefficient : f.kind == Bid::Infinite ? 0 : Bid::MaxCoefficient / 10;
+        f.coefficient = (i % 3 == 0 ? limit : random() % (limit + 1)) >> (rng() % 3 == 0 ? rng() % 100 : 0);
+
+        Fields bid = Bid::Decode(Bid::Encode(f));
+        typename Dpd::Fields dpd = Dpd::Decode(Dpd::Encode(typename Dpd::Fields{ (typename Dpd::Kind)f.kind, f.sign, f.exponent, f.coefficient }));
+        roundTripOk &= bid == f && dpd.kind == (typename Dpd::Kind)f.kind && dpd.sign == f.sign && dpd.exponent == f.exponent && dpd.coefficient == f.coefficient;
+    }
+    Expect(roundTripOk, "round trip");
+
+    // Canonical encodings are fixed points of decode and encode
+    bool canonicalOk = true;
+    for (int i = 0; i < 200000; ++i)
+    {
+        Storage v = random();
+        Storage bid = Bid::Encode(Bid::Decode(v));
+        Storage dpd = Dpd::Encode(Dpd::Decode(v));
+        canonicalOk &= Bid::Encode(Bid::Decode(bid)) == bid && Dpd::Encode(Dpd::Decode(dpd)) == dpd;
+    }
+    Expect(canonicalOk, "canonical");
+}
+
+int main()
+{
+    fprintf(stderr, "Running tests...\n");
+
+    // Each number has one canonical declet, and 24 declets are non-canonical
+    int numCanonical = 0;
+    bool decletsOk = true;
+    for (int n = 0; n < 1000; ++n)
+    {
+        decletsOk &= Dpd.toBinary[Dpd.toDpd[n]] == n && Dpd.toDpd[n] < 1024;
+    }
+    for (int d = 0; d < 1024; ++d)
+    {
+        numCanonical += Dpd.toDpd[Dpd.toBinary[d]] == d;
+    }
+    Expect(decletsOk && numCanonical == 1000, "declets");
+    Expect(Dpd.toDpd[999] == 0x0ff && Dpd.toDpd[888] == 0x06e && Dpd.toDpd[79] == 0x079 && Dpd.toBinary[0x3ff] == 999, "known declets");
+
+    // One in each format
+    Expect(DecimalCodec<32, false>::Encode({ DecimalCodec<32, false>::Finite, false, 101, 1 }) == 0x32800001, "decimal32 BID one");
+    Expect(DecimalCodec<32, true>::Encode({ DecimalCodec<32, true>::Finite, false, 101, 1 }) == 0x22500001, "decimal32 DPD one");
+    Expect(DecimalCodec<64, false>::Encode({ DecimalCodec<64, false>::Finite, false, 398, 1 }) == 0x31c0000000000001, "decimal64 BID one");
+    Expect(DecimalCodec<64, true>::Encode({ DecimalCodec<64, true>::Finite, false, 398, 1 }) == 0x2238000000000001, "decimal64 DPD one");
+    Expect(DecimalCodec<128, false>::Encode({ DecimalCodec<128, false>::Finite, false, 6176, 1 }) == ((unsigned __int128)0x3040000000000000 << 64 | 1), "decimal128 BID one");
+    Expect(DecimalCodec<128, true>::Encode({ DecimalCodec<128, true>::Finite, false, 6176, 1 }) == ((unsigned __int128)0x2208000000000000 << 64 | 1), "decimal128 DPD one");
+
+    // Largest finite values, whose BID coefficient needs the 11 form
+    Expect(DecimalCodec<32, false>::Encode({ DecimalCodec<32, false>::Finite, false, 191, 9999999 }) == 0x77f8967f, "decimal32 BID max");
+    Expect(DecimalCodec<32, true>::Encode({ DecimalCodec<32, true>::Finite, false, 191, 9999999 }) == 0x77f3fcff, "decimal32 DPD max");
+    Expect(DecimalCodec<64, false>::Decode(0x6c7386f26fc0ffff).coefficient == 9999999999999999, "decimal64 BID max");
+
+    // A BID coefficient past the largest one is zero
+    Expect(DecimalCodec<32, false>::Decode(0x6cb8967f + 1).coefficient == 0 && DecimalCodec<32, false>::Decode(0x6cb8967f).coefficient == 9999999, "non-canonical BID");
+
+    std::mt19937_64 rng(42);
+    CheckFormat<32>(rng);
+    CheckFormat<64>(rng);
+    CheckFormat<128>(rng);
+
+    fprintf(stderr, "test decimal = %d\n", gFailures == 0);
+    return gFailures != 0;
+}
+
+#endif
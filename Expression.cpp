@@ -0,0 +1,868 @@
+// Copyright 2023 Mustafa Serdar Sanli
+//
+// This file is part of FloatInfo.
+//
+// FloatInfo is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// FloatInfo is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with FloatInfo.  If not, see <https://www.gnu.org/licenses/>.
+
+// Arithmetic expressions like "(a + b) * (a - b) / 3.5", compiled once to a small stack bytecode
+// that runs on the encodings of any format through SoftFloat, one rounding per operation, and on
+// exact rationals as the reference the results are measured against.
+//
+// Included from floatinfo.cpp after SoftFloat.cpp.
+
+#include <ctype.h>
+#include <math.h>
+#include <stdint.h>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Below this many points per thread, starting the threads costs more than it saves
+constexpr size_t ExpressionMinPointsPerThread = 1 << 10;
+
+// (-1)**sign * num / den, with num and den kept as binary SimpleNumberBase. Denominators that are
+// powers of two are folded into num, so values made of +, - and * of binary floats never divide.
+struct ExactNumber
+{
+    using Number = SimpleNumberBase<2>;
+
+    bool defined = true; // false after a division by zero, or for infinite and NaN inputs
+    bool sign = false;
+    Number num;
+    Number den = Number::FromInteger(1);
+
+    static ExactNumber Undefined()
+    {
+        ExactNumber res;
+        res.defined = false;
+        return res;
+    }
+
+    static ExactNumber FromUnpacked(const Unpacked &u)
+    {
+        ExactNumber res;
+        res.sign = u.sign;
+        switch (u.kind)
+        {
+            case Unpacked::NaN:
+            case Unpacked::Infinite: return Undefined();
+            case Unpacked::Zero: return res;
+            case Unpacked::Finite: break;
+        }
+        res.num = Number::FromInteger(u.sig);
+        res.num._store._minExpo = u.exp;
+        res.Normalize();
+        return res;
+    }
+
+    // Decimal literals like 12, 0.1 or 1e-3. Returns false when text is not one.
+    static bool Parse(std::string_view text, ExactNumber &res)
+    {
+        res = ExactNumber();
+        int exp10 = 0;
+        size_t pos = 0;
+        bool anyDigits = false;
+        bool seenDot = false;
+        for (; pos < text.size(); ++pos)
+        {
+            char c = text[pos];
+            if (c == '.' && !seenDot)
+            {
+                seenDot = true;
+                continue;
+            }
+            if (!isdigit((unsigned char)c))
+            {
+                break;
+            }
+            res.num.MulSmall(10);
+            res.num = res.num + Number::FromInteger(c - '0');
+            exp10 -= seenDot;
+            anyDigits = true;
+        }
+        if (!anyDigits)
+        {
+            return false;
+        }
+
+        if (pos < text.size() && (text[pos] == 'e' || text[pos] == 'E'))
+        {
+            ++pos;
+            bool negative = (pos < text.size() && text[pos] == '-');
+            pos += (pos < text.size() && (text[pos] == '-' || text[pos] == '+'));
+            if (pos == text.size())
+            {
+                return false;
+            }
+            int e = 0;
+            for (; pos < text.size() && isdigit((unsigned char)text[pos]) && e < 100000; ++pos)
+            {
+                e = e * 10 + (text[pos] - '0');
+            }
+            exp10 += negative ? -e : e;
+        }
+        if (pos != text.size() || exp10 < -10000 || exp10 > 10000)
+        {
+            return false;
+        }
+
+        for (; exp10 > 0; --exp10)
+        {
+            res.num.MulSmall(10);
+        }
+        for (; exp10 < 0; ++exp10)
+        {
+            res.den.MulSmall(10);
+        }
+        res.Normalize();
+        return true;
+    }
+
+    bool IsZero() const
+    {
+        return num._store._digits.empty();
+    }
+
+    ExactNumber operator-() const
+    {
+        ExactNumber res = *this;
+        res.sign = !sign;
+        return res;
+    }
+
+    ExactNumber operator+(const ExactNumber &ot) const
+    {
+        if (!defined || !ot.defined)
+        {
+            return Undefined();
+        }
+
+        ExactNumber res;
+        Number a = MulDen(num, ot.den);
+        Number b = MulDen(ot.num, den);
+        res.den = MulDen(den, ot.den);
+        if (sign == ot.sign)
+        {
+            res.num = a + b;
+            res.sign = sign;
+        }
+        else if (a.Compare(b) >= 0)
+        {
+            res.num = a - b;
+            res.sign = sign;
+        }
+        else
+        {
+            res.num = b - a;
+            res.sign = ot.sign;
+        }
+        res.Normalize();
+        return res;
+    }
+
+    ExactNumber operator-(const ExactNumber &ot) const
+    {
+        return *this + -ot;
+    }
+
+    ExactNumber operator*(const ExactNumber &ot) const
+    {
+        if (!defined || !ot.defined)
+        {
+            return Undefined();
+        }
+
+        ExactNumber res;
+        res.sign = sign != ot.sign;
+        res.num = num * ot.num;
+        res.den = MulDen(den, ot.den);
+        res.Normalize();
+        return res;
+    }
+
+    ExactNumber operator/(const ExactNumber &ot) const
+    {
+        if (!defined || !ot.defined || ot.IsZero())
+        {
+            return Undefined();
+        }
+
+        ExactNumber res;
+        res.sign = sign != ot.sign;
+        res.num = MulDen(num, ot.den);
+        res.den = MulDen(den, ot.num);
+        res.Normalize();
+        return res;
+    }
+
+    // The value with a significand of QuotientBits bits, the bits below them jammed into the lowest
+    // one, for SoftFloatFormat::Round to round correctly in any mode
+    Unpacked ToUnpacked() const
+    {
+        if (!defined)
+        {
+            return Unpacked::Make(Unpacked::NaN);
+        }
+        if (IsZero())
+        {
+            return Unpacked::Make(Unpacked::Zero, sign);
+        }
+
+        constexpr int QuotientBits = 126;
+        Unpacked res = Unpacked::Make(Unpacked::Finite, sign);
+        res.exp = TopExpo(num) - TopExpo(den) - (QuotientBits - 1);
+
+        bool inexact = false;
+        Number quotient;
+        const Number *q = &num;
+        if (!IsOne(den) && num._store._digits.size() <= 64 && den._store._digits.size() <= 64)
+        {
+            // Both fit a word, as they do for all but the widest formats: divide bit by bit in
+            // 128-bit integers, the quotient having QuotientBits or QuotientBits + 1 bits
+            uint64_t n = ToWord(num);
+            uint64_t d = ToWord(den);
+            int shift = (QuotientBits - 1) - (int)num._store._digits.size() + (int)den._store._digits.size();
+            uint128 rem = n % d;
+            res.sig = n / d;
+            for (int i = 0; i < shift; ++i)
+            {
+                rem <<= 1;
+                res.sig <<= 1;
+                if (rem >= d)
+                {
+                    rem -= d;
+                    res.sig |= 1;
+                }
+            }
+            res.sig |= (rem != 0);
+            return res;
+        }
+        if (!IsOne(den))
+        {
+            quotient = num.Divide(den, res.exp, inexact);
+            q = &quotient;
+        }
+
+        for (int i = 0; i < (int)q->_store._digits.size(); ++i)
+        {
+            int bit = q->_store._minExpo + i - res.exp;
+            if (bit < 0)
+            {
+                inexact |= q->_store._digits[i] != 0;
+            }
+            else
+            {
+                res.sig |= uint128(q->_store._digits[i]) << bit;
+            }
+        }
+        res.sig |= inexact;
+        return res;
+    }
+
+    // |res - exact| / |exact|, NaN when exact is not defined, and infinite when res is not finite
+    // or exact is zero and res is not
+    static double RelativeError(const ExactNumber &exact, const Unpacked &res)
+    {
+        ExactNumber resExact = FromUnpacked(res);
+        if (!exact.defined)
+        {
+            return NAN;
+        }
+        if (!resExact.defined)
+        {
+            return INFINITY;
+        }
+        if (exact.IsZero())
+        {
+            return resExact.IsZero() ? 0.0 : INFINITY;
+        }
+
+        ExactNumber diff = resExact - exact;
+        ExactNumber mag = exact;
+        diff.sign = mag.sign = false;
+        return (diff / mag).ToDouble();
+    }
+
+    // Nearest double, up to a double rounding. NaN when not defined.
+    double ToDouble() const
+    {
+        Unpacked u = ToUnpacked();
+        if (u.kind == Unpacked::NaN)
+        {
+            return NAN;
+        }
+        if (u.kind == Unpacked::Zero)
+        {
+            return u.sign ? -0.0 : 0.0;
+        }
+        NormalizeTo(u, 63);
+        double mag = ldexp((double)(uint64_t)u.sig, u.exp);
+        return u.sign ? -mag : mag;
+    }
+
+  private:
+    static int TopExpo(const Number &n)
+    {
+        return n._store._minExpo + (int)n._store._digits.size() - 1;
+    }
+
+    static uint64_t ToWord(const Number &n)
+    {
+        uint64_t res = 0;
+        for (int i = n._store._digits.size(); i-- > 0;)
+        {
+            res = res << 1 | n._store._digits[i];
+        }
+        return res;
+    }
+
+    static bool IsOne(const Number &n)
+    {
+        return n._store._digits.size() == 1 && n._store._minExpo == 0;
+    }
+
+    static Number MulDen(const Number &a, const Number &b)
+    {
+        return IsOne(b) ? a : IsOne(a) ? b : a * b;
+    }
+
+    void Normalize()
+    {
+        num._store.removeLeadingZeroes();
+        num._store.removeTrailingZeroes();
+        den._store.removeLeadingZeroes();
+        den._store.removeTrailingZeroes();
+        if (IsZero() || den._store._digits.size() == 1)
+        {
+            num._store._minExpo -= den._store._minExpo;
+            den = Number::FromInteger(1);
+        }
+    }
+};
+
+// Grammar, with the usual precedence and left to right evaluation:
+//
+//   sum     = product { ("+" | "-") product }
+//   product = unary { ("*" | "/") unary }
+//   unary   = "-" unary | "(" sum ")" | number | name
+//
+// Names are variables, numbered in the order they first appear. Numbers are decimal literals, which
+// each format rounds once before running.
+struct Expression
+{
+    enum Op : uint8_t { OP_VAR, OP_CONST, OP_NEG, OP_ADD, OP_SUB, OP_MUL, OP_DIV };
+
+    // Arg is the index of the variable or the constant
+    struct Instr
+    {
+        uint8_t op;
+        uint8_t arg;
+    };
+
+    static constexpr int MaxOperands = 256;
+    static constexpr int MaxDepth = 256;
+
+    std::vector<Instr> code;
+    std::vector<std::string> varNames;
+    std::vector<ExactNumber> constants;
+    int stackSize = 0;
+    std::string error; // Empty when compiled
+
+    bool Compile(std::string_view text)
+    {
+        *this = Expression();
+        _text = text;
+        if (ParseSum(0))
+        {
+            SkipSpaces();
+            if (_pos != _text.size())
+            {
+                Fail("unexpected [" + std::string(_text.substr(_pos, 1)) + "]");
+            }
+        }
+        if (error.empty() && code.empty())
+        {
+            Fail("empty expression");
+        }
+        _text = {};
+        return error.empty();
+    }
+
+    // Exact value for the values of the variables, on a stack of at least stackSize entries.
+    // Undefined when any variable is not finite or something is divided by zero.
+    ExactNumber RunExact(const Unpacked *vars, ExactNumber *stack) const
+    {
+        int top = -1;
+        for (Instr in : code)
+        {
+            switch (in.op)
+            {
+            case OP_VAR:   stack[++top] = ExactNumber::FromUnpacked(vars[in.arg]); break;
+            case OP_CONST: stack[++top] = constants[in.arg]; break;
+            case OP_NEG:   stack[top] = -stack[top]; break;
+            case OP_ADD:   --top; stack[top] = stack[top] + stack[top + 1]; break;
+            case OP_SUB:   --top; stack[top] = stack[top] - stack[top + 1]; break;
+            case OP_MUL:   --top; stack[top] = stack[top] * stack[top + 1]; break;
+            case OP_DIV:   --top; stack[top] = stack[top] / stack[top + 1]; break;
+            }
+        }
+        return std::move(stack[0]);
+    }
+
+  private:
+    std::string_view _text;
+    size_t _pos = 0;
+    int _depth = 0;
+
+    bool Fail(const std::string &msg)
+    {
+        if (error.empty())
+        {
+            error = msg + " at " + std::to_string(_pos);
+        }
+        return false;
+    }
+
+    void SkipSpaces()
+    {
+        while (_pos < _text.size() && isspace((unsigned char)_text[_pos]))
+        {
+            ++_pos;
+        }
+    }
+
+    bool Accept(char c)
+    {
+        SkipSpaces();
+        if (_pos < _text.size() && _text[_pos] == c)
+        {
+            ++_pos;
+            return true;
+        }
+        return false;
+    }
+
+    void Emit(Op op, int arg = 0)
+    {
+        // Negated literals are rounded as such, which differs from negating the rounded literal
+        // when rounding toward one of the infinities
+        if (op == OP_NEG && !code.empty() && code.back().op == OP_CONST && code.back().arg == constants.size() - 1)
+        {
+            constants.back() = -constants.back();
+            return;
+        }
+
+        code.push_back({ (uint8_t)op, (uint8_t)arg });
+        if (op == OP_VAR || op == OP_CONST)
+        {
+            ++_depth;
+        }
+        else if (op != OP_NEG)
+        {
+            --_depth;
+        }
+        stackSize = std::max(stackSize, _depth);
+    }
+
+    bool ParseSum(int nesting)
+    {
+        if (!ParseProduct(nesting))
+        {
+            return false;
+        }
+        while (true)
+        {
+            Op op;
+            if (Accept('+'))
+            {
+                op = OP_ADD;
+            }
+            else if (Accept('-'))
+            {
+                op = OP_SUB;
+            }
+            else
+            {
+                return true;
+            }
+            if (!ParseProduct(nesting))
+            {
+                return false;
+            }
+            Emit(op);
+        }
+    }
+
+    bool ParseProduct(int nesting)
+    {
+        if (!ParseUnary(nesting))
+        {
+            return false;
+        }
+        while (true)
+        {
+            Op op;
+            if (Accept('*'))
+            {
+                op = OP_MUL;
+            }
+            else if (Accept('/'))
+            {
+                op = OP_DIV;
+            }
+            else
+            {
+                return true;
+            }
+            if (!ParseUnary(nesting))
+            {
+                return false;
+            }
+            Emit(op);
+        }
+    }
+
+    bool ParseUnary(int nesting)
+    {
+        if (nesting > MaxDepth)
+        {
+            return Fail("too deeply nested");
+        }
+        if (Accept('-'))
+        {
+            if (!ParseUnary(nesting + 1))
+            {
+                return false;
+            }
+            Emit(OP_NEG);
+            return true;
+        }
+        if (Accept('('))
+        {
+            if (!ParseSum(nesting + 1))
+            {
+                return false;
+            }
+            return Accept(')') || Fail("missing )");
+        }
+
+        SkipSpaces();
+        size_t start = _pos;
+        if (_pos < _text.size() && (isdigit((unsigned char)_text[_pos]) || _text[_pos] == '.'))
+        {
+            while (_pos < _text.size() && (isalnum((unsigned char)_text[_pos]) || _text[_pos] == '.'
+                || ((_text[_pos] == '-' || _text[_pos] == '+') && (_text[_pos - 1] == 'e' || _text[_pos - 1] == 'E'))))
+            {
+                ++_pos;
+            }
+            ExactNumber val;
+            if (!ExactNumber::Parse(_text.substr(start, _pos - start), val))
+            {
+                _pos = start;
+                return Fail("bad number");
+            }
+            if (constants.size() == MaxOperands)
+            {
+                return Fail("too many numbers");
+            }
+            constants.push_back(std::move(val));
+            Emit(OP_CONST, constants.size() - 1);
+            return true;
+        }
+        if (_pos < _text.size() && (isalpha((unsigned char)_text[_pos]) || _text[_pos] == '_'))
+        {
+            while (_pos < _text.size() && (isalnum((unsigned char)_text[_pos]) || _text[_pos] == '_'))
+            {
+                ++_pos;
+            }
+            std::string_view name = _text.substr(start, _pos - start);
+            int idx = std::find(varNames.begin(), varNames.end(), name) - varNames.begin();
+            if (idx == (int)varNames.size())
+            {
+                if (idx == MaxOperands)
+                {
+                    return Fail("too many variables");
+                }
+                varNames.emplace_back(name);
+            }
+            Emit(OP_VAR, idx);
+            return true;
+        }
+        return Fail(_pos == _text.size() ? "unexpected end" : "unexpected [" + std::string(_text.substr(_pos, 1)) + "]");
+    }
+};
+
+// What expressions need of a format, as function pointers so that only these are instantiated for
+// each format and the evaluator is compiled once
+struct ExpressionFormat
+{
+    uint64_t (*add)(uint64_t a, uint64_t b, RoundingMode mode);
+    uint64_t (*sub)(uint64_t a, uint64_t b, RoundingMode mode);
+    uint64_t (*mul)(uint64_t a, uint64_t b, RoundingMode mode);
+    uint64_t (*div)(uint64_t a, uint64_t b, RoundingMode mode);
+    uint64_t (*negate)(uint64_t val);
+    Unpacked (*unpack)(uint64_t val);
+    uint64_t (*round)(const Unpacked &u, RoundingMode mode);
+    uint64_t (*ulpDistance)(uint64_t a, uint64_t b);
+    int64_t (*toOrdinal)(uint64_t val);
+    bool (*fromOrdinal)(int64_t ord, uint64_t &val);
+    uint64_t unorderedValue;
+
+    template <typename ReprType>
+    static ExpressionFormat Of()
+    {
+        using Arith = SoftFloat<ReprType>;
+        ExpressionFormat res;
+        res.add = [](uint64_t a, uint64_t b, RoundingMode mode) { return Arith::Add(a, b, mode); };
+        res.sub = [](uint64_t a, uint64_t b, RoundingMode mode) { return Arith::Sub(a, b, mode); };
+        res.mul = [](uint64_t a, uint64_t b, RoundingMode mode) { return Arith::Mul(a, b, mode); };
+        res.div = [](uint64_t a, uint64_t b, RoundingMode mode) { return Arith::Div(a, b, mode); };
+        res.negate = [](uint64_t val) -> uint64_t { return ReprType::Negate(val); };
+        res.unpack = &SoftFloatFormat<ReprType>::Unpack;
+        res.round = &SoftFloatFormat<ReprType>::Round;
+        res.ulpDistance = &Ordinals<ReprType>::UlpDistance;
+        res.toOrdinal = &ReprType::ToOrdinal;
+        res.fromOrdinal = &ReprType::FromOrdinal;
+        res.unorderedValue = ReprType::UnorderedValue();
+        return res;
+    }
+};
+
+// Runs an Expression on the encodings of one format, each operation rounded with the given mode.
+// Has its own stacks, so threads need one each.
+struct ExpressionEvaluator
+{
+    // Ulp distance of a NaN result, or of one without an exact value, same as Ordinals::Unordered
+    static constexpr uint64_t Unordered = ~0ull;
+
+    ExpressionEvaluator(const Expression &expr, const ExpressionFormat &format, RoundingMode mode)
+        : _expr(expr)
+        , _format(format)
+        , _mode(mode)
+        , _stack(expr.stackSize)
+        , _exactStack(expr.stackSize)
+        , _unpacked(expr.varNames.size())
+    {
+        for (const ExactNumber &c : expr.constants)
+        {
+            _constants.push_back(format.round(c.ToUnpacked(), mode));
+        }
+    }
+
+    // vars has an encoding for each of the variables of the expression
+    uint64_t Run(const uint64_t *vars)
+    {
+        uint64_t *stack = _stack.data();
+        int top = -1;
+        for (Expression::Instr in : _expr.code)
+        {
+            switch (in.op)
+            {
+            case Expression::OP_VAR:   stack[++top] = vars[in.arg]; break;
+            case Expression::OP_CONST: stack[++top] = _constants[in.arg]; break;
+            case Expression::OP_NEG:   stack[top] = _format.negate(stack[top]); break;
+            case Expression::OP_ADD:   --top; stack[top] = _format.add(stack[top], stack[top + 1], _mode); break;
+            case Expression::OP_SUB:   --top; stack[top] = _format.sub(stack[top], stack[top + 1], _mode); break;
+            case Expression::OP_MUL:   --top; stack[top] = _format.mul(stack[top], stack[top + 1], _mode); break;
+            case Expression::OP_DIV:   --top; stack[top] = _format.div(stack[top], stack[top + 1], _mode); break;
+            }
+        }
+        return stack[0];
+    }
+
+    // See Expression::RunExact
+    ExactNumber RunExact(const uint64_t *vars)
+    {
+        for (size_t v = 0; v < _unpacked.size(); ++v)
+        {
+            _unpacked[v] = _format.unpack(vars[v]);
+        }
+        return _expr.RunExact(_unpacked.data(), _exactStack.data());
+    }
+
+    // Result of one point into out, and when asked for, its distance in ulps to the exact value
+    // correctly rounded (Unordered when the result is NaN or there is no exact value), and its
+    // ExactNumber::RelativeError. Any of the outputs may be null, the exact value is only computed
+    // for the errors.
+    void Evaluate(const uint64_t *vars, uint64_t *out, uint64_t *ulpError, double *relError)
+    {
+        uint64_t res = Run(vars);
+        if (out)
+        {
+            *out = res;
+        }
+        if (!ulpError && !relError)
+        {
+            return;
+        }
+
+        ExactNumber exact = RunExact(vars);
+        if (ulpError)
+        {
+            *ulpError = exact.defined ? _format.ulpDistance(res, _format.round(exact.ToUnpacked(), _mode)) : Unordered;
+        }
+        if (relError)
+        {
+            *relError = ExactNumber::RelativeError(exact, _format.unpack(res));
+        }
+    }
+
+    // Evaluates n points, numVars encodings each in vars, on up to numThreads threads
+    static void EvaluatePoints(const Expression &expr, const ExpressionFormat &format, RoundingMode mode,
+        const uint64_t *vars, size_t n, uint64_t *out, uint64_t *ulpErrors, double *relErrors, int numThreads)
+    {
+        size_t numVars = expr.varNames.size();
+        ForChunks(n, numThreads, [&](size_t begin, size_t end)
+        {
+            ExpressionEvaluator eval(expr, format, mode);
+            for (size_t i = begin; i < end; ++i)
+            {
+                eval.Evaluate(vars + i * numVars, out ? out + i : nullptr, ulpErrors ? ulpErrors + i : nullptr,
+                    relErrors ? relErrors + i : nullptr);
+            }
+        });
+    }
+
+    // Evaluates the grid where variable v takes counts[v] consecutive encodings in ordinal order
+    // from lo[v], the last variable changing fastest. Encodings past the end of the ordered values
+    // are the unordered value of the format. Returns false when the grid has no points or too many
+    // to count.
+    static bool Sweep(const Expression &expr, const ExpressionFormat &format, RoundingMode mode,
+        const uint64_t *lo, const int64_t *counts, uint64_t *out, uint64_t *ulpErrors, double *relErrors, int numThreads)
+    {
+        size_t numVars = expr.varNames.size();
+        std::vector<int64_t> loOrdinals(numVars);
+        size_t n = 1;
+        for (size_t v = 0; v < numVars; ++v)
+        {
+            if (counts[v] <= 0 || (uint64_t)counts[v] > (1ull << 40) / n)
+            {
+                return false;
+            }
+            n *= counts[v];
+            loOrdinals[v] = format.toOrdinal(lo[v]);
+        }
+
+        ForChunks(n, numThreads, [&](size_t begin, size_t end)
+        {
+            ExpressionEvaluator eval(expr, format, mode);
+            std::vector<uint64_t> vars(numVars);
+            for (size_t i = begin; i < end; ++i)
+            {
+                size_t rest = i;
+                for (size_t v = numVars; v-- > 0;)
+                {
+                    int64_t ord = loOrdinals[v] + (int64_t)(rest % counts[v]);
+                    rest /= counts[v];
+                    if (!format.fromOrdinal(ord, vars[v]))
+                    {
+                        vars[v] = format.unorderedValue;
+                    }
+                }
+                eval.Evaluate(vars.data(), out ? out + i : nullptr, ulpErrors ? ulpErrors + i : nullptr,
+                    relErrors ? relErrors + i : nullptr);
+            }
+        });
+        return true;
+    }
+
+  private:
+    const Expression &_expr;
+    const ExpressionFormat &_format;
+    RoundingMode _mode;
+    std::vector<uint64_t> _constants;
+    std::vector<uint64_t> _stack;
+    std::vector<ExactNumber> _exactStack;
+    std::vector<Unpacked> _unpacked;
+
+    // Calls f(begin, end) for contiguous chunks of [0, n), one per thread
+    template <typename F>
+    static void ForChunks(size_t n, int numThreads, F &&f)
+    {
+        numThreads = std::max(1, std::min<int>(numThreads, n / ExpressionMinPointsPerThread));
+        size_t chunk = (n + numThreads - 1) / numThreads;
+        RunParallel(numThreads, [&](int t)
+        {
+            f(std::min(n, t * chunk), std::min(n, (t + 1) * chunk));
+        });
+    }
+};
+
+
+#ifdef RUN_TEST_FLOATINFO
+
+#include <string.h>
+
+// Precedence and associativity of the operators, with a = 3 and b = 4 in binary64 where the results
+// are exact, and the errors of malformed expressions
+inline bool TestExpression()
+{
+    static const struct
+    {
+        const char *text;
+        double value;
+    } values[] = {
+        { "1 + 2 * 3 - 8 / 4 / 2", 6 },
+        { "2 - 3 - 4", -5 },
+        { "-(2 - 3) * 4", 4 },
+        { "a + b * a", 15 },
+        { "(a + b) * a", 21 },
+        { "-a * -b", 12 },
+        { "b / a / 2 * 6", 4 },
+        { "a - -b", 7 },
+    };
+    static const char *const errors[][2] = {
+        { "1 +", "unexpected end at 3" },
+        { "(1 + 2", "missing ) at 6" },
+        { "1 $ 2", "unexpected [$] at 2" },
+        { "1 2", "unexpected [2] at 2" },
+        { "a * )", "unexpected [)] at 4" },
+        { "1.2.3", "bad number at 0" },
+        { "", "unexpected end at 0" },
+        { "  ", "unexpected end at 2" },
+    };
+
+    auto bits = [](double d) { uint64_t u; memcpy(&u, &d, 8); return u; };
+    ExpressionFormat format = ExpressionFormat::Of<IEEE754FloatRepresentation<IEEE754Float64Traits>>();
+
+    int bad = 0;
+    for (const auto &c : values)
+    {
+        Expression expr;
+        if (!expr.Compile(c.text))
+        {
+            ++bad;
+            continue;
+        }
+        std::vector<uint64_t> vars;
+        for (const std::string &name : expr.varNames)
+        {
+            vars.push_back(bits(name == "a" ? 3 : 4));
+        }
+        ExpressionEvaluator eval(expr, format, ROUND_NEAREST_EVEN);
+        bad += eval.Run(vars.data()) != bits(c.value) || eval.RunExact(vars.data()).ToDouble() != c.value;
+    }
+
+    // Variables are numbered in the order they first appear, once each
+    Expression expr;
+    bad += !expr.Compile("b * a - b") || expr.varNames != std::vector<std::string>{ "b", "a" };
+
+    for (const auto &c : errors)
+    {
+        bad += expr.Compile(c[0]) || expr.error != c[1];
+    }
+    return bad == 0;
+}
+
+#endif
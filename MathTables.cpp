@@ -0,0 +1,121 @@
+// Copyright 2023 Mustafa Serdar Sanli
+//
+// This file is part of FloatInfo.
+//
+// FloatInfo is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// FloatInfo is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with FloatInfo.  If not, see <https://www.gnu.org/licenses/>.
+
+// Correctly rounded (to nearest even) elementary functions of the 8 and 16-bit formats, served
+// from tables of the result of every encoding. The tables are generated by gen_math_tables.py and
+// only compiled in when FLOATINFO_MATH_TABLES is defined, as together they are far larger than the
+// rest of the program; otherwise MathTableData<ReprType>::IsAvailable is false for every type.
+//
+// Included from floatinfo.cpp after Quire.cpp.
+
+#include <stdint.h>
+#include <stddef.h>
+
+enum MathFunction
+{
+    MATH_EXP,
+    MATH_LOG,
+    MATH_SIN,
+    MATH_COS,
+    MATH_SQRT,
+    MATH_RECIPROCAL,
+    MATH_FUNCTION_MAX,
+};
+
+// Specialized by the generated tables for the types that have them
+template <typename ReprType>
+struct MathTableData
+{
+    static constexpr bool IsAvailable = false;
+};
+
+#ifdef FLOATINFO_MATH_TABLES
+#include "MathTablesData.cpp"
+#endif
+
+template <typename ReprType>
+struct MathTable
+{
+    using Data = MathTableData<ReprType>;
+    using Entry = typename Data::Entry;
+    static constexpr uint64_t Mask = (uint64_t(1) << ReprType::NumBits) - 1;
+
+    static uint64_t Eval(MathFunction f, uint64_t val)
+    {
+        return Data::Tables[f][val & Mask];
+    }
+
+    static void Eval(MathFunction f, const Entry *vals, Entry *out, size_t n)
+    {
+        const Entry *table = Data::Tables[f];
+        // Hardware gathers are no faster than this loop, which is mostly loads
+        for (size_t i = 0; i < n; ++i)
+        {
+            out[i] = table[vals[i]];
+        }
+    }
+
+    static void Eval(MathFunction f, const uint64_t *vals, uint64_t *out, size_t n)
+    {
+        const Entry *table = Data::Tables[f];
+        for (size_t i = 0; i < n; ++i)
+        {
+            out[i] = table[vals[i] & Mask];
+        }
+    }
+};
+
+
+#ifdef RUN_TEST_FLOATINFO
+
+#include <math.h>
+#include <string.h>
+
+// Every entry of the binary16 tables, when they are compiled in, against libm in double rounded
+// once more to binary16. The double results are far enough from the binary16 ties for the second
+// rounding to give the correctly rounded result.
+inline bool TestMathTables()
+{
+    int bad = 0;
+#ifdef FLOATINFO_MATH_TABLES
+    using Half = SoftFloatFormat<IEEE754FloatRepresentation<IEEE754Float16Traits>>;
+    using Double = SoftFloatFormat<IEEE754FloatRepresentation<IEEE754Float64Traits>>;
+    double (*const functions[MATH_FUNCTION_MAX])(double) = {
+        exp, log, sin, cos, sqrt, [](double x) { return 1 / x; },
+    };
+
+    for (int f = 0; f < MATH_FUNCTION_MAX; ++f)
+    {
+        for (uint64_t val = 0; val < (1 << 16); ++val)
+        {
+            uint64_t argBits = Double::Round(Half::Unpack(val), ROUND_NEAREST_EVEN);
+            double arg;
+            memcpy(&arg, &argBits, 8);
+            double res = functions[f](arg);
+            uint64_t resBits;
+            memcpy(&resBits, &res, 8);
+            uint64_t expected = Half::Round(Double::Unpack(resBits), ROUND_NEAREST_EVEN);
+            uint64_t actual = MathTable<IEEE754FloatRepresentation<IEEE754Float16Traits>>::Eval((MathFunction)f, val);
+            bool isNan = isnan(res);
+            bad += isNan ? Half::Unpack(actual).kind != Unpacked::NaN : actual != expected;
+        }
+    }
+#endif
+    return bad == 0;
+}
+
+#endif
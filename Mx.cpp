@@ -0,0 +1,308 @@
+// Copyright 2023 Mustafa Serdar Sanli
+//
+// This file is part of FloatInfo.
+//
+// FloatInfo is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// FloatInfo is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with FloatInfo.  If not, see <https://www.gnu.org/licenses/>.
+
+// OCP Microscaling (MX) blocks: 32 elements sharing one E8M0 scale, the power of two
+// 2**(scale - 127), where scale 0xff is NaN. A block is stored as its scale byte followed by its
+// elements, two per byte for 4-bit elements, low nibble first.
+//
+// Blocks are decoded to and encoded from binary32 four elements at a time with the vector
+// extensions of GCC and clang, which become SSE2 or wasm SIMD instructions where the target has
+// them. Element conversions have no branches; only the choice of the shared scale looks at the
+// block as a whole.
+//
+// Included from floatinfo.cpp after the representations.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <algorithm>
+
+constexpr int MxBlockSize = 32;
+constexpr uint8_t MxScaleNan = 0xff;
+
+typedef uint32_t MxU32x4 __attribute__((vector_size(16)));
+typedef int32_t MxI32x4 __attribute__((vector_size(16)));
+typedef float MxF32x4 __attribute__((vector_size(16)));
+
+inline float FloatFromBits(uint32_t bits)
+{
+    float x;
+    memcpy(&x, &bits, 4);
+    return x;
+}
+
+// Lanes where mask is all ones from a, the others from b
+inline MxU32x4 MxSelect(MxI32x4 mask, MxU32x4 a, MxU32x4 b)
+{
+    return ((MxU32x4)mask & a) | (~(MxU32x4)mask & b);
+}
+
+// Elements of MXFP8 and MXFP4, the IEEE754FloatRepresentation of the element type
+template <typename ReprType>
+struct MxFloatElement
+{
+    static constexpr int NumBits = ReprType::NumBits;
+    static constexpr int NumMantissaBits = ReprType::NumMantissaBits;
+    static constexpr int ExponentBias = ReprType::ExponentBias;
+    static constexpr uint32_t ExponentMask = ReprType::ExponentMask;
+    static constexpr uint32_t MantissaMask = ReprType::MantissaMask;
+    static constexpr IEEE754Specials Specials = ReprType::Specials;
+
+    // Exponent of the largest finite element, the shared scale brings the largest magnitude of the
+    // block to this binade
+    static constexpr int MaxExponent = ReprType::MaxExponent;
+    static constexpr uint32_t MaxFiniteCode = (uint32_t)(MaxExponent + ExponentBias) << NumMantissaBits
+        | (MantissaMask - (Specials == IEEE754_NAN_ONLY));
+
+    // Weight of the last mantissa bit of subnormals, and the binary32 value which makes additions
+    // round to it
+    static constexpr int SubnormalExponent = 1 - ExponentBias - NumMantissaBits;
+    static float SubnormalUnit() { return FloatFromBits((127 + SubnormalExponent) << 23); }
+    static float SubnormalRounder() { return FloatFromBits((127 + 23 + SubnormalExponent) << 23); }
+    static float MinNormal() { return FloatFromBits((127 + 1 - ExponentBias) << 23); }
+
+    // Exact binary32 values of the elements
+    static MxF32x4 Decode(MxU32x4 codes)
+    {
+        MxU32x4 sign = (codes >> (NumBits - 1)) & 1;
+        MxU32x4 exponent = (codes >> NumMantissaBits) & ExponentMask;
+        MxU32x4 mantissa = codes & MantissaMask;
+
+        MxU32x4 normal = (exponent + (127 - ExponentBias)) << 23 | mantissa << (23 - NumMantissaBits);
+        MxU32x4 subnormal = (MxU32x4)(__builtin_convertvector((MxI32x4)mantissa, MxF32x4) * SubnormalUnit());
+        MxU32x4 magnitude = MxSelect(exponent != 0, normal, subnormal);
+        if constexpr (Specials == IEEE754_INF_NAN)
+        {
+            magnitude = MxSelect(exponent == ExponentMask, 0x7f800000 | mantissa << (23 - NumMantissaBits), magnitude);
+        }
+        else if constexpr (Specials == IEEE754_NAN_ONLY)
+        {
+            magnitude = MxSelect((exponent == ExponentMask) & (mantissa == MantissaMask), MxU32x4{} + 0x7fc00000, magnitude);
+        }
+        return (MxF32x4)(magnitude | sign << 31);
+    }
+
+    // Nearest elements to finite values, ties to even, saturating at the largest finite element as
+    // MX conversions do
+    static MxU32x4 Encode(MxF32x4 x)
+    {
+        MxU32x4 bits = (MxU32x4)x;
+        MxU32x4 sign = bits >> 31;
+        MxU32x4 magnitudeBits = bits & 0x7fffffff;
+        MxF32x4 magnitude = (MxF32x4)magnitudeBits;
+        MxI32x4 isSubnormal = magnitude < MinNormal();
+
+        // Below the normal range the sum rounds to the subnormal unit, and the count of units is the
+        // code, reaching the smallest normal when it rounds up to it
+        MxF32x4 clamped = (MxF32x4)MxSelect(isSubnormal, magnitudeBits, (MxU32x4)(MxF32x4{} + MinNormal()));
+        MxF32x4 subnormal = (clamped + SubnormalRounder()) - SubnormalRounder();
+        MxU32x4 subnormalCode = (MxU32x4)__builtin_convertvector(subnormal * (1 / SubnormalUnit()), MxI32x4);
+
+        // In the normal range the binary32 mantissa rounds to the element's, carrying into the exponent
+        constexpr int drop = 23 - NumMantissaBits;
+        MxU32x4 rounded = magnitudeBits + ((1u << (drop - 1)) - 1) + ((magnitudeBits >> drop) & 1);
+        MxU32x4 normalCode = (rounded >> drop) - ((127 - ExponentBias) << NumMantissaBits);
+        normalCode = MxSelect(normalCode > MaxFiniteCode, MxU32x4{} + MaxFiniteCode, normalCode);
+
+        return MxSelect(isSubnormal, subnormalCode, normalCode) | sign << (NumBits - 1);
+    }
+};
+
+// Elements of MXINT8, two's complement integers weighing 2**-6
+struct MxInt8Element
+{
+    static constexpr int NumBits = 8;
+    static constexpr int MaxExponent = 0;
+
+    static MxF32x4 Decode(MxU32x4 codes)
+    {
+        MxI32x4 values = (MxI32x4)(codes << 24) >> 24;
+        return __builtin_convertvector(values, MxF32x4) * (1.0f / 64);
+    }
+
+    static MxU32x4 Encode(MxF32x4 x)
+    {
+        // Adding 1.5 * 2**23 rounds to an integer, ties to even
+        const float rounder = 12582912.0f;
+        MxF32x4 scaled = x * 64;
+        scaled = (MxF32x4)MxSelect(scaled < -128.0f, (MxU32x4)(MxF32x4{} - 128.0f), (MxU32x4)scaled);
+        scaled = (MxF32x4)MxSelect(scaled > 127.0f, (MxU32x4)(MxF32x4{} + 127.0f), (MxU32x4)scaled);
+        MxF32x4 rounded = (scaled + rounder) - rounder;
+        return (MxU32x4)__builtin_convertvector(rounded, MxI32x4) & 0xff;
+    }
+};
+
+template <typename ElementType>
+struct MxFormat
+{
+    static constexpr int NumElementBits = ElementType::NumBits;
+    static constexpr int BytesPerBlock = 1 + MxBlockSize * NumElementBits / 8;
+
+    static MxU32x4 LoadCodes(const uint8_t *elements, int i)
+    {
+        if constexpr (NumElementBits == 4)
+        {
+            uint32_t lo = elements[i / 2], hi = elements[i / 2 + 1];
+            return MxU32x4{ lo & 0xf, lo >> 4, hi & 0xf, hi >> 4 };
+        }
+        else
+        {
+            return MxU32x4{ elements[i], elements[i + 1], elements[i + 2], elements[i + 3] };
+        }
+    }
+
+    // 2**(scale - 127) as binary32, which has it exactly, subnormal for scale 0
+    static float ScaleValue(uint8_t scale)
+    {
+        uint32_t bits = scale ? (uint32_t)scale << 23 : 0x00400000;
+        return FloatFromBits(scale == MxScaleNan ? 0x7fc00000 : bits);
+    }
+
+    static void DecodeBlock(const uint8_t *block, float *out)
+    {
+        float scale = ScaleValue(block[0]);
+        for (int i = 0; i < MxBlockSize; i += 4)
+        {
+            MxF32x4 values = ElementType::Decode(LoadCodes(block + 1, i)) * scale;
+            memcpy(out + i, &values, sizeof(values));
+        }
+    }
+
+    // The scale brings the largest magnitude into the binade of the largest element, as the MX
+    // spec does, so the largest elements may saturate. Blocks with a NaN or an infinity get the NaN
+    // scale and zero elements.
+    static void EncodeBlock(const float *in, uint8_t *block)
+    {
+        MxF32x4 values[MxBlockSize / 4];
+        memcpy(values, in, sizeof(values));
+
+        MxU32x4 maxBits = {};
+        for (const MxF32x4 &v : values)
+        {
+            MxU32x4 bits = (MxU32x4)v & 0x7fffffff;
+            maxBits = MxSelect(bits > maxBits, bits, maxBits);
+        }
+        uint32_t maxBitsAll = std::max(std::max(maxBits[0], maxBits[1]), std::max(maxBits[2], maxBits[3]));
+
+        memset(block, 0, BytesPerBlock);
+        if (maxBitsAll >= 0x7f800000)
+        {
+            block[0] = MxScaleNan;
+            return;
+        }
+
+        // Binade of the largest magnitude, zero and binary32 subnormals get the smallest scale
+        int maxExponent = (int)(maxBitsAll >> 23) - 127;
+        int shared = std::clamp(maxExponent - ElementType::MaxExponent, -127, 127);
+        block[0] = shared + 127;
+
+        // Dividing by the scale is exact, multiplying by its inverse is the same
+        float inverse = ScaleValue(127 - shared);
+        uint8_t *elements = block + 1;
+        for (int i = 0; i < MxBlockSize / 4; ++i)
+        {
+            MxU32x4 codes = ElementType::Encode(values[i] * inverse);
+            if constexpr (NumElementBits == 4)
+            {
+                elements[2 * i] = codes[0] | codes[1] << 4;
+                elements[2 * i + 1] = codes[2] | codes[3] << 4;
+            }
+            else
+            {
+                for (int j = 0; j < 4; ++j)
+                {
+                    elements[4 * i + j] = codes[j];
+                }
+            }
+        }
+    }
+
+    static void Decode(const uint8_t *blocks, size_t numBlocks, float *out)
+    {
+        for (size_t b = 0; b < numBlocks; ++b)
+        {
+            DecodeBlock(blocks + b * BytesPerBlock, out + b * MxBlockSize);
+        }
+    }
+
+    static void Encode(const float *in, size_t numBlocks, uint8_t *blocks)
+    {
+        for (size_t b = 0; b < numBlocks; ++b)
+        {
+            EncodeBlock(in + b * MxBlockSize, blocks + b * BytesPerBlock);
+        }
+    }
+};
+
+
+#ifdef RUN_TEST_FLOATINFO
+
+#include <math.h>
+
+// Shared scales and decoded values of sample blocks, which are exact unless the largest element
+// saturates
+inline bool TestMx()
+{
+    int bad = 0;
+    float in[MxBlockSize];
+    float out[MxBlockSize];
+    uint8_t block[1 + MxBlockSize];
+
+    // Multiples of 16 up to 256 fit E4M3, the largest magnitude 2**14 takes the scale 2**(14 - 8)
+    using E4M3 = MxFormat<MxFloatElement<IEEE754FloatRepresentation<OcpE4M3Traits>>>;
+    for (int i = 0; i < MxBlockSize; ++i)
+    {
+        in[i] = (i - 16) * 1024.0f;
+    }
+    E4M3::EncodeBlock(in, block);
+    E4M3::DecodeBlock(block, out);
+    bad += block[0] != 127 + 6 || memcmp(in, out, sizeof(in)) != 0;
+
+    // MXINT8 elements are multiples of 2**-6 below 2
+    using Int8 = MxFormat<MxInt8Element>;
+    for (int i = 0; i < MxBlockSize; ++i)
+    {
+        in[i] = (i - 16) / 64.0f;
+    }
+    Int8::EncodeBlock(in, block);
+    Int8::DecodeBlock(block, out);
+    bad += block[0] != 127 - 2 || memcmp(in, out, sizeof(in)) != 0;
+
+    // 7 is in the binade of 6, the largest E2M1, and saturates to it. 0.25 is a tie between 0 and
+    // the subnormal 0.5, and rounds to the even 0.
+    using E2M1 = MxFormat<MxFloatElement<IEEE754FloatRepresentation<OcpE2M1Traits>>>;
+    for (int i = 0; i < MxBlockSize; ++i)
+    {
+        in[i] = (i % 4) * 0.5f;
+    }
+    in[0] = 7;
+    in[1] = -0.25f;
+    E2M1::EncodeBlock(in, block);
+    E2M1::DecodeBlock(block, out);
+    in[0] = 6;
+    in[1] = -0.0f;
+    bad += block[0] != 127 || memcmp(in, out, sizeof(in)) != 0;
+
+    // An infinity makes the whole block NaN
+    in[5] = INFINITY;
+    E2M1::EncodeBlock(in, block);
+    E2M1::DecodeBlock(block, out);
+    bad += block[0] != MxScaleNan || !isnan(out[0]) || !isnan(out[MxBlockSize - 1]);
+    return bad == 0;
+}
+
+#endif
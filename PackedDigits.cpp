@@ -0,0 +1,211 @@
+// Copyright 2023 Mustafa Serdar Sanli
+//
+// This file is part of FloatInfo.
+//
+// FloatInfo is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// FloatInfo is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with FloatInfo.  If not, see <https://www.gnu.org/licenses/>.
+
+// Compact immutable copies of rendered exact values, for the results that are kept around in the
+// caches and the undo history.
+//
+// Exact values are a sign, digits and a dot, and the digits are most of their size: over a thousand
+// in each base for the binary64 denormals, and over ten thousand for binary128. Digits of base 10
+// are kept as 4-bit BCD and those of base 2 as single bits, which is 2 and 8 times smaller than the
+// text, and 8 and 32 times smaller than the uint32 digits of the bigints. Unpacking writes eight
+// characters at a time, from a table for the bits and by spreading nibbles for BCD, so it runs at
+// close to the speed of copying the text.
+
+#include <stdint.h>
+#include <string.h>
+#include <string>
+
+// Text of each byte of packed binary digits, least significant digit first
+struct PackedDigitTables
+{
+    constexpr PackedDigitTables()
+    {
+        for (int b = 0; b < 256; ++b)
+        {
+            for (int i = 0; i < 8; ++i)
+            {
+                bits[b][i] = '0' + ((b >> i) & 1);
+            }
+        }
+    }
+
+    char bits[256][8] = {};
+};
+
+inline constexpr PackedDigitTables gPackedDigitTables;
+
+struct PackedDigits
+{
+    // Packs text of the form [-]digits[.digits] in base 2 or 10, anything else is kept as it is
+    static PackedDigits Pack(const std::string &text, int base)
+    {
+        PackedDigits res;
+        size_t start = (!text.empty() && text[0] == '-');
+        size_t dot = text.find('.', start);
+        size_t numIntDigits = (dot == std::string::npos ? text.size() : dot) - start;
+        if (numIntDigits == 0 || !isDigits(text, start, numIntDigits, base) ||
+            (dot != std::string::npos && !isDigits(text, dot + 1, text.size() - dot - 1, base)))
+        {
+            res._data = text;
+            return res;
+        }
+
+        res._isNegative = start;
+        res._hasDot = (dot != std::string::npos);
+        res._numIntDigits = numIntDigits;
+        res._numDigits = text.size() - start - res._hasDot;
+        res._bitsPerDigit = (base == 2 ? 1 : 4);
+
+        int digitsPerByte = 8 / res._bitsPerDigit;
+        res._data.assign((res._numDigits + digitsPerByte - 1) / digitsPerByte, '\0');
+        size_t i = 0;
+        for (size_t pos = start; pos < text.size(); ++pos)
+        {
+            if (pos == dot)
+            {
+                continue;
+            }
+            res._data[i / digitsPerByte] |= (text[pos] - '0') << (i % digitsPerByte * res._bitsPerDigit);
+            ++i;
+        }
+        return res;
+    }
+
+    std::string Unpack() const
+    {
+        if (_bitsPerDigit == 0)
+        {
+            return _data;
+        }
+
+        // All digits are written after the sign, then the fraction digits are moved for the dot
+        std::string res(_isNegative + _numDigits + _hasDot + 8, '\0');
+        char *out = &res[_isNegative];
+        res[0] = '-';
+        const unsigned char *bytes = (const unsigned char *)_data.data();
+        if (_bitsPerDigit == 1)
+        {
+            for (size_t i = 0; i < _data.size(); ++i)
+            {
+                memcpy(out + 8 * i, gPackedDigitTables.bits[bytes[i]], 8);
+            }
+        }
+        else
+        {
+            // Eight digits at a time, spreading the nibbles of four bytes to the bytes of a little
+            // endian word. The bytes past the end are taken as zeros.
+            for (size_t i = 0; i < _data.size(); i += 4)
+            {
+                uint32_t packed = 0;
+                if (i + 4 <= _data.size())
+                {
+                    memcpy(&packed, bytes + i, 4);
+                }
+                else
+                {
+                    memcpy(&packed, bytes + i, _data.size() - i);
+                }
+                uint64_t word = packed;
+                word = (word | word << 16) & 0x0000FFFF0000FFFFull;
+                word = (word | word << 8) & 0x00FF00FF00FF00FFull;
+                word = (word | word << 4) & 0x0F0F0F0F0F0F0F0Full;
+                word += 0x3030303030303030ull;
+                memcpy(out + 2 * i, &word, 8);
+            }
+        }
+
+        if (_hasDot)
+        {
+            memmove(out + _numIntDigits + 1, out + _numIntDigits, _numDigits - _numIntDigits);
+            out[_numIntDigits] = '.';
+        }
+        res.resize(_isNegative + _numDigits + _hasDot);
+        return res;
+    }
+
+    // Heap and inline bytes held
+    size_t Bytes() const
+    {
+        return sizeof(PackedDigits) + _data.capacity();
+    }
+
+    static bool isDigits(const std::string &text, size_t pos, size_t count, int base)
+    {
+        for (size_t i = pos; i < pos + count; ++i)
+        {
+            if (text[i] < '0' || text[i] >= '0' + base)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    std::string _data;        // Packed digits, or the text when _bitsPerDigit is 0
+    uint32_t _numDigits = 0;
+    uint32_t _numIntDigits = 0;
+    uint8_t _bitsPerDigit = 0;
+    bool _isNegative = false;
+    bool _hasDot = false;
+};
+
+
+#ifdef RUN_TEST
+
+#include <random>
+#include <stdio.h>
+
+int main()
+{
+    fprintf(stderr, "Running tests...\n");
+
+    std::mt19937 rng(42);
+    int bad = 0;
+    for (int i = 0; i < 100000; ++i)
+    {
+        int base = (i % 2 ? 2 : 10);
+        std::string text = (rng() % 2 ? "-" : "");
+        int numIntDigits = 1 + rng() % 30;
+        int numFractionDigits = (i % 3 == 0 ? 0 : rng() % 2000);
+        for (int j = 0; j < numIntDigits + numFractionDigits; ++j)
+        {
+            if (j == numIntDigits)
+            {
+                text += '.';
+            }
+            text += '0' + rng() % base;
+        }
+
+        PackedDigits packed = PackedDigits::Pack(text, base);
+        bad += packed.Unpack() != text || packed._bitsPerDigit == 0;
+        bad += packed.Bytes() > sizeof(PackedDigits) + 16 + text.size() * (base == 2 ? 1 : 4) / 8;
+    }
+
+    // Not numbers in base 2, kept as they are
+    for (const char *text : {"", "-", "non-terminating", ".5", "12a", "1.2.3", "102"})
+    {
+        PackedDigits packed = PackedDigits::Pack(text, 2);
+        bad += packed.Unpack() != text || packed._bitsPerDigit != 0;
+    }
+    bad += PackedDigits::Pack("102", 10).Unpack() != "102";
+    bad += PackedDigits::Pack("-0.000", 10).Unpack() != "-0.000";
+
+    fprintf(stderr, "test packed digits = %d\n", bad == 0);
+    return bad != 0;
+}
+
+#endif
@@ -0,0 +1,233 @@
+// Copyright 2023 Mustafa Serdar Sanli
+//
+// This file is part of FloatInfo.
+//
+// FloatInfo is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// FloatInfo is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with FloatInfo.  If not, see <https://www.gnu.org/licenses/>.
+
+#include <stdint.h>
+
+// Fields of a posit encoding as its bits read, without negating negative values first. The value is
+//     ((1 - 3 * sign) + fraction / 2**numFractionBits) * 2**((1 - 2 * sign) * (regime * 2**es + exponent + sign))
+// Exponent bits cut off by the end of the encoding are zero, numExponentBits only counts the ones
+// that are there.
+struct PositFields
+{
+    uint32_t sign;
+    int regime;
+    int numRegimeBits; // with the terminating bit, if there is one
+    uint32_t exponent;
+    int numExponentBits;
+    uint64_t fraction;
+    int numFractionBits;
+};
+
+// Decoding of posit<NumBits, ES> in the low bits of a uint64. Every width and exponent size is its
+// own instantiation, so the field positions reduce to a clz and shifts by constants.
+template <int NumBits, int ES>
+struct PositCodec
+{
+    // At least the sign, the two regime bits and the exponent of one
+    static_assert(NumBits >= ES + 3 && NumBits <= 64 && ES >= 0 && ES <= 4);
+
+    static constexpr int MinRegime = -NumBits + 1;
+    static constexpr int MaxRegime = NumBits - 2;
+
+    static constexpr int Clz(uint64_t val)
+    {
+        return __builtin_clzll(val);
+    }
+
+    static constexpr PositFields Decode(uint64_t val)
+    {
+        PositFields res = {};
+        res.sign = (val >> (NumBits - 1)) & 1;
+
+        // The bits after the sign at the top, the zeros below them end a run of zeros at the end
+        uint64_t bits = val << (64 - NumBits + 1);
+        bool first = bits >> 63;
+        int run = first ? Clz(~bits) : Clz(bits | 1);
+        run = run < NumBits - 1 ? run : NumBits - 1;
+        res.regime = first ? run - 1 : -run;
+        res.numRegimeBits = run + (run < NumBits - 1);
+
+        int left = NumBits - 1 - res.numRegimeBits;
+        res.numExponentBits = left < ES ? left : ES;
+        res.numFractionBits = left - res.numExponentBits;
+
+        // Exponent and fraction left aligned, bits past the end of the encoding are zero
+        uint64_t rest = bits << res.numRegimeBits;
+        if constexpr (ES > 0)
+        {
+            res.exponent = rest >> (64 - ES);
+        }
+        uint64_t fraction = rest << ES;
+        res.fraction = res.numFractionBits ? fraction >> (64 - res.numFractionBits) : 0;
+        return res;
+    }
+
+    // Power of two of the implicit term, see PositFields
+    static constexpr int Scale(const PositFields &f)
+    {
+        int sign = f.sign;
+        return (1 - 2 * sign) * (f.regime * (1 << ES) + (int)f.exponent + sign);
+    }
+
+    // Encoding of 2**scale, which needs to be representable
+    static constexpr uint64_t PowerOfTwo(int scale)
+    {
+        int regime = scale >= 0 ? scale >> ES : -((-scale + (1 << ES) - 1) >> ES);
+        uint64_t exponent = scale - regime * (1 << ES);
+
+        // A run of regime + 1 ones or -regime zeros, and the bit that ends it
+        uint64_t bits = regime >= 0 ? (1ull << (regime + 2)) - 2 : 1;
+        int len = regime >= 0 ? regime + 2 : -regime + 1;
+        bits = bits << ES | exponent;
+        len += ES;
+        return bits << (NumBits - 1 - len);
+    }
+};
+
+
+#ifdef RUN_TEST
+
+#include <stdio.h>
+#include <utility>
+
+// Decodes the magnitude the textbook way, negating first and walking the regime a bit at a time,
+// as num * 2**exp with num odd or zero. Also returns the widths of the regime and the fraction as
+// the bits read before negating, which is what PositFields describes.
+template <int NumBits, int ES>
+static void ReferenceDecode(uint64_t val, bool &sign, uint64_t &num, int &exp, int &regimeBits, int &fractionBits)
+{
+    uint64_t mask = NumBits == 64 ? ~0ull : (1ull << NumBits) - 1;
+    sign = (val >> (NumBits - 1)) & 1;
+    uint64_t mag = sign ? (0 - val) & mask : val;
+
+    int i = NumBits - 2;
+    int first = (mag >> i) & 1;
+    int run = 0;
+    while (i >= 0 && (int)((mag >> i) & 1) == first)
+    {
+        ++run;
+        --i;
+    }
+    --i; // terminating bit
+    int k = first ? run - 1 : -run;
+
+    int e = 0;
+    for (int j = 0; j < ES; ++j, --i)
+    {
+        e = e * 2 + (i >= 0 ? (mag >> i) & 1 : 0);
+    }
+
+    int fbits = i + 1 > 0 ? i + 1 : 0;
+    uint64_t frac = fbits ? mag & ((1ull << fbits) - 1) : 0;
+    num = (1ull << fbits) | frac;
+    exp = k * (1 << ES) + e - fbits;
+    while (num && !(num & 1))
+    {
+        num >>= 1;
+        ++exp;
+    }
+
+    int rawFirst = (val >> (NumBits - 2)) & 1;
+    int rawRun = 0;
+    while (rawRun < NumBits - 1 && (int)((val >> (NumBits - 2 - rawRun)) & 1) == rawFirst)
+    {
+        ++rawRun;
+    }
+    regimeBits = rawRun + (rawRun < NumBits - 1);
+    int left = NumBits - 1 - regimeBits - ES;
+    fractionBits = left > 0 ? left : 0;
+}
+
+template <int NumBits, int ES>
+static int CheckExhaustive()
+{
+    using Codec = PositCodec<NumBits, ES>;
+    int bad = 0;
+    for (uint64_t val = 1; val < (1ull << NumBits); ++val)
+    {
+        if (val == 1ull << (NumBits - 1))
+        {
+            continue; // NaR
+        }
+
+        bool refSign;
+        uint64_t refNum;
+        int refExp, refRegimeBits, refFractionBits;
+        ReferenceDecode<NumBits, ES>(val, refSign, refNum, refExp, refRegimeBits, refFractionBits);
+
+        PositFields f = Codec::Decode(val);
+
+        // |((1 - 3s) * 2**fb + fraction)| * 2**(scale - fb)
+        int64_t top = (int64_t)f.fraction + (f.sign ? -2 : 1) * (int64_t)(1ull << f.numFractionBits);
+        uint64_t num = top < 0 ? -top : top;
+        int exp = Codec::Scale(f) - f.numFractionBits;
+        while (num && !(num & 1))
+        {
+            num >>= 1;
+            ++exp;
+        }
+
+        bool widthsOk = f.numRegimeBits == refRegimeBits && f.numFractionBits == refFractionBits
+                     && 1 + f.numRegimeBits + f.numExponentBits + f.numFractionBits == NumBits;
+        if (f.sign != refSign || num != refNum || exp != refExp || !widthsOk)
+        {
+            if (bad < 5)
+            {
+                fprintf(stderr, "posit<%d, %d> 0x%llx: %llu * 2**%d, expected %s%llu * 2**%d\n", NumBits, ES,
+                        (unsigned long long)val, (unsigned long long)num, exp, refSign ? "-" : "", (unsigned long long)refNum, refExp);
+            }
+            ++bad;
+        }
+    }
+
+    // Powers of two from minpos to maxpos, where the exponent bits are not cut off
+    for (int scale = -(NumBits - 2) * (1 << ES); scale <= (NumBits - 2) * (1 << ES); ++scale)
+    {
+        int regime = scale >= 0 ? scale >> ES : -((-scale + (1 << ES) - 1) >> ES);
+        int len = (regime >= 0 ? regime + 2 : -regime + 1) + ES;
+        if (len > NumBits - 1)
+        {
+            continue;
+        }
+        PositFields f = Codec::Decode(Codec::PowerOfTwo(scale));
+        bad += (f.sign != 0 || f.fraction != 0 || Codec::Scale(f) != scale);
+    }
+    return bad;
+}
+
+template <int ES, int... Widths>
+static int CheckWidths(std::integer_sequence<int, Widths...>)
+{
+    return (0 + ... + CheckExhaustive<Widths + ES + 3, ES>());
+}
+
+int main()
+{
+    fprintf(stderr, "Running tests...\n");
+
+    // Every encoding of every width from ES + 3 to 16 bits, for each exponent size
+    int bad = CheckWidths<0>(std::make_integer_sequence<int, 14>())
+            + CheckWidths<1>(std::make_integer_sequence<int, 13>())
+            + CheckWidths<2>(std::make_integer_sequence<int, 12>())
+            + CheckWidths<3>(std::make_integer_sequence<int, 11>())
+            + CheckWidths<4>(std::make_integer_sequence<int, 10>());
+
+    fprintf(stderr, "test exhaustive = %d\n", bad == 0);
+    return bad != 0;
+}
+
+#endif
@@ -0,0 +1,312 @@
+// Copyright 2023 Mustafa Serdar Sanli
+//
+// This file is part of FloatInfo.
+//
+// FloatInfo is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// FloatInfo is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with FloatInfo.  If not, see <https://www.gnu.org/licenses/>.
+
+// Exact accumulators of sums of products. A posit quire is the 16n-bit fixed point register of
+// the posit standard; for the IEEE formats the same idea is a Kulisch accumulator, wide enough for
+// every product of two finite values. Either way the sum is only rounded once, when it is read.
+//
+// Included from floatinfo.cpp after SoftFloat.cpp.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+// Two's complement fixed point number of NumWords 64-bit words, the lowest bit weighs 2**LsbExp
+template <int NumWords, int LsbExp>
+struct FixedPointAccumulator
+{
+    uint64_t _words[NumWords] = {};
+
+    void Clear()
+    {
+        memset(_words, 0, sizeof(_words));
+    }
+
+    bool IsNegative() const
+    {
+        return _words[NumWords - 1] >> 63;
+    }
+
+    // Adds or subtracts sig * 2**exp, which needs to be a multiple of 2**LsbExp. The carry or borrow
+    // is propagated a word at a time, and stops as soon as it is zero.
+    void Add(uint128 sig, int exp, bool negative)
+    {
+        int pos = exp - LsbExp;
+        if (pos < 0)
+        {
+            sig >>= -pos;
+            pos = 0;
+        }
+
+        int word = pos / 64;
+        int bit = pos % 64;
+        uint128 low = sig << bit;
+        uint64_t parts[3] = { (uint64_t)low, (uint64_t)(low >> 64), bit ? (uint64_t)(sig >> (128 - bit)) : 0 };
+
+        uint64_t carry = 0;
+        for (int i = word; i < NumWords; ++i)
+        {
+            uint64_t part = (i - word < 3 ? parts[i - word] : 0);
+            if (!negative)
+            {
+                uint128 sum = (uint128)_words[i] + part + carry;
+                _words[i] = (uint64_t)sum;
+                carry = (uint64_t)(sum >> 64);
+            }
+            else
+            {
+                uint128 diff = (uint128)_words[i] - part - carry;
+                _words[i] = (uint64_t)diff;
+                carry = (diff >> 64) != 0;
+            }
+            if (carry == 0 && i - word >= 2)
+            {
+                break;
+            }
+        }
+    }
+
+    void Add(const Unpacked &u)
+    {
+        if (u.kind == Unpacked::Finite)
+        {
+            Add(u.sig, u.exp, u.sign);
+        }
+    }
+
+    // The sum with its top 128 bits as the sig, lower bits jammed into the last one
+    Unpacked ToUnpacked() const
+    {
+        bool negative = IsNegative();
+        uint64_t words[NumWords];
+        uint64_t carry = 1;
+        for (int i = 0; i < NumWords; ++i)
+        {
+            words[i] = negative ? ~_words[i] + carry : _words[i];
+            carry = carry && words[i] == 0;
+        }
+
+        int top = NumWords - 1;
+        while (top >= 0 && words[top] == 0)
+        {
+            --top;
+        }
+        if (top < 0)
+        {
+            return Unpacked::Make(Unpacked::Zero);
+        }
+
+        int msb = top * 64 + 63 - __builtin_clzll(words[top]);
+        int start = std::max(0, msb - 127);
+        auto bitsAt = [&](int pos) -> uint64_t
+        {
+            int w = pos / 64;
+            int b = pos % 64;
+            if (w >= NumWords) return 0;
+            uint64_t res = words[w] >> b;
+            if (b != 0 && w + 1 < NumWords) res |= words[w + 1] << (64 - b);
+            return res;
+        };
+
+        bool lost = false;
+        for (int w = 0; w < start / 64; ++w)
+        {
+            lost |= words[w] != 0;
+        }
+        if (start % 64 != 0)
+        {
+            lost |= (words[start / 64] & ((1ull << (start % 64)) - 1)) != 0;
+        }
+
+        Unpacked res = Unpacked::Make(Unpacked::Finite, negative);
+        res.sig = ((uint128)bitsAt(start + 64) << 64 | bitsAt(start)) | lost;
+        res.exp = LsbExp + start;
+        return res;
+    }
+};
+
+template <typename ReprType>
+struct Quire;
+
+// Quire of the posit standard, 16n bits with the lowest bit at minpos**2. Other exponent sizes get
+// the same layout, from minpos**2 to maxpos**2 with 31 carry bits and the sign, rounded up to words.
+template <typename TraitsType>
+struct Quire<PositRepresentation<TraitsType>>
+{
+    using ReprType = PositRepresentation<TraitsType>;
+    using Format = SoftFloatFormat<ReprType>;
+
+    static constexpr int MaxScale = Format::MaxScale;
+    static constexpr int NumBits = (4 * MaxScale + 32 + 63) / 64 * 64;
+    static constexpr int LsbExp = -2 * MaxScale;
+
+    FixedPointAccumulator<NumBits / 64, LsbExp> _acc;
+    bool _isNaR = false;
+
+    void Clear()
+    {
+        _acc.Clear();
+        _isNaR = false;
+    }
+
+    void Add(uint64_t a, bool subtract = false)
+    {
+        Unpacked u = Format::Unpack(a);
+        _isNaR |= (u.kind == Unpacked::NaN);
+        u.sign ^= subtract;
+        _acc.Add(u);
+    }
+
+    // Adds a * b exactly, or subtracts it
+    void AddProduct(uint64_t a, uint64_t b, bool subtract = false)
+    {
+        Unpacked p = UnpackedMul(Format::Unpack(a), Format::Unpack(b));
+        _isNaR |= (p.kind == Unpacked::NaN);
+        p.sign ^= subtract;
+        _acc.Add(p);
+    }
+
+    void AddProducts(const uint64_t *a, const uint64_t *b, size_t n)
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            AddProduct(a[i], b[i]);
+        }
+    }
+
+    uint64_t Round(RoundingMode mode = ROUND_NEAREST_EVEN) const
+    {
+        return _isNaR ? ReprType::NaR() : Format::Round(_acc.ToUnpacked(), mode);
+    }
+};
+
+// Kulisch accumulator, from the square of the smallest subnormal to past the square of the largest
+// finite value, with 64 bits of headroom for carries
+template <typename TraitsType>
+struct Quire<IEEE754FloatRepresentation<TraitsType>>
+{
+    using ReprType = IEEE754FloatRepresentation<TraitsType>;
+    using Format = SoftFloatFormat<ReprType>;
+
+    static constexpr int LsbExp = 2 * (Format::MinExponent - (Format::Precision - 1));
+    static constexpr int MaxExp = 2 * (ReprType::MaxExponent + 1);
+    static constexpr int NumWords = (MaxExp - LsbExp + 64) / 64 + 1;
+
+    FixedPointAccumulator<NumWords, LsbExp> _acc;
+    bool _isNaN = false;
+    bool _hasPositiveInf = false;
+    bool _hasNegativeInf = false;
+
+    void Clear()
+    {
+        _acc.Clear();
+        _isNaN = _hasPositiveInf = _hasNegativeInf = false;
+    }
+
+    void Add(uint64_t a, bool subtract = false)
+    {
+        Unpacked u = Format::Unpack(a);
+        u.sign ^= subtract;
+        addUnpacked(u);
+    }
+
+    // Adds a * b exactly, or subtracts it
+    void AddProduct(uint64_t a, uint64_t b, bool subtract = false)
+    {
+        Unpacked p = UnpackedMul(Format::Unpack(a), Format::Unpack(b));
+        p.sign ^= subtract;
+        addUnpacked(p);
+    }
+
+    void AddProducts(const uint64_t *a, const uint64_t *b, size_t n)
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            AddProduct(a[i], b[i]);
+        }
+    }
+
+    uint64_t Round(RoundingMode mode = ROUND_NEAREST_EVEN) const
+    {
+        if (_isNaN || (_hasPositiveInf && _hasNegativeInf))
+        {
+            return ReprType::QuietNan();
+        }
+        if (_hasPositiveInf || _hasNegativeInf)
+        {
+            return _hasNegativeInf ? ReprType::NegativeInfinity() : ReprType::PositiveInfinity();
+        }
+        Unpacked sum = _acc.ToUnpacked();
+        sum.sign |= (sum.kind == Unpacked::Zero && mode == ROUND_DOWN);
+        return Format::Round(sum, mode);
+    }
+
+    void addUnpacked(const Unpacked &u)
+    {
+        _isNaN |= (u.kind == Unpacked::NaN);
+        _hasPositiveInf |= (u.kind == Unpacked::Infinite && !u.sign);
+        _hasNegativeInf |= (u.kind == Unpacked::Infinite && u.sign);
+        _acc.Add(u);
+    }
+};
+
+
+#ifdef RUN_TEST_FLOATINFO
+
+#include <float.h>
+#include <string.h>
+
+// Dot products whose large terms cancel exactly, leaving terms far below their rounding
+inline bool TestQuire()
+{
+    auto bits = [](double d) { uint64_t u; memcpy(&u, &d, 8); return u; };
+
+    int bad = 0;
+    Quire<IEEE754FloatRepresentation<IEEE754Float64Traits>> quire;
+
+    // (1 + 2**-52)(1 - 2**-52) - 1 is -2**-104 exactly, the sum in doubles is 0
+    const uint64_t a[] = { bits(1 + 0x1p-52), bits(1.0) };
+    const uint64_t b[] = { bits(1 - 0x1p-52), bits(-1.0) };
+    quire.AddProducts(a, b, 2);
+    bad += quire.Round() != bits(-0x1p-104);
+
+    // Squares of the largest value cancel, leaving products near the smallest subnormal, then
+    // products past the largest value cancel
+    quire.Clear();
+    const uint64_t c[] = { bits(DBL_MAX), bits(3.0), bits(-DBL_MAX), bits(DBL_TRUE_MIN) };
+    const uint64_t d[] = { bits(DBL_MAX), bits(0x1p-1074), bits(DBL_MAX), bits(0x1p60) };
+    quire.AddProducts(c, d, 4);
+    bad += quire.Round() != bits(0x1p-1014 + 3 * 0x1p-1074);
+
+    quire.Add(bits(1.0));
+    quire.AddProduct(bits(DBL_MAX), bits(2.0));
+    quire.AddProduct(bits(DBL_MAX), bits(2.0), true);
+    bad += quire.Round() != bits(1.0 + 0x1p-1014);
+
+    // Posits: minpos**2 is kept below maxpos**2 and rounds to minpos, the smallest result
+    using P16 = PositRepresentation<Posit16Traits>;
+    Quire<P16> positQuire;
+    const uint64_t e[] = { P16::MaxFinite(), P16::MinPositive(), P16::MaxFinite() };
+    const uint64_t f[] = { P16::MaxFinite(), P16::MinPositive(), P16::Negate(P16::MaxFinite()) };
+    positQuire.AddProducts(e, f, 3);
+    bad += positQuire.Round() != P16::MinPositive();
+    positQuire.AddProduct(P16::One(), P16::NaR());
+    bad += positQuire.Round() != P16::NaR();
+    return bad == 0;
+}
+
+#endif
@@ -0,0 +1,158 @@
+// Copyright 2023 Mustafa Serdar Sanli
+//
+// This file is part of FloatInfo.
+//
+// FloatInfo is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// FloatInfo is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with FloatInfo.  If not, see <https://www.gnu.org/licenses/>.
+
+// LSD radix sort of unsigned keys, a byte per pass. Each pass is a histogram and a scatter over
+// contiguous chunks, one chunk per thread, with the offsets of a chunk after those of the chunks
+// before it so the sort stays stable.
+
+#include <algorithm>
+#include <stdint.h>
+#include <stddef.h>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Below this many keys per thread, starting the threads costs more than it saves
+constexpr size_t RadixSortMinKeysPerThread = 1 << 16;
+
+// Calls f(t) for t in [0, numThreads), on the calling thread and numThreads - 1 others. Builds
+// without threads, like the web page, run them one after the other.
+template <typename F>
+void RunParallel(int numThreads, F &&f)
+{
+#if defined(__EMSCRIPTEN__) && !defined(__EMSCRIPTEN_PTHREADS__)
+    for (int t = 0; t < numThreads; ++t)
+    {
+        f(t);
+    }
+#else
+    std::vector<std::thread> threads;
+    for (int t = 1; t < numThreads; ++t)
+    {
+        threads.emplace_back([&f, t]() { f(t); });
+    }
+    f(0);
+    for (std::thread &thread : threads)
+    {
+        thread.join();
+    }
+#endif
+}
+
+// Sorts the n keys of keys, of which only the low numBytes bytes may be non-zero, using tmp of n
+// entries as the other buffer. Passes where every key has the same byte are skipped, which is
+// most of them for keys of narrow types or of values close together. Returns the buffer that has
+// the result, either keys or tmp.
+inline uint64_t* RadixSortKeys(uint64_t *keys, uint64_t *tmp, size_t n, int numBytes, int numThreads)
+{
+    numThreads = std::max(1, std::min<int>(numThreads, n / RadixSortMinKeysPerThread));
+    size_t chunk = (n + numThreads - 1) / std::max(1, numThreads);
+
+    std::vector<size_t> counts(numThreads * 256);
+    uint64_t *src = keys;
+    uint64_t *dst = tmp;
+    for (int pass = 0; pass < numBytes; ++pass)
+    {
+        int shift = pass * 8;
+        RunParallel(numThreads, [&](int t)
+        {
+            size_t *count = &counts[t * 256];
+            std::fill(count, count + 256, 0);
+            size_t end = std::min(n, (t + 1) * chunk);
+            for (size_t i = t * chunk; i < end; ++i)
+            {
+                ++count[(src[i] >> shift) & 255];
+            }
+        });
+
+        // Offsets of each byte value, for each chunk in order
+        size_t offset = 0;
+        bool isConstant = false;
+        for (int digit = 0; digit < 256; ++digit)
+        {
+            size_t total = 0;
+            for (int t = 0; t < numThreads; ++t)
+            {
+                size_t c = counts[t * 256 + digit];
+                counts[t * 256 + digit] = offset + total;
+                total += c;
+            }
+            isConstant |= (total == n);
+            offset += total;
+        }
+        if (isConstant)
+        {
+            continue;
+        }
+
+        RunParallel(numThreads, [&](int t)
+        {
+            size_t *next = &counts[t * 256];
+            size_t end = std::min(n, (t + 1) * chunk);
+            for (size_t i = t * chunk; i < end; ++i)
+            {
+                uint64_t key = src[i];
+                dst[next[(key >> shift) & 255]++] = key;
+            }
+        });
+        std::swap(src, dst);
+    }
+    return src;
+}
+
+
+#ifdef RUN_TEST
+
+#include <random>
+#include <stdio.h>
+
+int main()
+{
+    fprintf(stderr, "Running tests...\n");
+
+    std::mt19937_64 rng(42);
+    int bad = 0;
+    for (size_t n : { 0, 1, 2, 1000, 300000 })
+    {
+        for (int numBytes : { 1, 2, 3, 8 })
+        {
+            for (int numThreads : { 1, 3, 8 })
+            {
+                // Full width keys, and keys that share their top bytes so some passes are skipped
+                for (uint64_t mask : { ~0ull, 0xfffull })
+                {
+                    uint64_t keyMask = numBytes == 8 ? mask : mask & ((1ull << (8 * numBytes)) - 1);
+                    std::vector<uint64_t> keys(n), tmp(n);
+                    for (uint64_t &k : keys)
+                    {
+                        k = rng() & keyMask;
+                    }
+                    std::vector<uint64_t> expected = keys;
+                    std::sort(expected.begin(), expected.end());
+
+                    uint64_t *res = RadixSortKeys(keys.data(), tmp.data(), n, numBytes, numThreads);
+                    bad += !std::equal(expected.begin(), expected.end(), res);
+                }
+            }
+        }
+    }
+
+    fprintf(stderr, "test radix sort = %d\n", bad == 0);
+    return bad != 0;
+}
+
+#endif
@@ -0,0 +1,635 @@
+// Copyright 2023 Mustafa Serdar Sanli
+//
+// This file is part of FloatInfo.
+//
+// FloatInfo is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// FloatInfo is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with FloatInfo.  If not, see <https://www.gnu.org/licenses/>.
+
+// Scientific notation with a fixed number of significant digits, and C99 hex floats, of values
+// sig * 2**exp or coefficient * 10**scale.
+//
+// The digits are generated like the fixed precision mode of Dragon4: the value is the fraction r / s
+// of two integers, scaled by a power of ten to [0.1, 1), and each chunk of nine digits is the integer
+// part of 10**9 times the remaining fraction. Only as many digits as asked for are generated, so the
+// work depends on the size of the exponent rather than on the length of the full expansion. The same
+// generator streams the exact expansions a piece at a time.
+
+#include <algorithm>
+#include <cmath>
+#include <errno.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+
+constexpr int ScientificDefaultDigits = 17;
+constexpr int ScientificMaxDigits = 1000;
+
+// Non-negative integer in base 2**32 limbs, least significant first, with just the operations the
+// digit generation and the conversion of decimals to binary need
+struct DigitBigInt
+{
+    static DigitBigInt FromInteger(unsigned __int128 num)
+    {
+        DigitBigInt res;
+        while (num)
+        {
+            res._limbs.push_back((uint32_t)num);
+            num >>= 32;
+        }
+        return res;
+    }
+
+    bool IsZero() const
+    {
+        return _limbs.empty();
+    }
+
+    int BitLength() const
+    {
+        if (_limbs.empty())
+        {
+            return 0;
+        }
+        return 32 * (_limbs.size() - 1) + (32 - __builtin_clz(_limbs.back()));
+    }
+
+    void ShiftLeft(int bits)
+    {
+        if (_limbs.empty() || bits == 0)
+        {
+            return;
+        }
+
+        int limbShift = bits / 32;
+        int bitShift = bits % 32;
+        _limbs.insert(_limbs.begin(), limbShift, 0);
+        if (bitShift)
+        {
+            uint32_t carry = 0;
+            for (size_t i = limbShift; i < _limbs.size(); ++i)
+            {
+                uint32_t limb = _limbs[i];
+                _limbs[i] = (limb << bitShift) | carry;
+                carry = limb >> (32 - bitShift);
+            }
+            if (carry)
+            {
+                _limbs.push_back(carry);
+            }
+        }
+    }
+
+    void MulSmall(uint32_t m)
+    {
+        uint64_t carry = 0;
+        for (uint32_t &limb : _limbs)
+        {
+            uint64_t val = (uint64_t)limb * m + carry;
+            limb = (uint32_t)val;
+            carry = val >> 32;
+        }
+        if (carry)
+        {
+            _limbs.push_back((uint32_t)carry);
+        }
+    }
+
+    void MulPow10(int p)
+    {
+        for (; p >= 9; p -= 9)
+        {
+            MulSmall(1000000000);
+        }
+        static constexpr uint32_t Pow10[] = { 1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000 };
+        if (p > 0)
+        {
+            MulSmall(Pow10[p]);
+        }
+    }
+
+    void MulPow5(int p)
+    {
+        for (; p >= 13; p -= 13)
+        {
+            MulSmall(1220703125);
+        }
+        uint32_t pow5 = 1;
+        for (int i = 0; i < p; ++i)
+        {
+            pow5 *= 5;
+        }
+        MulSmall(pow5);
+    }
+
+    // The top numBits bits, with the bits below them ORed into the lowest one, and the shift so
+    // that the value is about res * 2**shift. numBits is at most 128.
+    unsigned __int128 TopBits(int numBits, int &shift) const
+    {
+        shift = std::max(0, BitLength() - numBits);
+        unsigned __int128 res = 0;
+        for (int bit = BitLength() - 1; bit >= shift; --bit)
+        {
+            res = (res << 1) | ((_limbs[bit / 32] >> (bit % 32)) & 1);
+        }
+
+        bool sticky = false;
+        for (int i = 0; i < shift / 32; ++i)
+        {
+            sticky |= _limbs[i] != 0;
+        }
+        if (shift % 32)
+        {
+            sticky |= (_limbs[shift / 32] & ((1u << (shift % 32)) - 1)) != 0;
+        }
+        return res | sticky;
+    }
+
+    // The value shifted right by shift bits, which must fit 96 bits
+    unsigned __int128 BitsFrom(int shift) const
+    {
+        unsigned __int128 res = 0;
+        for (int i = (int)_limbs.size() - 1; i >= shift / 32; --i)
+        {
+            res = (res << 32) | _limbs[i];
+        }
+        return res >> (shift % 32);
+    }
+
+    int Compare(const DigitBigInt &ot) const
+    {
+        if (_limbs.size() != ot._limbs.size())
+        {
+            return _limbs.size() < ot._limbs.size() ? -1 : 1;
+        }
+        for (size_t i = _limbs.size(); i-- > 0;)
+        {
+            if (_limbs[i] != ot._limbs[i])
+            {
+                return _limbs[i] < ot._limbs[i] ? -1 : 1;
+            }
+        }
+        return 0;
+    }
+
+    // Requires ot <= *this
+    void Sub(const DigitBigInt &ot)
+    {
+        int64_t borrow = 0;
+        for (size_t i = 0; i < _limbs.size(); ++i)
+        {
+            int64_t val = (int64_t)_limbs[i] - (i < ot._limbs.size() ? ot._limbs[i] : 0) - borrow;
+            borrow = val < 0;
+            _limbs[i] = (uint32_t)(val + (borrow << 32));
+        }
+        while (_limbs.size() && _limbs.back() == 0)
+        {
+            _limbs.pop_back();
+        }
+    }
+
+    std::vector<uint32_t> _limbs;
+};
+
+// Significant digits from [1, ScientificMaxDigits] written as plain decimal digits, the default for
+// anything else, including text with spaces or other characters around the number
+inline int ParseScientificDigits(const char *str)
+{
+    if (!str || *str < '0' || *str > '9')
+    {
+        return ScientificDefaultDigits;
+    }
+    char *end;
+    errno = 0;
+    long numDigits = strtol(str, &end, 10);
+    if (*end != '\0' || errno == ERANGE || numDigits < 1 || numDigits > ScientificMaxDigits)
+    {
+        return ScientificDefaultDigits;
+    }
+    return numDigits;
+}
+
+// d.ddde+XX as printf %e, from the significant digits and the exponent of the first one
+inline std::string FormatScientific(bool sign, const std::string &digits, int exp10)
+{
+    std::string res = sign ? "-" : "";
+    res += digits[0];
+    if (digits.size() > 1)
+    {
+        res += '.';
+        res.append(digits, 1, std::string::npos);
+    }
+    res += (exp10 < 0 ? "e-" : "e+");
+    std::string expDigits = std::to_string(std::abs(exp10));
+    if (expDigits.size() < 2)
+    {
+        res += '0';
+    }
+    return res + expDigits;
+}
+
+// Adds one to the last digit, returns true if it carried out of the first one, which leaves
+// the digits as 000...
+inline bool IncrementDigits(std::string &digits)
+{
+    for (size_t i = digits.size(); i-- > 0;)
+    {
+        if (digits[i] != '9')
+        {
+            ++digits[i];
+            return false;
+        }
+        digits[i] = '0';
+    }
+    return true;
+}
+
+// Decimal digits of a value from the most significant one, nine at a time. The value is kept as
+// r / s * 10**Exponent() with r / s in [0.1, 1), and each chunk is the integer part of 10**9 times the
+// remaining fraction. Values of binary and decimal types have finite expansions, and the
+// generator is done when the fraction is zero.
+struct DecimalDigitGenerator
+{
+    static constexpr int ChunkDigits = 9;
+
+    // sig * 2**exp, sig not zero
+    void StartBinary(unsigned __int128 sig, int exp)
+    {
+        _r = DigitBigInt::FromInteger(sig);
+        _s = DigitBigInt::FromInteger(1);
+        _r.ShiftLeft(std::max(exp, 0));
+        _s.ShiftLeft(std::max(-exp, 0));
+
+        // Estimate from the position of the top bit, fixed by scale
+        int topBit = DigitBigInt::FromInteger(sig).BitLength() - 1 + exp;
+        scale((int)std::floor(topBit * 0.30102999566398120) + 1);
+    }
+
+    // coefficient * 10**exp, coefficient not zero
+    void StartDecimal(unsigned __int128 coefficient, int exp)
+    {
+        int numDigits = 0;
+        for (unsigned __int128 c = coefficient; c; c /= 10)
+        {
+            ++numDigits;
+        }
+        _r = DigitBigInt::FromInteger(coefficient);
+        _s = DigitBigInt::FromInteger(1);
+        _r.MulPow10(std::max(exp, 0));
+        _s.MulPow10(std::max(-exp, 0));
+        scale(numDigits + exp);
+    }
+
+    // The value is 0.ddd... * 10**Exponent(), with a non-zero first digit
+    int Exponent() const
+    {
+        return _exp10;
+    }
+
+    bool IsDone() const
+    {
+        return _r.IsZero();
+    }
+
+    // Appends the next ChunkDigits digits, zeros once done
+    void NextChunk(std::string &digits)
+    {
+        _r.MulSmall(1000000000);
+
+        // The quotient is below 10**9, estimated from the top 64 bits of s, never above the actual
+        // one and off by a few at most, then fixed by subtracting s
+        int shift = std::max(0, _s.BitLength() - 64);
+        uint64_t sTop = (uint64_t)_s.BitsFrom(shift);
+        unsigned __int128 rTop = _r.BitsFrom(shift);
+        uint64_t q = (uint64_t)(shift == 0 ? rTop / sTop : rTop / ((unsigned __int128)sTop + 1));
+        DigitBigInt qs = _s;
+        qs.MulSmall((uint32_t)q);
+        _r.Sub(qs);
+        while (_r.Compare(_s) >= 0)
+        {
+            _r.Sub(_s);
+            ++q;
+        }
+
+        char chunk[ChunkDigits];
+        for (int i = ChunkDigits - 1; i >= 0; --i)
+        {
+            chunk[i] = '0' + q % 10;
+            q /= 10;
+        }
+        digits.append(chunk, ChunkDigits);
+    }
+
+    // Brings r / s to [0.1, 1) given k with 10**(k-1) <= value < 10**k, or off by one
+    void scale(int k)
+    {
+        if (k >= 0)
+        {
+            _s.MulPow10(k);
+        }
+        else
+        {
+            _r.MulPow10(-k);
+        }
+
+        while (_r.Compare(_s) >= 0)
+        {
+            _s.MulSmall(10);
+            ++k;
+        }
+        for (;;)
+        {
+            DigitBigInt r10 = _r;
+            r10.MulSmall(10);
+            if (r10.Compare(_s) >= 0)
+            {
+                break;
+            }
+            _r = std::move(r10);
+            --k;
+        }
+        _exp10 = k;
+    }
+
+    DigitBigInt _r;
+    DigitBigInt _s;
+    int _exp10 = 0;
+};
+
+// The first numDigits of digits rounded to nearest even, with sticky telling if there are non-zero
+// digits past the given ones, in scientific notation. exp10 is the exponent of the first digit.
+inline std::string RoundScientific(bool sign, std::string digits, bool sticky, int exp10, int numDigits)
+{
+    if ((int)digits.size() <= numDigits)
+    {
+        digits.resize(numDigits, '0');
+        return FormatScientific(sign, digits, exp10);
+    }
+
+    char next = digits[numDigits];
+    bool isAboveHalf = sticky || digits.find_first_not_of('0', numDigits + 1) != std::string::npos;
+    digits.resize(numDigits);
+    bool isUp = next > '5' || (next == '5' && (isAboveHalf || (digits.back() - '0') % 2 == 1));
+    if (isUp && IncrementDigits(digits))
+    {
+        digits[0] = '1';
+        ++exp10;
+    }
+    return FormatScientific(sign, digits, exp10);
+}
+
+// sig * 2**exp with numDigits significant digits, rounded to nearest even
+inline std::string RenderScientific(bool sign, unsigned __int128 sig, int exp, int numDigits)
+{
+    if (sig == 0)
+    {
+        return FormatScientific(sign, std::string(numDigits, '0'), 0);
+    }
+
+    // Only the digits up to the one after the last kept are generated, the rest is the remainder
+    DecimalDigitGenerator gen;
+    gen.StartBinary(sig, exp);
+    std::string digits;
+    while ((int)digits.size() <= numDigits && !gen.IsDone())
+    {
+        gen.NextChunk(digits);
+    }
+    return RoundScientific(sign, std::move(digits), !gen.IsDone(), gen.Exponent() - 1, numDigits);
+}
+
+// coefficient * 10**scale with numDigits significant digits, rounded to nearest even
+inline std::string RenderScientificDecimal(bool sign, const std::string &coefficientDigits, int scale, int numDigits)
+{
+    std::string digits = coefficientDigits;
+    digits.erase(0, std::min(digits.find_first_not_of('0'), digits.size()));
+    if (digits.empty())
+    {
+        return FormatScientific(sign, std::string(numDigits, '0'), 0);
+    }
+    int exp10 = scale + (int)digits.size() - 1;
+    return RoundScientific(sign, std::move(digits), false, exp10, numDigits);
+}
+
+// The exact base 10 text of a value, as RenderExact writes it with numFractionDigits after the dot,
+// produced a piece at a time from the first character. Only the remainder of the digit generation
+// and the digits of the current chunk are held, so the text of the longest expansions can be
+// written out as it is produced, and the first piece comes after the scaling of the value rather
+// than after all of its digits.
+struct ExactDecimalStream
+{
+    void StartBinary(bool sign, unsigned __int128 sig, int exp, int numFractionDigits)
+    {
+        if (sig)
+        {
+            _gen.StartBinary(sig, exp);
+        }
+        start(sign, sig != 0, numFractionDigits);
+    }
+
+    void StartDecimal(bool sign, unsigned __int128 coefficient, int exp, int numFractionDigits)
+    {
+        if (coefficient)
+        {
+            _gen.StartDecimal(coefficient, exp);
+        }
+        start(sign, coefficient != 0, numFractionDigits);
+    }
+
+    // Appends up to maxChars more characters to out, returns false when there are none left
+    bool Next(std::string &out, size_t maxChars)
+    {
+        size_t numWritten = 0;
+        if (_isNegative && numWritten < maxChars)
+        {
+            out += '-';
+            _isNegative = false;
+            ++numWritten;
+        }
+        while (numWritten < maxChars && _power >= -_numFractionDigits)
+        {
+            if (_power == -1 && !_isDotWritten)
+            {
+                out += '.';
+                _isDotWritten = true;
+            }
+            else
+            {
+                out += (_power >= _firstPower ? '0' : nextDigit());
+                --_power;
+            }
+            ++numWritten;
+        }
+        return numWritten > 0;
+    }
+
+    void start(bool sign, bool isNonZero, int numFractionDigits)
+    {
+        _isNegative = sign;
+        _numFractionDigits = numFractionDigits;
+        _firstPower = isNonZero ? _gen.Exponent() : 0;
+        _power = std::max(_firstPower - 1, 0);
+        _isDotWritten = false;
+        _chunk.clear();
+        _chunkPos = 0;
+    }
+
+    char nextDigit()
+    {
+        if (_chunkPos == _chunk.size())
+        {
+            _chunk.clear();
+            _chunkPos = 0;
+            if (_gen.IsDone())
+            {
+                return '0';
+            }
+            _gen.NextChunk(_chunk);
+        }
+        return _chunk[_chunkPos++];
+    }
+
+    DecimalDigitGenerator _gen;
+    bool _isNegative = false;
+    bool _isDotWritten = false;
+    int _numFractionDigits = 0;
+    int _firstPower = 0;  // Power of ten of the first generated digit, plus one
+    int _power = 0;       // of the next digit to write
+    std::string _chunk;
+    size_t _chunkPos = 0;
+};
+
+// Exact C99 hex float of sig * 2**exp, normalized to a leading 1 as 0x1.8p+3, or 0x0p+0
+inline std::string RenderHexFloat(bool sign, DigitBigInt sig, int exp)
+{
+    std::string res = sign ? "-0x" : "0x";
+    if (sig.IsZero())
+    {
+        return res + "0p+0";
+    }
+
+    // Pad the bits after the leading one to whole hex digits
+    int numFractionBits = sig.BitLength() - 1;
+    int pad = (4 - numFractionBits % 4) % 4;
+    sig.ShiftLeft(pad);
+
+    static constexpr char HexDigits[] = "0123456789abcdef";
+    std::string hex;
+    for (int i = (numFractionBits + pad) / 4; i >= 0; --i)
+    {
+        hex += HexDigits[(sig._limbs[i / 8] >> (4 * (i % 8))) & 15];
+    }
+    hex.erase(hex.find_last_not_of('0') + 1);
+
+    res += hex[0];
+    if (hex.size() > 1)
+    {
+        res += '.';
+        res.append(hex, 1, std::string::npos);
+    }
+    int exp2 = exp + numFractionBits;
+    return res + (exp2 < 0 ? "p-" : "p+") + std::to_string(std::abs(exp2));
+}
+
+
+#ifdef RUN_TEST
+
+#include <random>
+#include <stdio.h>
+#include <string.h>
+
+int main()
+{
+    fprintf(stderr, "Running tests...\n");
+
+    std::mt19937_64 rng(42);
+    int bad = 0;
+    for (int i = 0; i < 200000; ++i)
+    {
+        uint64_t bits = rng();
+        if (i % 4 == 0)
+        {
+            bits &= (1ull << 52) - 1 + (1ull << 63); // Denormals
+        }
+        double d;
+        memcpy(&d, &bits, 8);
+        if (!std::isfinite(d))
+        {
+            continue;
+        }
+
+        bool sign = bits >> 63;
+        int biased = (bits >> 52) & 2047;
+        uint64_t sig = (bits & ((1ull << 52) - 1)) | ((uint64_t)(biased != 0) << 52);
+        int exp = std::max(biased, 1) - 1075;
+
+        int numDigits = 1 + i % 40;
+        char buf[128];
+        snprintf(buf, sizeof(buf), "%.*e", numDigits - 1, d);
+        bad += RenderScientific(sign, sig, exp, numDigits) != buf;
+
+        std::string hex = RenderHexFloat(sign, DigitBigInt::FromInteger(sig), exp);
+        bad += strtod(hex.c_str(), nullptr) != d || (biased != 0 && (snprintf(buf, sizeof(buf), "%a", d), hex != buf));
+
+        // glibc prints the exact expansion with as many digits as asked for
+        if (i % 16 == 0)
+        {
+            int numFractionDigits = std::max(0, -exp);
+            std::vector<char> exact(numFractionDigits + 400);
+            snprintf(exact.data(), exact.size(), "%.*f", numFractionDigits, d);
+            ExactDecimalStream stream;
+            stream.StartBinary(sign, sig, exp, numFractionDigits);
+            std::string streamed;
+            while (stream.Next(streamed, 1 + i % 100))
+            {
+            }
+            bad += streamed != exact.data();
+        }
+    }
+
+    // Ties to even, and a carry into a new digit
+    bad += RenderScientific(false, 125, -2, 2) != "3.1e+01";
+    bad += RenderScientific(false, 135, -2, 2) != "3.4e+01";
+    bad += RenderScientific(false, 999, 0, 2) != "1.0e+03";
+    bad += RenderScientificDecimal(true, "1250", -3, 2) != "-1.2e+00";
+    bad += RenderScientificDecimal(false, "12501", -4, 2) != "1.3e+00";
+    bad += RenderScientificDecimal(false, "9996", 0, 3) != "1.00e+04";
+    bad += RenderScientificDecimal(false, "0", 5, 3) != "0.00e+00";
+    bad += RenderScientificDecimal(false, "7", -400, 3) != "7.00e-400";
+
+    // Only whole numbers of digits in range, the default otherwise
+    bad += ParseScientificDigits("1") != 1 || ParseScientificDigits("1000") != 1000 || ParseScientificDigits("007") != 7;
+    for (const char *text : { "", "0", "1001", "-5", "+5", " 5", "5 ", "3x", "x", "99999999999999999999" })
+    {
+        bad += ParseScientificDigits(text) != ScientificDefaultDigits;
+    }
+    bad += ParseScientificDigits(nullptr) != ScientificDefaultDigits;
+
+    std::string streamed;
+    ExactDecimalStream stream;
+    stream.StartDecimal(true, 12500, -3, 3);
+    while (stream.Next(streamed, 2))
+    {
+    }
+    bad += streamed != "-12.500";
+    streamed.clear();
+    stream.StartDecimal(false, 0, 2, 0);
+    while (stream.Next(streamed, 1))
+    {
+    }
+    bad += streamed != "0";
+
+    fprintf(stderr, "test scientific = %d\n", bad == 0);
+    return bad != 0;
+}
+
+#endif
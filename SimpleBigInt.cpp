@@ -16,16 +16,28 @@
 // along with FloatInfo.  If not, see <https://www.gnu.org/licenses/>.
 
 #include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <string_view>
 #include <vector>
-#include <iostream>
-#include <charconv>
+
+#include "Stats.cpp"
 
 // Stores base-10 digits in uint32, ignoring overflow mid operation
-// Addition and multiplication only
+// Addition, multiplication, and subtraction of a smaller number only
 // No negative numbers
 // No divisions, except 1/2 is hardcoded as "0.5" so pwers of two can be computed
 // Should be enough for stringifying floats
 
+// Errors are only reported, stdio is used rather than iostream to keep the wasm binary small
+inline void ReportError(std::string_view msg)
+{
+    fwrite(msg.data(), 1, msg.size(), stderr);
+}
+
 template <uint32_t Base>
 struct SimpleNumberBase
 {
@@ -33,7 +45,7 @@ struct SimpleNumberBase
 
     struct DigitStore
     {
-        std::vector<uint32_t> _digits;
+        StatsDigitVector _digits;
         int _minExpo = 0;
 
         void allocate(int minExpo, int numDigits)
@@ -62,7 +74,7 @@ struct SimpleNumberBase
             const uint32_t *p = getDigitPtr(expo);
             if (!p)
             {
-                std::cerr << "error\n";
+                ReportError("error\n");
                 return;
             }
             *const_cast<uint32_t*>(p) += val;
@@ -76,6 +88,18 @@ struct SimpleNumberBase
             }
         }
 
+        // Drops the zero digits below the lowest non-zero one
+        void removeTrailingZeroes()
+        {
+            size_t n = 0;
+            while (n < _digits.size() && _digits[n] == 0)
+            {
+                ++n;
+            }
+            _digits.erase(_digits.begin(), _digits.begin() + n);
+            _minExpo += n;
+        }
+
         void normalize()
         {
             uint32_t carry = 0;
@@ -125,7 +149,9 @@ struct SimpleNumberBase
         }
         if (error)
         {
-            std::cerr << "error parsing number [" << num << "]\n";
+            ReportError("error parsing number [");
+            ReportError(num);
+            ReportError("]\n");
             _store.allocate(0, 0);
             return;
         }
@@ -171,8 +197,81 @@ struct SimpleNumberBase
         return res;
     }
 
+    // Requires *this >= ot, as there are no negative numbers
+    Self operator-(const Self &ot) const
+    {
+        Self res;
+
+        int minExpo = std::min(_store._minExpo, ot._store._minExpo);
+        int maxExpo = std::max(_store._minExpo + (int)_store._digits.size() - 1, ot._store._minExpo + (int)ot._store._digits.size() - 1);
+        int numDigits = (maxExpo - minExpo) + 1;
+        res._store.allocate(minExpo, std::max(numDigits, 0));
+
+        uint32_t borrow = 0;
+        for (int i = minExpo; i <= maxExpo; ++i)
+        {
+            uint32_t sub = ot._store.getDigit(i) + borrow;
+            uint32_t dig = _store.getDigit(i);
+            borrow = (dig < sub);
+            res._store._digits[i - minExpo] = dig + (borrow ? Base : 0) - sub;
+        }
+
+        res._store.removeLeadingZeroes();
+        return res;
+    }
+
+    bool IsZero() const
+    {
+        return std::all_of(_store._digits.begin(), _store._digits.end(), [](uint32_t d) { return d == 0; });
+    }
+
+    // Negative, zero or positive as *this is below, equal to or above ot
+    int Compare(const Self &ot) const
+    {
+        int minExpo = std::min(_store._minExpo, ot._store._minExpo);
+        int maxExpo = std::max(_store._minExpo + (int)_store._digits.size(), ot._store._minExpo + (int)ot._store._digits.size()) - 1;
+        for (int i = maxExpo; i >= minExpo; --i)
+        {
+            uint32_t a = _store.getDigit(i);
+            uint32_t b = ot._store.getDigit(i);
+            if (a != b)
+            {
+                return a < b ? -1 : 1;
+            }
+        }
+        return 0;
+    }
+
+    // Digits of *this / ot down to Base**minExpo, by long division. Sets inexact when the rest
+    // is not zero. ot must not be zero.
+    Self Divide(const Self &ot, int minExpo, bool &inexact) const
+    {
+        Self rem = *this;
+        rem._store.removeLeadingZeroes();
+        Self divisor = ot;
+        divisor._store.removeLeadingZeroes();
+        int divisorMinExpo = divisor._store._minExpo;
+        int maxExpo = (rem._store._minExpo + (int)rem._store._digits.size()) - (divisorMinExpo + (int)divisor._store._digits.size());
+
+        Self res;
+        res._store.allocate(minExpo, std::max(maxExpo - minExpo + 1, 0));
+        for (int i = maxExpo; i >= minExpo; --i)
+        {
+            divisor._store._minExpo = divisorMinExpo + i;
+            while (rem.Compare(divisor) >= 0)
+            {
+                rem = rem - divisor;
+                res._store.addToDigit(i, 1);
+            }
+        }
+        res._store.removeLeadingZeroes();
+        inexact = !rem.IsZero();
+        return res;
+    }
+
     Self operator*(const Self &ot) const
     {
+        STATS_SCOPE(STATS_MUL);
         Self res;
 
         int minExpo = _store._minExpo + ot._store._minExpo;
@@ -195,35 +294,88 @@ struct SimpleNumberBase
 
         res._store.normalize();
         res._store.removeLeadingZeroes();
+        STATS_DIGITS(res._store._digits.size());
         return res;
     }
 
-    static Self pow2(int p)
+    template <typename UInt>
+    static Self FromInteger(UInt num)
+    {
+        Self res;
+        while (num)
+        {
+            res._store._digits.push_back(num % Base);
+            num /= Base;
+        }
+        return res;
+    }
+
+    // Multiplies in place by m, which needs to be small enough that a digit times m fits in 64 bits
+    void MulSmall(uint64_t m)
     {
-        const char *half = (Base == 10 ? "0.5" : "0.1");
-        const char *two = (Base == 10 ? "2" : "10");
+        uint64_t carry = 0;
+        for (uint32_t &digit : _store._digits)
+        {
+            uint64_t val = digit * m + carry;
+            digit = val % Base;
+            carry = val / Base;
+        }
+        while (carry)
+        {
+            _store._digits.push_back(carry % Base);
+            carry /= Base;
+        }
+    }
+
+    // Multiplies in place by 2**s, for the part s of p that can be done in one pass over the digits.
+    // Returns s, which has the same sign as p.
+    int MulPow2Slice(int p)
+    {
+        if (Base == 2 || p == 0)
+        {
+            _store._minExpo += p;
+            return p;
+        }
 
-        Self res("1");
-        Self cur(p < 0 ? half : two);
-        p = (p < 0 ? -p : p);
+        STATS_SCOPE(STATS_POW2);
 
-        for (int bit = 0; (1 << bit) <= p; ++bit)
+        if (p > 0)
         {
-            if ((1 << bit) & p)
-            {
-                res = res * cur;
-            }
+            int s = std::min(p, 28);
+            MulSmall(1ull << s);
+            STATS_DIGITS(_store._digits.size());
+            return s;
+        }
 
-            cur = cur * cur;
+        // 2**-s = 5**s * 10**-s
+        int s = std::min(-p, 13);
+        uint64_t pow5 = 1;
+        for (int i = 0; i < s; ++i)
+        {
+            pow5 *= 5;
+        }
+        MulSmall(pow5);
+        _store._minExpo -= s;
+        STATS_DIGITS(_store._digits.size());
+        return -s;
+    }
+
+    static Self pow2(int p)
+    {
+        Self res = FromInteger(1);
+        while (p != 0)
+        {
+            p -= res.MulPow2Slice(p);
         }
         return res;
     }
 
     std::string render(int numFractionDigits = -1) const
     {
+        STATS_SCOPE(STATS_RENDER);
         std::string res;
         int minExpo = std::min(_store._minExpo, 0);
-        int maxExpo = std::max(0, minExpo + (int)_store._digits.size() - 1);
+        int maxExpo = std::max(0, _store._minExpo + (int)_store._digits.size() - 1);
 
         if (numFractionDigits != -1)
         {
@@ -238,19 +390,238 @@ struct SimpleNumberBase
                 res.push_back('.');
             }
         }
+        STATS_DIGITS(res.size());
         return res;
     }
 
     void Dump()
     {
-        std::cerr << "Num = " << render() << "\n";
+        fprintf(stderr, "Num = %s\n", render().c_str());
         for (int i = 0; i < _store._digits.size(); ++i)
         {
-            std::cerr << _store._digits[i] << " * " << Base << "**(" << i + _store._minExpo << ")\n";
+            fprintf(stderr, "%u * %u**(%d)\n", _store._digits[i], Base, i + _store._minExpo);
         }
     }
 };
 
+// Limits how much work a resumable computation does in one call, zero means no limit
+struct StepBudget
+{
+    StepBudget(int64_t maxOps, int64_t maxMicros)
+        : _maxOps(maxOps)
+        , _maxMicros(maxMicros)
+        , _start(std::chrono::steady_clock::now())
+    {
+    }
+
+    // Counts `ops` digit operations, returns true if the budget is used up
+    bool Spend(int64_t ops)
+    {
+        _ops += ops;
+        if (_maxOps > 0 && _ops >= _maxOps)
+        {
+            return true;
+        }
+        if (_maxMicros > 0)
+        {
+            auto elapsed = std::chrono::steady_clock::now() - _start;
+            return std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count() >= _maxMicros;
+        }
+        return false;
+    }
+
+    int64_t _maxOps;
+    int64_t _maxMicros;
+    int64_t _ops = 0;
+    std::chrono::steady_clock::time_point _start;
+};
+
+// Integer in base 10**9 limbs, least significant first. The powers of two and five that the widest
+// types need are built with it by repeated squaring, Karatsuba for long operands, which is much less
+// work than a MulPow2Slice pass per few bits over a digit per uint32.
+struct LimbNumber
+{
+    static constexpr uint32_t Base = 1000000000;
+    static constexpr size_t KaratsubaMinLimbs = 32;
+
+    using Limbs = StatsDigitVector;
+
+    template <typename UInt>
+    static LimbNumber FromInteger(UInt num)
+    {
+        LimbNumber res;
+        while (num)
+        {
+            res._limbs.push_back(num % Base);
+            num /= Base;
+        }
+        return res;
+    }
+
+    LimbNumber operator*(const LimbNumber &ot) const
+    {
+        STATS_SCOPE(STATS_MUL);
+        LimbNumber res;
+        res._limbs = Mul(_limbs, ot._limbs);
+        STATS_DIGITS(res._limbs.size() * 9);
+        return res;
+    }
+
+    void MulSmall(uint32_t m)
+    {
+        uint64_t carry = 0;
+        for (uint32_t &limb : _limbs)
+        {
+            uint64_t val = (uint64_t)limb * m + carry;
+            limb = val % Base;
+            carry = val / Base;
+        }
+        if (carry)
+        {
+            _limbs.push_back(carry);
+        }
+    }
+
+    // Decimal digits, least significant first, without leading zeroes
+    void ToDigits(StatsDigitVector &digits) const
+    {
+        digits.assign(_limbs.size() * 9, 0);
+        for (size_t i = 0; i < _limbs.size(); ++i)
+        {
+            uint32_t limb = _limbs[i];
+            for (int j = 0; j < 9; ++j)
+            {
+                digits[i * 9 + j] = limb % 10;
+                limb /= 10;
+            }
+        }
+        while (digits.size() && digits.back() == 0)
+        {
+            digits.pop_back();
+        }
+    }
+
+    static void Trim(Limbs &a)
+    {
+        while (a.size() && a.back() == 0)
+        {
+            a.pop_back();
+        }
+    }
+
+    static Limbs Add(const Limbs &a, const Limbs &b)
+    {
+        Limbs res(std::max(a.size(), b.size()) + 1, 0);
+        AddShifted(res, a, 0);
+        AddShifted(res, b, 0);
+        Trim(res);
+        return res;
+    }
+
+    // res += a * Base**shift, res needs room for the result
+    static void AddShifted(Limbs &res, const Limbs &a, size_t shift)
+    {
+        uint32_t carry = 0;
+        size_t i = 0;
+        for (; i < a.size() || carry; ++i)
+        {
+            uint32_t val = res[i + shift] + carry + (i < a.size() ? a[i] : 0);
+            carry = val >= Base;
+            res[i + shift] = val - (carry ? Base : 0);
+        }
+    }
+
+    // a -= b, requires a >= b
+    static void Sub(Limbs &a, const Limbs &b)
+    {
+        uint32_t borrow = 0;
+        for (size_t i = 0; i < b.size() || borrow; ++i)
+        {
+            uint32_t sub = borrow + (i < b.size() ? b[i] : 0);
+            borrow = a[i] < sub;
+            a[i] = a[i] + (borrow ? Base : 0) - sub;
+        }
+        Trim(a);
+    }
+
+    static Limbs Mul(const Limbs &a, const Limbs &b)
+    {
+        if (std::min(a.size(), b.size()) < KaratsubaMinLimbs)
+        {
+            Limbs res(a.size() + b.size(), 0);
+            for (size_t i = 0; i < a.size(); ++i)
+            {
+                uint64_t carry = 0;
+                for (size_t j = 0; j < b.size(); ++j)
+                {
+                    uint64_t val = res[i + j] + (uint64_t)a[i] * b[j] + carry;
+                    res[i + j] = val % Base;
+                    carry = val / Base;
+                }
+                res[i + b.size()] = carry;
+            }
+            Trim(res);
+            return res;
+        }
+
+        // a * b = z2 * B**2h + z1 * B**h + z0, with z1 from a single product of the half sums
+        size_t h = std::max(a.size(), b.size()) / 2;
+        auto split = [h](const Limbs &x, Limbs &lo, Limbs &hi) {
+            lo.assign(x.begin(), x.begin() + std::min(h, x.size()));
+            hi.assign(x.begin() + std::min(h, x.size()), x.end());
+            Trim(lo);
+        };
+        Limbs a0, a1, b0, b1;
+        split(a, a0, a1);
+        split(b, b0, b1);
+
+        Limbs z0 = Mul(a0, b0);
+        Limbs z2 = Mul(a1, b1);
+        Limbs z1 = Mul(Add(a0, a1), Add(b0, b1));
+        Sub(z1, z0);
+        Sub(z1, z2);
+
+        Limbs res(a.size() + b.size() + 1, 0);
+        AddShifted(res, z0, 0);
+        AddShifted(res, z1, h);
+        AddShifted(res, z2, 2 * h);
+        Trim(res);
+        return res;
+    }
+
+    Limbs _limbs;
+};
+
+struct SimpleNumber;
+
+// Computes num * 2**exp a pass over the digits at a time, so very long expansions can be spread over
+// several calls. Above LimbPowerMinExp the base10 power is built in limbs instead, a squaring per call.
+struct ScaledNumberJob
+{
+    static constexpr int LimbPowerMinExp = 64;
+
+    template <typename UInt>
+    void Start(UInt num, int exp);
+
+    // Returns true when the result is ready
+    bool Step(StepBudget &budget);
+
+    bool IsDone() const
+    {
+        return _remainingExp == 0;
+    }
+
+    SimpleNumberBase<2> _base2;
+    SimpleNumberBase<10> _base10;
+    int _remainingExp = 0;
+
+    // Binary powering of 2**exp, or 5**-exp for negative exp, from the top bit of the exponent down.
+    // _powerBit is the next bit to take, -1 when the limb path is not used.
+    LimbNumber _num;
+    LimbNumber _power;
+    int _powerBit = -1;
+};
+
 // Rather than trying to convert base2 and base10 bigints, just calculate both of them with this class.
 struct SimpleNumber
 {
@@ -262,23 +633,28 @@ struct SimpleNumber
     static const SimpleNumber& Two();
 
     SimpleNumber(uint64_t num)
+        : _base10(SimpleNumberBase<10>::FromInteger(num))
+        , _base2(SimpleNumberBase<2>::FromInteger(num))
     {
-        char buf[100];
-        {
-            auto res = std::to_chars(buf, buf+99, num, 10);
-            _base10.Parse(std::string_view(buf, res.ptr-buf));
-        }
-        {
-            auto res = std::to_chars(buf, buf+99, num, 2);
-            _base2.Parse(std::string_view(buf, res.ptr-buf));
-        }
     }
 
     static SimpleNumber pow2(int p)
     {
+        return FromScaledInteger(1, p);
+    }
+
+    // num * 2**exp
+    template <typename UInt>
+    static SimpleNumber FromScaledInteger(UInt num, int exp)
+    {
+        ScaledNumberJob job;
+        job.Start(num, exp);
+        StepBudget unlimited(0, 0);
+        job.Step(unlimited);
+
         SimpleNumber res;
-        res._base2 = SimpleNumberBase<2>::pow2(p);
-        res._base10 = SimpleNumberBase<10>::pow2(p);
+        res._base2 = std::move(job._base2);
+        res._base10 = std::move(job._base10);
         return res;
     }
 
@@ -290,6 +666,15 @@ struct SimpleNumber
         return res;
     }
 
+    // Requires *this >= ot, sign is not taken into account
+    SimpleNumber operator-(const SimpleNumber &ot) const
+    {
+        SimpleNumber res;
+        res._base2 = _base2 - ot._base2;
+        res._base10 = _base10 - ot._base10;
+        return res;
+    }
+
     SimpleNumber operator*(const SimpleNumber &ot) const
     {
         SimpleNumber res;
@@ -310,7 +695,7 @@ struct SimpleNumber
 
     void Dump()
     {
-        std::cerr << "Dual number=============\n";
+        fprintf(stderr, "Dual number=============\n");
         _base2.Dump();
         _base10.Dump();
     }
@@ -320,15 +705,76 @@ struct SimpleNumber
     SimpleNumberBase<2> _base2;
 };
 
-SimpleNumber gOne(1ull);
-SimpleNumber gTwo(2ull);
+template <typename UInt>
+void ScaledNumberJob::Start(UInt num, int exp)
+{
+    _base2 = SimpleNumberBase<2>::FromInteger(num);
+    _base2.MulPow2Slice(exp);
+    _remainingExp = exp;
+    _powerBit = -1;
+    if (std::abs(exp) < LimbPowerMinExp)
+    {
+        _base10 = SimpleNumberBase<10>::FromInteger(num);
+        return;
+    }
+
+    _base10 = SimpleNumberBase<10>();
+    _num = LimbNumber::FromInteger(num);
+    _power = LimbNumber::FromInteger(1u);
+    _powerBit = 31 - __builtin_clz(std::abs(exp));
+}
+
+inline bool ScaledNumberJob::Step(StepBudget &budget)
+{
+    if (_powerBit >= 0)
+    {
+        int absExp = std::abs(_remainingExp);
+        while (_powerBit >= 0)
+        {
+            {
+                STATS_SCOPE(STATS_POW2);
+                _power = _power * _power;
+                if ((absExp >> _powerBit) & 1)
+                {
+                    _power.MulSmall(_remainingExp > 0 ? 2 : 5);
+                }
+                STATS_DIGITS(_power._limbs.size() * 9);
+            }
+            --_powerBit;
+            if (_powerBit >= 0 && budget.Spend(_power._limbs.size() * 9))
+            {
+                return false;
+            }
+        }
+
+        (_power * _num).ToDigits(_base10._store._digits);
+        _base10._store._minExpo = std::min(_remainingExp, 0);
+        _power = LimbNumber();
+        _remainingExp = 0;
+        return true;
+    }
+
+    while (_remainingExp != 0)
+    {
+        _remainingExp -= _base10.MulPow2Slice(_remainingExp);
+        if (_remainingExp != 0 && budget.Spend(_base10._store._digits.size()))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Built on first use rather than at static init time, so loading the module does no bigint work
 const SimpleNumber& SimpleNumber::One()
 {
-    return gOne;
+    static const SimpleNumber one(1ull);
+    return one;
 }
 const SimpleNumber& SimpleNumber::Two()
 {
-    return gTwo;
+    static const SimpleNumber two(2ull);
+    return two;
 }
 
 
@@ -352,6 +798,19 @@ int main()
     std::cerr << "test mul = " << (mulres.render() == (a * b).render()) << "\n";
     std::cerr << "test pow = " << (p.render() == (SimpleNumberBase<10>::pow2(151)).render()) << "\n";
     std::cerr << "test pow = " << ("0.125" == (SimpleNumberBase<10>::pow2(-3)).render()) << "\n";
+    std::cerr << "test sub = " << (a.render() == (addres - b).render()) << "\n";
+    std::cerr << "test sub = " << ("0.875" == (SimpleNumberBase<10>("1") - SimpleNumberBase<10>::pow2(-3)).render()) << "\n";
+    std::cerr << "test cmp = " << (a.Compare(b) < 0 && b.Compare(a) > 0 && a.Compare(addres - b) == 0) << "\n";
+    {
+        bool inexact;
+        SimpleNumberBase<10> q = mulres.Divide(b, 0, inexact);
+        std::cerr << "test div = " << (q.render() == a.render() && !inexact) << "\n";
+        q = SimpleNumberBase<10>("1").Divide(SimpleNumberBase<10>("3"), -5, inexact);
+        std::cerr << "test div = " << (q.render() == "0.33333" && inexact) << "\n";
+        SimpleNumberBase<2> q2 = SimpleNumberBase<2>::FromInteger(7).Divide(SimpleNumberBase<2>::FromInteger(2), -3, inexact);
+        q2._store.removeTrailingZeroes();
+        std::cerr << "test div = " << (q2.render() == "11.1" && !inexact) << "\n";
+    }
 
 
     SimpleNumberBase<10> s;
@@ -0,0 +1,683 @@
+// Copyright 2023 Mustafa Serdar Sanli
+//
+// This file is part of FloatInfo.
+//
+// FloatInfo is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// FloatInfo is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with FloatInfo.  If not, see <https://www.gnu.org/licenses/>.
+
+// Correctly rounded add, sub, mul, div, sqrt and fma on the encodings of every representation.
+//
+// Operands are unpacked to sig * 2**exp with a 128-bit sig, computed exactly, or with the bits
+// shifted out ORed into the lowest bit ("jamming") when there are more than the 128-bit sig can
+// hold, and rounded once to the target format. Jamming only touches bits far below the rounding
+// position of the formats, which have at most 64 significant bits, so the results are the
+// correctly rounded ones.
+//
+// Included from floatinfo.cpp after the representations.
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <algorithm>
+
+using uint128 = unsigned __int128;
+
+// Rounding directions of IEEE 754. Posits always round to nearest even.
+enum RoundingMode
+{
+    ROUND_NEAREST_EVEN,
+    ROUND_NEAREST_AWAY,
+    ROUND_TOWARD_ZERO,
+    ROUND_UP,   // toward +infinity
+    ROUND_DOWN, // toward -infinity
+};
+
+struct Unpacked
+{
+    enum Kind { Zero, Finite, Infinite, NaN };
+
+    Kind kind = Zero;
+    bool sign = false;
+    int exp = 0;      // Finite values are (-1)**sign * sig * 2**exp
+    uint128 sig = 0;  // Not zero for finite values
+
+    static Unpacked Make(Kind kind, bool sign = false)
+    {
+        Unpacked res;
+        res.kind = kind;
+        res.sign = sign;
+        return res;
+    }
+};
+
+inline int Msb(uint128 x)
+{
+    uint64_t hi = x >> 64;
+    return hi ? 127 - __builtin_clzll(hi) : 63 - __builtin_clzll((uint64_t)x);
+}
+
+// Shifts the sig so its top bit is at msb, jamming the bits shifted out
+inline void NormalizeTo(Unpacked &u, int msb)
+{
+    int shift = Msb(u.sig) - msb;
+    if (shift <= 0)
+    {
+        u.sig <<= -shift;
+    }
+    else
+    {
+        bool lost = (u.sig & ((uint128(1) << shift) - 1)) != 0;
+        u.sig = (u.sig >> shift) | lost;
+    }
+    u.exp += shift;
+}
+
+// Whether a value whose dropped bits are `guard` (the half) and `sticky` (anything below) gets rounded
+// away from zero
+inline bool RoundsAway(RoundingMode mode, bool sign, bool lsb, bool guard, bool sticky)
+{
+    switch (mode)
+    {
+        case ROUND_NEAREST_EVEN: return guard && (sticky || lsb);
+        case ROUND_NEAREST_AWAY: return guard;
+        case ROUND_TOWARD_ZERO: return false;
+        case ROUND_UP: return !sign && (guard || sticky);
+        case ROUND_DOWN: return sign && (guard || sticky);
+    }
+    return false;
+}
+
+// Drops the lowest `shift` bits of sig, returning the rest and the guard and sticky bits
+inline uint128 ShiftOut(uint128 sig, int shift, bool &guard, bool &sticky)
+{
+    if (shift <= 0)
+    {
+        guard = sticky = false;
+        return sig << -shift;
+    }
+    if (shift > 128)
+    {
+        guard = false;
+        sticky = (sig != 0);
+        return 0;
+    }
+    guard = (sig >> (shift - 1)) & 1;
+    sticky = (shift > 1) && (sig & ((uint128(1) << (shift - 1)) - 1)) != 0;
+    return shift == 128 ? 0 : sig >> shift;
+}
+
+inline Unpacked UnpackedAdd(Unpacked a, Unpacked b, RoundingMode mode)
+{
+    if (a.kind == Unpacked::NaN || b.kind == Unpacked::NaN)
+    {
+        return Unpacked::Make(Unpacked::NaN);
+    }
+    if (a.kind == Unpacked::Infinite || b.kind == Unpacked::Infinite)
+    {
+        if (a.kind == Unpacked::Infinite && b.kind == Unpacked::Infinite && a.sign != b.sign)
+        {
+            return Unpacked::Make(Unpacked::NaN);
+        }
+        return a.kind == Unpacked::Infinite ? a : b;
+    }
+    if (a.kind == Unpacked::Zero && b.kind == Unpacked::Zero)
+    {
+        bool sign = (a.sign == b.sign ? a.sign : mode == ROUND_DOWN);
+        return Unpacked::Make(Unpacked::Zero, sign);
+    }
+    if (a.kind == Unpacked::Zero) return b;
+    if (b.kind == Unpacked::Zero) return a;
+
+    // Two bits of headroom for the carry
+    NormalizeTo(a, 125);
+    NormalizeTo(b, 125);
+    if (a.exp < b.exp)
+    {
+        std::swap(a, b);
+    }
+    int shift = a.exp - b.exp;
+    if (shift > 0)
+    {
+        bool lost = shift >= 128 || (b.sig & ((uint128(1) << shift) - 1)) != 0;
+        b.sig = (shift >= 128 ? 0 : b.sig >> shift) | lost;
+        b.exp = a.exp;
+    }
+
+    if (a.sign == b.sign)
+    {
+        a.sig += b.sig;
+        return a;
+    }
+    if (a.sig == b.sig)
+    {
+        return Unpacked::Make(Unpacked::Zero, mode == ROUND_DOWN);
+    }
+    if (a.sig < b.sig)
+    {
+        std::swap(a, b);
+    }
+    a.sig -= b.sig;
+    return a;
+}
+
+inline Unpacked UnpackedMul(const Unpacked &a, const Unpacked &b)
+{
+    bool sign = a.sign != b.sign;
+    if (a.kind == Unpacked::NaN || b.kind == Unpacked::NaN)
+    {
+        return Unpacked::Make(Unpacked::NaN);
+    }
+    if (a.kind == Unpacked::Infinite || b.kind == Unpacked::Infinite)
+    {
+        if (a.kind == Unpacked::Zero || b.kind == Unpacked::Zero)
+        {
+            return Unpacked::Make(Unpacked::NaN);
+        }
+        return Unpacked::Make(Unpacked::Infinite, sign);
+    }
+    if (a.kind == Unpacked::Zero || b.kind == Unpacked::Zero)
+    {
+        return Unpacked::Make(Unpacked::Zero, sign);
+    }
+
+    // Unpacked encodings have at most 61 bit sigs, so the product is exact. It also stays below
+    // bit 126, so an fma adds it without jamming any of its bits.
+    Unpacked x = a;
+    Unpacked y = b;
+    NormalizeTo(x, 62);
+    NormalizeTo(y, 62);
+    Unpacked res = Unpacked::Make(Unpacked::Finite, sign);
+    res.sig = x.sig * y.sig;
+    res.exp = x.exp + y.exp;
+    return res;
+}
+
+inline Unpacked UnpackedDiv(const Unpacked &a, const Unpacked &b)
+{
+    bool sign = a.sign != b.sign;
+    if (a.kind == Unpacked::NaN || b.kind == Unpacked::NaN)
+    {
+        return Unpacked::Make(Unpacked::NaN);
+    }
+    if (a.kind == Unpacked::Infinite)
+    {
+        return Unpacked::Make(b.kind == Unpacked::Infinite ? Unpacked::NaN : Unpacked::Infinite, sign);
+    }
+    if (b.kind == Unpacked::Infinite)
+    {
+        return Unpacked::Make(Unpacked::Zero, sign);
+    }
+    if (b.kind == Unpacked::Zero)
+    {
+        return Unpacked::Make(a.kind == Unpacked::Zero ? Unpacked::NaN : Unpacked::Infinite, sign);
+    }
+    if (a.kind == Unpacked::Zero)
+    {
+        return Unpacked::Make(Unpacked::Zero, sign);
+    }
+
+    // A 128-bit dividend over a 64-bit divisor leaves at least 64 quotient bits
+    Unpacked x = a;
+    Unpacked y = b;
+    NormalizeTo(x, 127);
+    NormalizeTo(y, 63);
+    Unpacked res = Unpacked::Make(Unpacked::Finite, sign);
+    res.sig = x.sig / y.sig;
+    res.sig |= (x.sig % y.sig) != 0;
+    res.exp = x.exp - y.exp;
+    return res;
+}
+
+inline Unpacked UnpackedSqrt(const Unpacked &a)
+{
+    if (a.kind == Unpacked::NaN || (a.sign && a.kind != Unpacked::Zero))
+    {
+        return Unpacked::Make(Unpacked::NaN);
+    }
+    if (a.kind != Unpacked::Finite)
+    {
+        return a;
+    }
+
+    // Top bit at 126 or 127 with an even exponent, so the root has 64 bits
+    Unpacked x = a;
+    NormalizeTo(x, 126);
+    if (x.exp & 1)
+    {
+        x.sig <<= 1;
+        x.exp -= 1;
+    }
+
+    // Digit by digit square root
+    uint128 rem = x.sig;
+    uint128 root = 0;
+    uint128 bit = uint128(1) << 126;
+    while (bit > rem)
+    {
+        bit >>= 2;
+    }
+    while (bit != 0)
+    {
+        if (rem >= root + bit)
+        {
+            rem -= root + bit;
+            root = (root >> 1) + bit;
+        }
+        else
+        {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+
+    Unpacked res = Unpacked::Make(Unpacked::Finite);
+    res.sig = root | (rem != 0);
+    res.exp = x.exp / 2;
+    return res;
+}
+
+// Packing and unpacking of one representation
+template <typename ReprType>
+struct SoftFloatFormat;
+
+template <typename TraitsType>
+struct SoftFloatFormat<IEEE754FloatRepresentation<TraitsType>>
+{
+    using ReprType = IEEE754FloatRepresentation<TraitsType>;
+
+    static constexpr int Precision = ReprType::NumMantissaBits + 1;
+    static constexpr int MinExponent = 1 - ReprType::ExponentBias;
+
+    static Unpacked Unpack(uint64_t val)
+    {
+        bool sign = ReprType::GetSign(val);
+        if (ReprType::IsNanOrInf(val))
+        {
+            return Unpacked::Make(ReprType::GetMantissa(val) ? Unpacked::NaN : Unpacked::Infinite, sign);
+        }
+        uint64_t num;
+        int exp;
+        ReprType::GetScaledInteger(val, num, exp);
+        if (num == 0)
+        {
+            return Unpacked::Make(Unpacked::Zero, sign);
+        }
+        Unpacked res = Unpacked::Make(Unpacked::Finite, sign);
+        res.sig = num;
+        res.exp = exp;
+        return res;
+    }
+
+    // Unpack(val ^ (1 << bit)) given u = Unpack(val). Flipping a mantissa bit of a finite value
+    // only flips the same bit of the significand.
+    static Unpacked UnpackFlip(uint64_t val, const Unpacked &u, int bit)
+    {
+        if (bit >= ReprType::NumMantissaBits || u.kind != Unpacked::Finite)
+        {
+            return Unpack(val ^ (uint64_t(1) << bit));
+        }
+        Unpacked res = u;
+        res.sig ^= uint128(1) << bit;
+        if (res.sig == 0)
+        {
+            res.kind = Unpacked::Zero;
+        }
+        return res;
+    }
+
+    static uint64_t Round(const Unpacked &u, RoundingMode mode)
+    {
+        switch (u.kind)
+        {
+            case Unpacked::NaN: return ReprType::QuietNan();
+            case Unpacked::Infinite: return u.sign ? ReprType::NegativeInfinity() : ReprType::PositiveInfinity();
+            case Unpacked::Zero: return ReprType::Construct(u.sign, 0, 0);
+            case Unpacked::Finite: break;
+        }
+
+        // Exponent of the last kept bit, fixed at the subnormal one below the normal range
+        int leadExp = Msb(u.sig) + u.exp;
+        int lsbExp = std::max(leadExp, MinExponent) - (Precision - 1);
+        bool guard, sticky;
+        uint128 q = ShiftOut(u.sig, lsbExp - u.exp, guard, sticky);
+        if (RoundsAway(mode, u.sign, q & 1, guard, sticky))
+        {
+            q += 1;
+            if (q >> Precision)
+            {
+                q >>= 1;
+                lsbExp += 1;
+            }
+        }
+
+        uint64_t implicitBit = uint64_t(1) << (Precision - 1);
+        if (q < implicitBit)
+        {
+            // Subnormal or zero, the exponent field is 0 for both
+            return ReprType::Construct(u.sign, 0, (uint64_t)q);
+        }
+
+        int64_t biased = lsbExp + (Precision - 1) + ReprType::ExponentBias;
+        if (biased > ReprType::MaxExponent + ReprType::ExponentBias
+            || ReprType::Construct(0, biased, (uint64_t)q - implicitBit) > ReprType::MaxFinite())
+        {
+            bool toInfinity = mode == ROUND_NEAREST_EVEN || mode == ROUND_NEAREST_AWAY
+                || (mode == ROUND_UP && !u.sign) || (mode == ROUND_DOWN && u.sign);
+            uint64_t res = toInfinity ? ReprType::PositiveInfinity() : ReprType::MaxFinite();
+            return res | (uint64_t)u.sign << ReprType::SignShift;
+        }
+        return ReprType::Construct(u.sign, biased, (uint64_t)q - implicitBit);
+    }
+};
+
+template <typename TraitsType>
+struct SoftFloatFormat<PositRepresentation<TraitsType>>
+{
+    using ReprType = PositRepresentation<TraitsType>;
+
+    static constexpr int NumBits = ReprType::NumBits;
+    static constexpr int ES = ReprType::ExponentSize;
+    static constexpr int MaxScale = (NumBits - 2) << ES;
+
+    // Same value as GetScaledInteger, decoded with clz instead of walking the regime bit by bit
+    static Unpacked Unpack(uint64_t val)
+    {
+        if (val == ReprType::NaR())
+        {
+            return Unpacked::Make(Unpacked::NaN);
+        }
+        if (val == ReprType::Zero())
+        {
+            return Unpacked::Make(Unpacked::Zero);
+        }
+
+        bool sign = ReprType::GetSignBit(val);
+        uint64_t magnitude = sign ? ReprType::Negate(val) : val;
+
+        // Regime starts at the top bit, the rest of the bits are zero so the regime run ends in them
+        uint64_t bits = magnitude << (64 - NumBits + 1);
+        bool regimeFirstBit = bits >> 63;
+        int run = regimeFirstBit ? __builtin_clzll(~bits) : __builtin_clzll(bits);
+        int regime = regimeFirstBit ? run - 1 : -run;
+
+        // Exponent and fraction after the regime and its terminating bit
+        uint128 rest = uint128(bits) << (run + 1);
+        int exponent = (uint64_t)(rest >> (64 - ES)) & ((1 << ES) - 1);
+        uint64_t fraction = (uint64_t)rest << ES;
+
+        Unpacked res = Unpacked::Make(Unpacked::Finite, sign);
+        res.sig = uint128(1) << 64 | fraction;
+        res.exp = regime * (1 << ES) + exponent - 64;
+        return res;
+    }
+
+    // Any bit can move the regime, so flips are unpacked from scratch
+    static Unpacked UnpackFlip(uint64_t val, const Unpacked &, int bit)
+    {
+        return Unpack(val ^ (uint64_t(1) << bit));
+    }
+
+    // Rounds to nearest even on the encoding, as the posit standard does, and saturates at maxpos
+    // and minpos rather than rounding to NaR or zero. The mode is ignored.
+    static uint64_t Round(const Unpacked &u, RoundingMode)
+    {
+        switch (u.kind)
+        {
+            case Unpacked::NaN:
+            case Unpacked::Infinite: return ReprType::NaR();
+            case Unpacked::Zero: return ReprType::Zero();
+            case Unpacked::Finite: break;
+        }
+
+        int msb = Msb(u.sig);
+        int scale = std::clamp(msb + u.exp, -MaxScale, MaxScale);
+        int regime = (scale >= 0 ? scale >> ES : -((-scale + (1 << ES) - 1) >> ES));
+        int exponent = scale - regime * (1 << ES);
+
+        // Regime, exponent and fraction bits after the sign, left aligned
+        uint128 body = 0;
+        int free = 128;
+        bool sticky = false;
+        auto append = [&](uint128 bits, int count)
+        {
+            if (count <= free)
+            {
+                body |= (count == 0 ? 0 : bits << (free - count));
+                free -= count;
+                return;
+            }
+            int over = count - free;
+            sticky |= (bits & ((uint128(1) << over) - 1)) != 0;
+            body |= (free == 0 ? 0 : bits >> over);
+            free = 0;
+        };
+        if (regime >= 0)
+        {
+            append((uint128(1) << (regime + 1)) - 1, regime + 1);
+            append(0, 1);
+        }
+        else
+        {
+            append(0, -regime);
+            append(1, 1);
+        }
+        append(exponent, ES);
+        if (msb + u.exp == scale)
+        {
+            append(u.sig & ((uint128(1) << msb) - 1), msb);
+        }
+        else
+        {
+            // Past maxpos or below minpos
+            sticky = true;
+        }
+
+        constexpr int Kept = NumBits - 1;
+        uint64_t res = body >> (128 - Kept);
+        bool guard = (body >> (127 - Kept)) & 1;
+        sticky |= (body & ((uint128(1) << (127 - Kept)) - 1)) != 0;
+        if (guard && (sticky || (res & 1)))
+        {
+            res += 1;
+        }
+        res = std::clamp(res, ReprType::MinPositive(), ReprType::MaxFinite());
+        return u.sign ? ReprType::Negate(res) : res;
+    }
+};
+
+// Decimal coefficient * 10**scale as sig * 2**exp, with a 127-bit sig whose lowest bit is jammed
+// when the value needs more bits. That is more than any binary format rounds to, so rounding the
+// result is rounding the decimal value.
+inline Unpacked UnpackDecimal(bool sign, uint128 coefficient, int scale)
+{
+    constexpr int SigBits = 127;
+    if (coefficient == 0)
+    {
+        return Unpacked::Make(Unpacked::Zero, sign);
+    }
+
+    Unpacked res = Unpacked::Make(Unpacked::Finite, sign);
+    if (scale >= 0)
+    {
+        DigitBigInt num = DigitBigInt::FromInteger(coefficient);
+        num.MulPow5(scale);
+        res.sig = num.TopBits(SigBits, res.exp);
+        res.exp += scale;
+        return res;
+    }
+
+    // coefficient / 5**-scale * 2**scale, as r / s * 2**-shift with r and s of the same length so the
+    // quotient is in (0.5, 2), and its bits taken one at a time like long division
+    DigitBigInt r = DigitBigInt::FromInteger(coefficient);
+    DigitBigInt s = DigitBigInt::FromInteger(1);
+    s.MulPow5(-scale);
+    int shift = s.BitLength() - r.BitLength();
+    r.ShiftLeft(std::max(shift, 0));
+    s.ShiftLeft(std::max(-shift, 0));
+    uint128 q = 0;
+    for (int i = 0; i < SigBits; ++i)
+    {
+        r.ShiftLeft(i > 0);
+        q <<= 1;
+        if (r.Compare(s) >= 0)
+        {
+            r.Sub(s);
+            q |= 1;
+        }
+    }
+    res.sig = q | !r.IsZero();
+    res.exp = scale - shift - (SigBits - 1);
+    return res;
+}
+
+template <typename ReprType>
+struct SoftFloat
+{
+    using Format = SoftFloatFormat<ReprType>;
+
+    static uint64_t Add(uint64_t a, uint64_t b, RoundingMode mode = ROUND_NEAREST_EVEN)
+    {
+        return Format::Round(UnpackedAdd(Format::Unpack(a), Format::Unpack(b), mode), mode);
+    }
+
+    static uint64_t Sub(uint64_t a, uint64_t b, RoundingMode mode = ROUND_NEAREST_EVEN)
+    {
+        Unpacked nb = Format::Unpack(b);
+        nb.sign = !nb.sign;
+        return Format::Round(UnpackedAdd(Format::Unpack(a), nb, mode), mode);
+    }
+
+    static uint64_t Mul(uint64_t a, uint64_t b, RoundingMode mode = ROUND_NEAREST_EVEN)
+    {
+        return Format::Round(UnpackedMul(Format::Unpack(a), Format::Unpack(b)), mode);
+    }
+
+    static uint64_t Div(uint64_t a, uint64_t b, RoundingMode mode = ROUND_NEAREST_EVEN)
+    {
+        return Format::Round(UnpackedDiv(Format::Unpack(a), Format::Unpack(b)), mode);
+    }
+
+    static uint64_t Sqrt(uint64_t a, RoundingMode mode = ROUND_NEAREST_EVEN)
+    {
+        return Format::Round(UnpackedSqrt(Format::Unpack(a)), mode);
+    }
+
+    // a * b + c with a single rounding
+    static uint64_t Fma(uint64_t a, uint64_t b, uint64_t c, RoundingMode mode = ROUND_NEAREST_EVEN)
+    {
+        Unpacked product = UnpackedMul(Format::Unpack(a), Format::Unpack(b));
+        return Format::Round(UnpackedAdd(product, Format::Unpack(c), mode), mode);
+    }
+
+    // Array versions, out may alias the inputs
+    static void Add(const uint64_t *a, const uint64_t *b, uint64_t *out, size_t n, RoundingMode mode = ROUND_NEAREST_EVEN)
+    {
+        for (size_t i = 0; i < n; ++i) out[i] = Add(a[i], b[i], mode);
+    }
+
+    static void Sub(const uint64_t *a, const uint64_t *b, uint64_t *out, size_t n, RoundingMode mode = ROUND_NEAREST_EVEN)
+    {
+        for (size_t i = 0; i < n; ++i) out[i] = Sub(a[i], b[i], mode);
+    }
+
+    static void Mul(const uint64_t *a, const uint64_t *b, uint64_t *out, size_t n, RoundingMode mode = ROUND_NEAREST_EVEN)
+    {
+        for (size_t i = 0; i < n; ++i) out[i] = Mul(a[i], b[i], mode);
+    }
+
+    static void Div(const uint64_t *a, const uint64_t *b, uint64_t *out, size_t n, RoundingMode mode = ROUND_NEAREST_EVEN)
+    {
+        for (size_t i = 0; i < n; ++i) out[i] = Div(a[i], b[i], mode);
+    }
+
+    static void Sqrt(const uint64_t *a, uint64_t *out, size_t n, RoundingMode mode = ROUND_NEAREST_EVEN)
+    {
+        for (size_t i = 0; i < n; ++i) out[i] = Sqrt(a[i], mode);
+    }
+
+    static void Fma(const uint64_t *a, const uint64_t *b, const uint64_t *c, uint64_t *out, size_t n, RoundingMode mode = ROUND_NEAREST_EVEN)
+    {
+        for (size_t i = 0; i < n; ++i) out[i] = Fma(a[i], b[i], c[i], mode);
+    }
+};
+
+
+#ifdef RUN_TEST_FLOATINFO
+
+#include <float.h>
+#include <math.h>
+#include <random>
+#include <string.h>
+
+// Ties to even, subnormal results and overflow in binary32, against the hardware which rounds to
+// nearest even, then on random operands of all the operations
+inline bool TestSoftFloat()
+{
+    using F32 = SoftFloat<IEEE754FloatRepresentation<IEEE754Float32Traits>>;
+    auto bits = [](float f) { uint32_t u; memcpy(&u, &f, 4); return (uint64_t)u; };
+
+    int bad = 0;
+    const float denormMin = FLT_TRUE_MIN;
+    const float cases[][2] = {
+        { 1.0f, 0x1p-24f },                  // Tie, stays on the even 1
+        { 1.0f + 0x1p-23f, 0x1p-24f },       // Tie, up to the even neighbour
+        { -1.0f - 0x1p-23f, -0x1p-24f },
+        { FLT_MIN, -denormMin },             // Into the subnormals
+        { denormMin, denormMin },
+        { FLT_MAX, 0x1p103f },               // Tie at the top, the even neighbour is inf
+        { FLT_MAX, 0x1p102f },
+        { -FLT_MAX, -FLT_MAX },
+    };
+    for (const auto &c : cases)
+    {
+        bad += F32::Add(bits(c[0]), bits(c[1])) != bits(c[0] + c[1]);
+    }
+
+    // Halves of odd multiples of denormMin are ties in the subnormals
+    for (int k = 1; k < 8; ++k)
+    {
+        bad += F32::Mul(bits(k * denormMin), bits(0.5f)) != bits(k * denormMin * 0.5f);
+    }
+    bad += F32::Mul(bits(FLT_MIN), bits(1.0f / 3)) != bits(FLT_MIN * (1.0f / 3));
+    bad += F32::Mul(bits(FLT_MAX), bits(2.0f)) != bits(INFINITY);
+    bad += F32::Mul(bits(-FLT_MAX), bits(2.0f)) != bits(-INFINITY);
+    bad += F32::Mul(bits(FLT_MAX), bits(2.0f), ROUND_TOWARD_ZERO) != bits(FLT_MAX);
+    bad += F32::Mul(bits(-FLT_MAX), bits(2.0f), ROUND_UP) != bits(-FLT_MAX);
+    bad += F32::Div(bits(1.0f), bits(0.0f)) != bits(INFINITY);
+
+    std::mt19937 rng(42);
+    for (int i = 0; i < 100000; ++i)
+    {
+        uint32_t ua = rng();
+        uint32_t ub = rng();
+        if (i % 2)
+        {
+            // Close exponents, so that the adds round and cancel
+            ub = (ub & 0x807FFFFF) | (ua & 0x7F800000);
+        }
+        float a, b;
+        memcpy(&a, &ua, 4);
+        memcpy(&b, &ub, 4);
+        if (isnan(a) || isnan(b))
+        {
+            continue;
+        }
+        bad += F32::Add(ua, ub) != bits(a + b);
+        bad += F32::Mul(ua, ub) != bits(a * b);
+        bad += !isnan(a / b) && F32::Div(ua, ub) != bits(a / b);
+        bad += !isnan(sqrtf(a)) && F32::Sqrt(ua) != bits(sqrtf(a));
+    }
+    return bad == 0;
+}
+
+#endif
@@ -0,0 +1,196 @@
+// Copyright 2023 Mustafa Serdar Sanli
+//
+// This file is part of FloatInfo.
+//
+// FloatInfo is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// FloatInfo is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with FloatInfo.  If not, see <https://www.gnu.org/licenses/>.
+
+// Call counts, time and bigint sizes per subsystem, compiled in with -DFLOATINFO_STATS.
+// Without it the macros below expand to nothing, so regular builds pay nothing.
+//
+// Times are inclusive, e.g. the time of VALUE also contains the POW2 slices it ran.
+// Allocations are those of bigint digit storage made while the subsystem was running.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+#ifdef FLOATINFO_STATS
+#include <atomic>
+#include <chrono>
+#endif
+
+enum StatsId
+{
+    STATS_VALUE,
+    STATS_POW2,
+    STATS_MUL,
+    STATS_RENDER,
+    STATS_MATH,
+    STATS_CACHE_LOOKUP,
+    STATS_CACHE_HIT,
+    STATS_MAX,
+};
+
+inline const char* StatsName(int id)
+{
+    static const char* const names[STATS_MAX] = {
+        "value", "pow2", "mul", "render", "math", "cache_lookup", "cache_hit",
+    };
+    return names[id];
+}
+
+#ifdef FLOATINFO_STATS
+
+struct StatsCounter
+{
+    std::atomic<uint64_t> _calls{0};
+    std::atomic<uint64_t> _nanos{0};
+    std::atomic<uint64_t> _digits{0};
+    std::atomic<uint64_t> _maxDigits{0};
+    std::atomic<uint64_t> _allocs{0};
+};
+
+struct Stats
+{
+    static StatsCounter* Counters()
+    {
+        static StatsCounter counters[STATS_MAX];
+        return counters;
+    }
+
+    // Digit storage allocations made by this thread so far
+    static uint64_t& ThreadAllocs()
+    {
+        static thread_local uint64_t allocs = 0;
+        return allocs;
+    }
+
+    static void Count(StatsId id)
+    {
+        Counters()[id]._calls.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    static void Reset()
+    {
+        for (int id = 0; id < STATS_MAX; ++id)
+        {
+            StatsCounter &c = Counters()[id];
+            c._calls = 0;
+            c._nanos = 0;
+            c._digits = 0;
+            c._maxDigits = 0;
+            c._allocs = 0;
+        }
+    }
+
+    static std::string ToJson()
+    {
+        std::string res = "{\"enabled\": true";
+        for (int id = 0; id < STATS_MAX; ++id)
+        {
+            const StatsCounter &c = Counters()[id];
+            char buf[256];
+            snprintf(buf, sizeof(buf), ", \"%s\": {\"calls\": %llu, \"nanos\": %llu, \"digits\": %llu, \"max_digits\": %llu, \"allocs\": %llu}",
+                    StatsName(id),
+                    (unsigned long long)c._calls.load(), (unsigned long long)c._nanos.load(),
+                    (unsigned long long)c._digits.load(), (unsigned long long)c._maxDigits.load(),
+                    (unsigned long long)c._allocs.load());
+            res += buf;
+        }
+        res += "}";
+        return res;
+    }
+};
+
+// Counts one call of a subsystem, with its time and allocations, when it goes out of scope
+struct StatsScope
+{
+    explicit StatsScope(StatsId id)
+        : _id(id)
+        , _start(std::chrono::steady_clock::now())
+        , _startAllocs(Stats::ThreadAllocs())
+    {
+    }
+
+    ~StatsScope()
+    {
+        StatsCounter &c = Stats::Counters()[_id];
+        uint64_t nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - _start).count();
+        c._calls.fetch_add(1, std::memory_order_relaxed);
+        c._nanos.fetch_add(nanos, std::memory_order_relaxed);
+        c._allocs.fetch_add(Stats::ThreadAllocs() - _startAllocs, std::memory_order_relaxed);
+    }
+
+    // Size of the bigint the subsystem produced
+    void AddDigits(uint64_t numDigits)
+    {
+        StatsCounter &c = Stats::Counters()[_id];
+        c._digits.fetch_add(numDigits, std::memory_order_relaxed);
+        uint64_t prevMax = c._maxDigits.load(std::memory_order_relaxed);
+        while (prevMax < numDigits && !c._maxDigits.compare_exchange_weak(prevMax, numDigits, std::memory_order_relaxed))
+        {
+        }
+    }
+
+    StatsId _id;
+    std::chrono::steady_clock::time_point _start;
+    uint64_t _startAllocs;
+};
+
+template <typename T>
+struct StatsAllocator
+{
+    using value_type = T;
+
+    StatsAllocator() = default;
+    template <typename U> StatsAllocator(const StatsAllocator<U>&) {}
+
+    T* allocate(size_t n)
+    {
+        ++Stats::ThreadAllocs();
+        return std::allocator<T>().allocate(n);
+    }
+
+    void deallocate(T *p, size_t n)
+    {
+        std::allocator<T>().deallocate(p, n);
+    }
+
+    template <typename U> bool operator==(const StatsAllocator<U>&) const { return true; }
+    template <typename U> bool operator!=(const StatsAllocator<U>&) const { return false; }
+};
+
+using StatsDigitVector = std::vector<uint32_t, StatsAllocator<uint32_t>>;
+
+#define STATS_SCOPE(id) StatsScope statsScope_(id)
+#define STATS_DIGITS(n) statsScope_.AddDigits(n)
+#define STATS_COUNT(id) Stats::Count(id)
+
+inline std::string StatsJson() { return Stats::ToJson(); }
+inline void StatsReset() { Stats::Reset(); }
+
+#else
+
+using StatsDigitVector = std::vector<uint32_t>;
+
+#define STATS_SCOPE(id) do {} while (0)
+#define STATS_DIGITS(n) do {} while (0)
+#define STATS_COUNT(id) do {} while (0)
+
+inline std::string StatsJson() { return "{\"enabled\": false}"; }
+inline void StatsReset() {}
+
+#endif
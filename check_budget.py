@@ -0,0 +1,98 @@
+#!/usr/bin/env python3
+
+# Copyright 2023 Mustafa Serdar Sanli
+#
+# This file is part of FloatInfo.
+#
+# FloatInfo is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# FloatInfo is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with FloatInfo.  If not, see <https://www.gnu.org/licenses/>.
+
+# Fails the build when the binaries or their startup time grow past the budgets below. The native
+# binary is checked by the default build, the wasm only when asked for with `ninja out/wasm-budget.stamp`.
+#
+# The budgets are set with headroom over measured sizes and times, so that features fit under them.
+# A commit that raises one says why in its message.
+#
+# usage: check_budget.py out/floatinfo [out/site/floatinfo.wasm out/site/floatinfo.js]
+
+import os
+import shutil
+import subprocess
+import sys
+import time
+
+# Not measured yet, so not part of the default build until it is set from a measurement
+WASM_SIZE_BUDGET = 224 * 1024
+# 904 KiB measured with g++ 12 -O2 on x86-64
+NATIVE_SIZE_BUDGET = 1024 * 1024
+
+# Median time from start until the module is usable, in milliseconds
+WASM_STARTUP_BUDGET_MS = 150
+NATIVE_STARTUP_BUDGET_MS = 20
+
+NUM_RUNS = 15
+
+WASM_STARTUP_SCRIPT = '''
+const t0 = process.hrtime.bigint();
+require(process.argv[1])().then(function(Module) {
+    Module._get_fe(1);
+    process.stdout.write(String(Number(process.hrtime.bigint() - t0) / 1e6));
+});
+'''
+
+def median(values):
+    values = sorted(values)
+    return values[len(values) // 2]
+
+def native_startup_ms(binary):
+    times = []
+    for _ in range(NUM_RUNS):
+        t0 = time.perf_counter()
+        subprocess.run([binary, 'binary64', 'hex:0000000000000000', 'TYPENAME'], check=True, stdout=subprocess.DEVNULL)
+        times.append((time.perf_counter() - t0) * 1000)
+    return median(times)
+
+def wasm_startup_ms(js):
+    # Measured inside node, so interpreter startup is not counted
+    times = []
+    for _ in range(NUM_RUNS):
+        out = subprocess.run(['node', '-e', WASM_STARTUP_SCRIPT, os.path.abspath(js)], check=True, capture_output=True, text=True)
+        times.append(float(out.stdout))
+    return median(times)
+
+def check(name, value, budget, unit):
+    ok = value <= budget
+    print(f'{name}: {value:.1f} {unit} (budget {budget} {unit}){"" if ok else " OVER BUDGET"}')
+    return ok
+
+def main():
+    if len(sys.argv) not in (2, 4):
+        print('usage: check_budget.py NATIVE [WASM JS]', file=sys.stderr)
+        return 1
+    native = sys.argv[1]
+
+    ok = True
+    ok &= check('native size', os.path.getsize(native) / 1024, NATIVE_SIZE_BUDGET // 1024, 'KiB')
+    ok &= check('native startup', native_startup_ms(native), NATIVE_STARTUP_BUDGET_MS, 'ms')
+    if len(sys.argv) == 4:
+        wasm, js = sys.argv[2:]
+        ok &= check('wasm size', os.path.getsize(wasm) / 1024, WASM_SIZE_BUDGET // 1024, 'KiB')
+        if shutil.which('node'):
+            ok &= check('wasm startup', wasm_startup_ms(js), WASM_STARTUP_BUDGET_MS, 'ms')
+        else:
+            print('wasm startup: skipped, node not found')
+
+    return 0 if ok else 1
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,348 @@
+#!/usr/bin/env python3
+
+# Copyright 2023 Mustafa Serdar Sanli
+#
+# This file is part of FloatInfo.
+#
+# FloatInfo is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# FloatInfo is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with FloatInfo.  If not, see <https://www.gnu.org/licenses/>.
+
+
+# Generates the tables of MathTables.cpp: exp, log, sin, cos, sqrt and 1/x of every encoding of the
+# 8 and 16-bit formats, correctly rounded to nearest even.
+#
+# Values are computed with decimal at a precision that grows with the magnitude of the argument,
+# and recomputed at twice the precision whenever a result is too close to a rounding boundary to
+# tell which side it is on. sqrt and 1/x are computed exactly.
+#
+# usage: gen_math_tables.py > out/MathTablesData.cpp
+
+import bisect
+import decimal
+import math
+import sys
+from decimal import Decimal
+from fractions import Fraction
+
+FUNCTIONS = ['exp', 'log', 'sin', 'cos', 'sqrt', 'reciprocal']
+
+IEEE_FORMATS = [
+    # name, exponent bits, mantissa bits, representation type
+    ('minifloat', 4, 3, 'IEEE754FloatRepresentation<IEEE754MinifloatTraits>'),
+    ('binary16', 5, 10, 'IEEE754FloatRepresentation<IEEE754Float16Traits>'),
+    ('bfloat16', 8, 7, 'IEEE754FloatRepresentation<IEEE754BFloat16Traits>'),
+]
+
+POSIT_FORMATS = [
+    # name, bits, representation type
+    ('posit8', 8, 'PositRepresentation<Posit8Traits>'),
+    ('posit16', 16, 'PositRepresentation<Posit16Traits>'),
+]
+
+# Digits on top of the magnitude of the argument
+BASE_PRECISION = 40
+
+# Arguments of exp past this saturate in every format
+EXP_SATURATION = 200
+HUGE = Fraction(10) ** 300
+TINY = Fraction(1, 10 ** 300)
+
+
+class Ambiguous(Exception):
+    pass
+
+
+class IEEEFormat:
+    def __init__(self, name, exponentBits, mantissaBits, reprType):
+        self.name = name
+        self.numBits = 1 + exponentBits + mantissaBits
+        self.e = exponentBits
+        self.m = mantissaBits
+        self.reprType = reprType
+        self.bias = (1 << (exponentBits - 1)) - 1
+        self.signBit = 1 << (exponentBits + mantissaBits)
+        self.expMask = (1 << exponentBits) - 1
+
+    def nan(self):
+        return (self.expMask << self.m) | (1 << (self.m - 1))
+
+    def inf(self, negative):
+        return (self.signBit if negative else 0) | (self.expMask << self.m)
+
+    def zero(self, negative):
+        return self.signBit if negative else 0
+
+    # Returns a Fraction, or 'nan', 'inf', '-inf'. Zeros are returned as (0, sign).
+    def decode(self, v):
+        sign = (v & self.signBit) != 0
+        ex = (v >> self.m) & self.expMask
+        man = v & ((1 << self.m) - 1)
+        if ex == self.expMask:
+            return 'nan' if man else ('-inf' if sign else 'inf')
+        val = Fraction(man if ex == 0 else man | (1 << self.m)) * Fraction(2) ** (max(ex, 1) - self.bias - self.m)
+        return -val if sign else val
+
+    def isNegativeZero(self, v):
+        return v == self.signBit
+
+    # Rounds to nearest even, x is within relErr of the true value
+    def round(self, x, relErr):
+        if x == 0:
+            return 0
+        sign = x < 0
+        a = abs(x)
+        lead = a.numerator.bit_length() - a.denominator.bit_length()
+        if Fraction(2) ** lead > a:
+            lead -= 1
+        lsb = max(lead, 1 - self.bias) - self.m
+        q = a / Fraction(2) ** lsb
+        fl = q.numerator // q.denominator
+        rem = q - fl
+        if abs(rem - Fraction(1, 2)) <= q * relErr:
+            raise Ambiguous()
+        fl += (rem > Fraction(1, 2)) or (rem == Fraction(1, 2) and fl & 1)
+        if fl >> (self.m + 1):
+            fl >>= 1
+            lsb += 1
+        s = self.signBit if sign else 0
+        if fl < (1 << self.m):
+            return s | fl
+        biased = lsb + self.m + self.bias
+        if biased >= self.expMask:
+            return self.inf(sign)
+        return s | (biased << self.m) | (fl - (1 << self.m))
+
+
+class PositFormat:
+    def __init__(self, name, numBits, reprType):
+        self.name = name
+        self.numBits = numBits
+        self.reprType = reprType
+        self.mask = (1 << numBits) - 1
+        self.maxpos = self.mask >> 1
+        # Positive values in order, and the rounding boundaries between them
+        self.values = [posit_decode(i, numBits) for i in range(1, self.maxpos + 1)]
+        self.mids = [posit_decode(2 * i + 1, numBits + 1) for i in range(1, self.maxpos)]
+
+    def nan(self):
+        return 1 << (self.numBits - 1)
+
+    def inf(self, negative):
+        return self.nan()
+
+    def zero(self, negative):
+        return 0
+
+    def decode(self, v):
+        val = posit_decode(v, self.numBits)
+        return 'nan' if val is None else val
+
+    def isNegativeZero(self, v):
+        return False
+
+    # Rounds to nearest even on the encoding, saturating at minpos and maxpos
+    def round(self, x, relErr):
+        if x == 0:
+            return 0
+        negative = x < 0
+        a = abs(x)
+        # values[i] is the encoding i + 1
+        i = bisect.bisect_right(self.values, a) - 1
+        if i < 0:
+            r = 1
+        elif i == len(self.values) - 1 or self.values[i] == a:
+            r = i + 1
+        else:
+            mid = self.mids[i]
+            if abs(a - mid) <= a * relErr:
+                raise Ambiguous()
+            r = i + 1 if a < mid else i + 2
+        return (-r) & self.mask if negative else r
+
+
+def posit_decode(v, n):
+    mask = (1 << n) - 1
+    v &= mask
+    if v == 0:
+        return Fraction(0)
+    if v == 1 << (n - 1):
+        return None
+    negative = v >> (n - 1)
+    if negative:
+        v = (-v) & mask
+    i = n - 2
+    first = (v >> i) & 1
+    run = 0
+    while i >= 0 and ((v >> i) & 1) == first:
+        run += 1
+        i -= 1
+    i -= 1
+    regime = run - 1 if first else -run
+    exponent = 0
+    for _ in range(2):
+        exponent <<= 1
+        if i >= 0:
+            exponent |= (v >> i) & 1
+            i -= 1
+    fraction = Fraction(1)
+    weight = Fraction(1, 2)
+    while i >= 0:
+        if (v >> i) & 1:
+            fraction += weight
+        weight /= 2
+        i -= 1
+    val = fraction * Fraction(2) ** (4 * regime + exponent)
+    return -val if negative else val
+
+
+_piCache = {}
+
+def pi(prec):
+    if prec not in _piCache:
+        with decimal.localcontext() as ctx:
+            ctx.prec = prec + 10
+            # Machin: pi = 16 atan(1/5) - 4 atan(1/239)
+            def atanInv(n):
+                x = Decimal(1) / n
+                x2 = x * x
+                total = term = x
+                k = 1
+                eps = Decimal(10) ** -(prec + 10)
+                while abs(term) > eps:
+                    term *= -x2
+                    total += term / (2 * k + 1)
+                    k += 1
+                return total
+            _piCache[prec] = +(16 * atanInv(5) - 4 * atanInv(239))
+    return _piCache[prec]
+
+
+def sin_cos_series(r, prec, wantSin):
+    eps = Decimal(10) ** -(prec + 5)
+    r2 = r * r
+    term = r if wantSin else Decimal(1)
+    total = term
+    k = 1 if wantSin else 0
+    while abs(term) > eps * max(abs(total), eps):
+        term *= -r2 / ((k + 1) * (k + 2))
+        total += term
+        k += 2
+    return total
+
+
+def evaluate(function, x, prec):
+    """function(x) for a finite nonzero x, as a Fraction and a bound on its relative error"""
+    if function == 'sqrt':
+        # sqrt of a value of the format never lies on a rounding boundary, so a close enough
+        # lower bound is enough
+        bits = 4 * prec
+        return Fraction(math.isqrt(x.numerator * x.denominator << (2 * bits)), x.denominator << bits), Fraction(1, 1 << (bits - 8))
+    if function == 'reciprocal':
+        return 1 / x, 0
+    if function == 'exp' and abs(x) > EXP_SATURATION:
+        return (HUGE if x > 0 else TINY), 0
+
+    digits = len(str(abs(x.numerator) // x.denominator))
+    with decimal.localcontext() as ctx:
+        ctx.prec = prec + digits
+        ctx.Emin = -10 ** 6
+        ctx.Emax = 10 ** 6
+        d = Decimal(x.numerator) / Decimal(x.denominator)
+        if function == 'exp':
+            res = d.exp()
+        elif function == 'log':
+            res = d.ln()
+        else:
+            halfPi = pi(ctx.prec) / 2
+            k = int((d / halfPi).to_integral_value())
+            r = d - k * halfPi
+            quadrant = k % 4
+            if function == 'cos':
+                quadrant = (quadrant + 1) % 4
+            res = sin_cos_series(r, ctx.prec, quadrant % 2 == 0)
+            if quadrant >= 2:
+                res = -res
+        return Fraction(res), Fraction(1, 10 ** (prec - 5))
+
+
+def compute(fmt, function, v):
+    x = fmt.decode(v)
+    if x == 'nan':
+        return fmt.nan()
+
+    if x in ('inf', '-inf'):
+        negative = x == '-inf'
+        if function == 'exp':
+            return fmt.zero(False) if negative else fmt.inf(False)
+        if function == 'log' or function == 'sqrt':
+            return fmt.nan() if negative else fmt.inf(False)
+        if function == 'reciprocal':
+            return fmt.zero(negative)
+        return fmt.nan()
+
+    if x == 0:
+        negative = fmt.isNegativeZero(v)
+        if function in ('exp', 'cos'):
+            return fmt.round(Fraction(1), 0)
+        if function == 'log':
+            return fmt.inf(True)
+        if function == 'reciprocal':
+            return fmt.inf(negative)
+        return fmt.zero(negative)  # sin, sqrt
+
+    if x < 0 and function in ('log', 'sqrt'):
+        return fmt.nan()
+    if function == 'log' and x == 1:
+        return 0
+
+    prec = BASE_PRECISION
+    while True:
+        approx, relErr = evaluate(function, x, prec)
+        try:
+            return fmt.round(approx, relErr)
+        except Ambiguous:
+            if prec > 1000:
+                raise
+            prec *= 2
+
+
+def main():
+    formats = [IEEEFormat(*f) for f in IEEE_FORMATS] + [PositFormat(*f) for f in POSIT_FORMATS]
+
+    out = sys.stdout
+    out.write('// Generated by gen_math_tables.py, do not edit\n\n')
+    for fmt in formats:
+        entryType = 'uint8_t' if fmt.numBits <= 8 else 'uint16_t'
+        digits = 2 if fmt.numBits <= 8 else 4
+        names = []
+        for function in FUNCTIONS:
+            name = f'gMathTable_{fmt.name}_{function}'
+            names.append(name)
+            out.write(f'static const {entryType} {name}[{1 << fmt.numBits}] = {{\n')
+            for start in range(0, 1 << fmt.numBits, 16):
+                row = ', '.join(f'0x{compute(fmt, function, v):0{digits}x}' for v in range(start, start + 16))
+                out.write(f'    {row},\n')
+            out.write('};\n\n')
+
+        out.write('template <>\n')
+        out.write(f'struct MathTableData<{fmt.reprType}>\n{{\n')
+        out.write('    static constexpr bool IsAvailable = true;\n')
+        out.write(f'    using Entry = {entryType};\n')
+        out.write('    static constexpr const Entry *Tables[MATH_FUNCTION_MAX] = {\n')
+        for name in names:
+            out.write(f'        {name},\n')
+        out.write('    };\n};\n\n')
+
+
+if __name__ == '__main__':
+    main()
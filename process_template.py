@@ -36,6 +36,17 @@ def main():
         'TMPL_BITTYPE_SIGN',
         'TMPL_BITTYPE_REGIME',
         'TMPL_BITTYPE_OOB',
+        'TMPL_BITTYPE_COMBINATION',
+    ])
+
+    dump_enum([
+        'TMPL_VALUECLASS_ZERO',
+        'TMPL_VALUECLASS_SUBNORMAL',
+        'TMPL_VALUECLASS_NORMAL',
+        'TMPL_VALUECLASS_INFINITE',
+        'TMPL_VALUECLASS_NAN',
+        'TMPL_VALUECLASS_NAR',
+        'TMPL_VALUECLASS_MAX',
     ])
 
 
@@ -49,6 +60,21 @@ def main():
         'TMPL_TYPE_POSIT16',
         'TMPL_TYPE_POSIT32',
         'TMPL_TYPE_POSIT64',
+        'TMPL_TYPE_E4M3',
+        'TMPL_TYPE_E5M2',
+        'TMPL_TYPE_E2M1',
+        'TMPL_TYPE_BINARY128',
+        'TMPL_TYPE_FLOAT80',
+        'TMPL_TYPE_POSIT8_ES0',
+        'TMPL_TYPE_POSIT16_ES1',
+        'TMPL_TYPE_POSIT12',
+        'TMPL_TYPE_POSIT24',
+        'TMPL_TYPE_DECIMAL32_BID',
+        'TMPL_TYPE_DECIMAL32_DPD',
+        'TMPL_TYPE_DECIMAL64_BID',
+        'TMPL_TYPE_DECIMAL64_DPD',
+        'TMPL_TYPE_DECIMAL128_BID',
+        'TMPL_TYPE_DECIMAL128_DPD',
 
         'TMPL_TYPE_MAX',
     ])
@@ -71,6 +97,8 @@ def main():
         'TMPL_STRCODE_EXACT_BASE10',
         'TMPL_STRCODE_EXACT_BASE2',
         'TMPL_STRCODE_MATH',
+        'TMPL_STRCODE_SCIENTIFIC',
+        'TMPL_STRCODE_HEXFLOAT',
         'TMPL_STRCODE_MAX',
     ])
 
@@ -80,8 +108,13 @@ def main():
         'TMPL_BOOL_IS_IEEE754',
         'TMPL_BOOL_IS_POSIT',
         'TMPL_BOOL_IS_ANY',
+        'TMPL_BOOL_IS_COMPUTING',
     ] + [
-        f'TMPL_INT_BITTYPE_{i}' for i in range(64)
+        f'TMPL_INT_BITTYPE_{i}' for i in range(128)
+    ] + [
+        'TMPL_BOOL_IS_DECIMAL',
+        'TMPL_BOOL_CAN_UNDO',
+        'TMPL_BOOL_CAN_REDO',
     ])
 
     dump_enum([
@@ -107,7 +140,52 @@ def main():
         'TMPL_SET_REPRSTR',
 
     ] + [
-        f'TMPL_SET_BIT_FLIP_{i}' for i in range(64)
+        f'TMPL_SET_BIT_FLIP_{i}' for i in range(128)
+    ] + [
+        'TMPL_SET_UNDO',
+        'TMPL_SET_REDO',
+        'TMPL_SET_PRECISION',
+    ])
+
+    dump_enum([
+        'TMPL_SOFTOP_ADD',
+        'TMPL_SOFTOP_SUB',
+        'TMPL_SOFTOP_MUL',
+        'TMPL_SOFTOP_DIV',
+        'TMPL_SOFTOP_SQRT',
+        'TMPL_SOFTOP_FMA',
+    ])
+
+    dump_enum([
+        'TMPL_ROUND_NEAREST_EVEN',
+        'TMPL_ROUND_NEAREST_AWAY',
+        'TMPL_ROUND_TOWARD_ZERO',
+        'TMPL_ROUND_UP',
+        'TMPL_ROUND_DOWN',
+    ])
+
+    dump_enum([
+        'TMPL_MX_FP8_E4M3',
+        'TMPL_MX_FP8_E5M2',
+        'TMPL_MX_FP4_E2M1',
+        'TMPL_MX_INT8',
+    ])
+
+    dump_enum([
+        'TMPL_MATH_EXP',
+        'TMPL_MATH_LOG',
+        'TMPL_MATH_SIN',
+        'TMPL_MATH_COS',
+        'TMPL_MATH_SQRT',
+        'TMPL_MATH_RECIPROCAL',
+    ])
+
+    dump_enum([
+        'TMPL_CONVERT_EXACT',
+        'TMPL_CONVERT_INEXACT',
+        'TMPL_CONVERT_OVERFLOW',
+        'TMPL_CONVERT_UNDERFLOW',
+        'TMPL_CONVERT_NAN',
     ])
 
     sys.stdout.write(tmpl)
@@ -16,95 +16,400 @@
 // along with FloatInfo.  If not, see <https://www.gnu.org/licenses/>.
 
 #include <algorithm>
+#include <deque>
+#include <list>
+#include <math.h>
+#include <mutex>
 #include <string.h>
 #include <string>
 #include <string_view>
-#include <iostream>
+#include <unordered_map>
 
 #include "SimpleBigInt.cpp"
+#include "Posit.cpp"
+#include "Decimal.cpp"
+#include "RadixSort.cpp"
+#include "Scientific.cpp"
+#include "PackedDigits.cpp"
 
 using namespace std::literals;
 
 
+// What the encodings with an all-ones exponent field are
+enum IEEE754Specials
+{
+    IEEE754_INF_NAN,  // Infinities and NaNs, as in IEEE 754
+    IEEE754_NAN_ONLY, // Only all-ones exponent and mantissa is NaN, the rest are finite (OCP FP8 E4M3)
+    IEEE754_FINITE,   // All finite, there are no infinities or NaNs (OCP FP4)
+};
+
 struct IEEE754Float16Traits
 {
+    static constexpr int TypeCode = {TMPL_TYPE_BINARY16};
     static constexpr const char* TypeName = "binary16";
     static constexpr const char* TypeNameLong = "IEEE 754 16-bit Float (binary16)";
     static constexpr int NumBits = 16;
     static constexpr int NumExponentBits = 5;
     static constexpr int NumMantissaBits = 10;
+    static constexpr IEEE754Specials Specials = IEEE754_INF_NAN;
+    static constexpr bool ExplicitIntegerBit = false;
 };
 
 struct IEEE754BFloat16Traits
 {
+    static constexpr int TypeCode = {TMPL_TYPE_BFLOAT16};
     static constexpr const char* TypeName = "bfloat16";
     static constexpr const char* TypeNameLong = "Brain floating-point";
     static constexpr int NumBits = 16;
     static constexpr int NumExponentBits = 8;
     static constexpr int NumMantissaBits = 7;
+    static constexpr IEEE754Specials Specials = IEEE754_INF_NAN;
+    static constexpr bool ExplicitIntegerBit = false;
 };
 
 struct IEEE754MinifloatTraits
 {
+    static constexpr int TypeCode = {TMPL_TYPE_MINIFLOAT};
     static constexpr const char* TypeName = "minifloat";
     static constexpr const char* TypeNameLong = "Minifloat";
     static constexpr int NumBits = 8;
     static constexpr int NumExponentBits = 4;
     static constexpr int NumMantissaBits = 3;
+    static constexpr IEEE754Specials Specials = IEEE754_INF_NAN;
+    static constexpr bool ExplicitIntegerBit = false;
 };
 
 struct IEEE754Float32Traits
 {
+    static constexpr int TypeCode = {TMPL_TYPE_BINARY32};
     static constexpr const char* TypeName = "binary32";
     static constexpr const char* TypeNameLong = "IEEE 754 32-bit Float (binary32)";
     static constexpr int NumBits = 32;
     static constexpr int NumExponentBits = 8;
     static constexpr int NumMantissaBits = 23;
+    static constexpr IEEE754Specials Specials = IEEE754_INF_NAN;
+    static constexpr bool ExplicitIntegerBit = false;
 };
 
 struct IEEE754Float64Traits
 {
+    static constexpr int TypeCode = {TMPL_TYPE_BINARY64};
     static constexpr const char* TypeName = "binary64";
     static constexpr const char* TypeNameLong = "IEEE 754 64-bit Float (binary64)";
     static constexpr int NumBits = 64;
     static constexpr int NumExponentBits = 11;
     static constexpr int NumMantissaBits = 52;
+    static constexpr IEEE754Specials Specials = IEEE754_INF_NAN;
+    static constexpr bool ExplicitIntegerBit = false;
+};
+
+struct IEEE754Float128Traits
+{
+    static constexpr int TypeCode = {TMPL_TYPE_BINARY128};
+    static constexpr const char* TypeName = "binary128";
+    static constexpr const char* TypeNameLong = "IEEE 754 128-bit Float (binary128)";
+    static constexpr int NumBits = 128;
+    static constexpr int NumExponentBits = 15;
+    static constexpr int NumMantissaBits = 112;
+    static constexpr IEEE754Specials Specials = IEEE754_INF_NAN;
+    static constexpr bool ExplicitIntegerBit = false;
+};
+
+// x87 extended precision, the integer bit is the top mantissa bit instead of implied by the exponent
+struct X87ExtendedTraits
+{
+    static constexpr int TypeCode = {TMPL_TYPE_FLOAT80};
+    static constexpr const char* TypeName = "float80";
+    static constexpr const char* TypeNameLong = "x87 80-bit Extended Precision Float (long double)";
+    static constexpr int NumBits = 80;
+    static constexpr int NumExponentBits = 15;
+    static constexpr int NumMantissaBits = 64;
+    static constexpr IEEE754Specials Specials = IEEE754_INF_NAN;
+    static constexpr bool ExplicitIntegerBit = true;
+};
+
+// OCP 8-bit floats, the element types of MXFP8
+struct OcpE4M3Traits
+{
+    static constexpr int TypeCode = {TMPL_TYPE_E4M3};
+    static constexpr const char* TypeName = "e4m3";
+    static constexpr const char* TypeNameLong = "OCP 8-bit Float E4M3 (FP8)";
+    static constexpr int NumBits = 8;
+    static constexpr int NumExponentBits = 4;
+    static constexpr int NumMantissaBits = 3;
+    static constexpr IEEE754Specials Specials = IEEE754_NAN_ONLY;
+    static constexpr bool ExplicitIntegerBit = false;
+};
+
+struct OcpE5M2Traits
+{
+    static constexpr int TypeCode = {TMPL_TYPE_E5M2};
+    static constexpr const char* TypeName = "e5m2";
+    static constexpr const char* TypeNameLong = "OCP 8-bit Float E5M2 (FP8)";
+    static constexpr int NumBits = 8;
+    static constexpr int NumExponentBits = 5;
+    static constexpr int NumMantissaBits = 2;
+    static constexpr IEEE754Specials Specials = IEEE754_INF_NAN;
+    static constexpr bool ExplicitIntegerBit = false;
+};
+
+// OCP 4-bit float, the element type of MXFP4
+struct OcpE2M1Traits
+{
+    static constexpr int TypeCode = {TMPL_TYPE_E2M1};
+    static constexpr const char* TypeName = "e2m1";
+    static constexpr const char* TypeNameLong = "OCP 4-bit Float E2M1 (FP4)";
+    static constexpr int NumBits = 4;
+    static constexpr int NumExponentBits = 2;
+    static constexpr int NumMantissaBits = 1;
+    static constexpr IEEE754Specials Specials = IEEE754_FINITE;
+    static constexpr bool ExplicitIntegerBit = false;
 };
 
 struct Posit8Traits
 {
+    static constexpr int TypeCode = {TMPL_TYPE_POSIT8};
     static constexpr const char* TypeName = "posit8";
     static constexpr const char* TypeNameLong = "8-bit Posit (Type III Unum) (posit8)";
     static constexpr int NumBits = 8;
+    static constexpr int ExponentSize = 2;
 };
 
 struct Posit16Traits
 {
+    static constexpr int TypeCode = {TMPL_TYPE_POSIT16};
     static constexpr const char* TypeName = "posit16";
     static constexpr const char* TypeNameLong = "16-bit Posit (Type III Unum) (posit16)";
     static constexpr int NumBits = 16;
+    static constexpr int ExponentSize = 2;
 };
 
 struct Posit32Traits
 {
+    static constexpr int TypeCode = {TMPL_TYPE_POSIT32};
     static constexpr const char* TypeName = "posit32";
     static constexpr const char* TypeNameLong = "32-bit Posit (Type III Unum) (posit32)";
     static constexpr int NumBits = 32;
+    static constexpr int ExponentSize = 2;
 };
 
 struct Posit64Traits
 {
+    static constexpr int TypeCode = {TMPL_TYPE_POSIT64};
     static constexpr const char* TypeName = "posit64";
     static constexpr const char* TypeNameLong = "64-bit Posit (Type III Unum) (posit64)";
     static constexpr int NumBits = 64;
+    static constexpr int ExponentSize = 2;
+};
+
+// Exponent sizes of the drafts before the 2022 standard, which fixed es at 2
+struct Posit8Es0Traits
+{
+    static constexpr int TypeCode = {TMPL_TYPE_POSIT8_ES0};
+    static constexpr const char* TypeName = "posit8es0";
+    static constexpr const char* TypeNameLong = "8-bit Posit with es=0 (posit8es0)";
+    static constexpr int NumBits = 8;
+    static constexpr int ExponentSize = 0;
+};
+
+struct Posit16Es1Traits
+{
+    static constexpr int TypeCode = {TMPL_TYPE_POSIT16_ES1};
+    static constexpr const char* TypeName = "posit16es1";
+    static constexpr const char* TypeNameLong = "16-bit Posit with es=1 (posit16es1)";
+    static constexpr int NumBits = 16;
+    static constexpr int ExponentSize = 1;
+};
+
+// Widths the standard does not define
+struct Posit12Traits
+{
+    static constexpr int TypeCode = {TMPL_TYPE_POSIT12};
+    static constexpr const char* TypeName = "posit12";
+    static constexpr const char* TypeNameLong = "12-bit Posit (posit12)";
+    static constexpr int NumBits = 12;
+    static constexpr int ExponentSize = 2;
+};
+
+struct Posit24Traits
+{
+    static constexpr int TypeCode = {TMPL_TYPE_POSIT24};
+    static constexpr const char* TypeName = "posit24";
+    static constexpr const char* TypeNameLong = "24-bit Posit (posit24)";
+    static constexpr int NumBits = 24;
+    static constexpr int ExponentSize = 2;
+};
+
+// IEEE 754 decimal formats, with the coefficient in binary (BID) or in declets (DPD)
+struct Decimal32BidTraits
+{
+    static constexpr int TypeCode = {TMPL_TYPE_DECIMAL32_BID};
+    static constexpr const char* TypeName = "decimal32bid";
+    static constexpr const char* TypeNameLong = "IEEE 754 32-bit Decimal, binary coefficient (decimal32 BID)";
+    static constexpr int NumBits = 32;
+    static constexpr bool IsDpd = false;
+};
+
+struct Decimal32DpdTraits
+{
+    static constexpr int TypeCode = {TMPL_TYPE_DECIMAL32_DPD};
+    static constexpr const char* TypeName = "decimal32dpd";
+    static constexpr const char* TypeNameLong = "IEEE 754 32-bit Decimal, densely packed decimal (decimal32 DPD)";
+    static constexpr int NumBits = 32;
+    static constexpr bool IsDpd = true;
+};
+
+struct Decimal64BidTraits
+{
+    static constexpr int TypeCode = {TMPL_TYPE_DECIMAL64_BID};
+    static constexpr const char* TypeName = "decimal64bid";
+    static constexpr const char* TypeNameLong = "IEEE 754 64-bit Decimal, binary coefficient (decimal64 BID)";
+    static constexpr int NumBits = 64;
+    static constexpr bool IsDpd = false;
+};
+
+struct Decimal64DpdTraits
+{
+    static constexpr int TypeCode = {TMPL_TYPE_DECIMAL64_DPD};
+    static constexpr const char* TypeName = "decimal64dpd";
+    static constexpr const char* TypeNameLong = "IEEE 754 64-bit Decimal, densely packed decimal (decimal64 DPD)";
+    static constexpr int NumBits = 64;
+    static constexpr bool IsDpd = true;
+};
+
+struct Decimal128BidTraits
+{
+    static constexpr int TypeCode = {TMPL_TYPE_DECIMAL128_BID};
+    static constexpr const char* TypeName = "decimal128bid";
+    static constexpr const char* TypeNameLong = "IEEE 754 128-bit Decimal, binary coefficient (decimal128 BID)";
+    static constexpr int NumBits = 128;
+    static constexpr bool IsDpd = false;
+};
+
+struct Decimal128DpdTraits
+{
+    static constexpr int TypeCode = {TMPL_TYPE_DECIMAL128_DPD};
+    static constexpr const char* TypeName = "decimal128dpd";
+    static constexpr const char* TypeNameLong = "IEEE 754 128-bit Decimal, densely packed decimal (decimal128 DPD)";
+    static constexpr int NumBits = 128;
+    static constexpr bool IsDpd = true;
+};
+
+// Encodings an editor had before, with their rendered results, for TMPL_SET_UNDO and
+// TMPL_SET_REDO. Entries are moved in and out rather than copied, so going back and forth is O(1)
+// and does no bigint work. The bytes of the entries are bounded, dropping the oldest first.
+struct EditorHistory
+{
+    struct Entry
+    {
+        unsigned __int128 repr; // Fits every type
+        bool isComplete;        // false when the value was still being computed
+        PackedDigits exact10;
+        PackedDigits exact2;
+        std::string math;
+
+        size_t Bytes() const
+        {
+            return sizeof(Entry) + exact10.Bytes() + exact2.Bytes() + math.capacity();
+        }
+    };
+
+    // Records the state an editor leaves for a new value, which drops what could be redone
+    void Push(Entry entry)
+    {
+        for (const Entry &e : _redo)
+        {
+            _bytes -= e.Bytes();
+        }
+        _redo.clear();
+        _bytes += entry.Bytes();
+        _undo.push_back(std::move(entry));
+        evict();
+    }
+
+    // Swaps current with the entry one step back or forward. Returns false, leaving current as it
+    // is, when there is none.
+    bool Undo(Entry &current) { return step(_undo, _redo, current); }
+    bool Redo(Entry &current) { return step(_redo, _undo, current); }
+
+    bool CanUndo() const { return !_undo.empty(); }
+    bool CanRedo() const { return !_redo.empty(); }
+
+    void SetLimit(size_t limit)
+    {
+        _limit = limit;
+        evict();
+    }
+
+    bool step(std::deque<Entry> &from, std::deque<Entry> &to, Entry &current)
+    {
+        if (from.empty())
+        {
+            return false;
+        }
+        _bytes += current.Bytes();
+        _bytes -= from.back().Bytes();
+        to.push_back(std::move(current));
+        current = std::move(from.back());
+        from.pop_back();
+        evict();
+        return true;
+    }
+
+    // The oldest entries are at the front of the undo ones, then at the front of the redo ones
+    void evict()
+    {
+        while (_bytes > _limit && (!_undo.empty() || !_redo.empty()))
+        {
+            std::deque<Entry> &oldest = _undo.empty() ? _redo : _undo;
+            _bytes -= oldest.front().Bytes();
+            oldest.pop_front();
+        }
+    }
+
+    std::deque<Entry> _undo;
+    std::deque<Entry> _redo;
+    size_t _limit = 1 << 20;
+    size_t _bytes = 0;
 };
 
+struct Unpacked;
+
 struct Editor {
     virtual std::string GetStringImpl(int code) const = 0;
     virtual int GetInt(int code) const = 0;
     virtual void SetValue(int code, const char *) = 0;
 
-    const char* GetString(int code) const
+    // Exact expansions of the largest values can take long. SetValueDeferred changes the value like
+    // SetValue, but only updates the cheap fields; the exact value and the math are left empty until
+    // StepJob returns true. Each StepJob call works for at most about maxOps digit operations or
+    // maxMicros microseconds, zero meaning no limit. Decimal values are computed in full by
+    // SetValueDeferred, so for them StepJob always returns true at once.
+    virtual void SetValueDeferred(int code, const char *) = 0;
+    virtual bool StepJob(int64_t maxOps, int64_t maxMicros) = 0;
+
+    // Writes string codes of `count` consecutive encodings, starting from the one in reprStr and
+    // walking with Next, into buf. Fields are separated by tabs and each encoding ends with a newline.
+    // Stops early if buf is full or there is no next value, for posits after the largest. reprStr is
+    // updated to the encoding to continue from, so it needs room for the repr string of the type, or
+    // emptied after the last encoding. Nothing is written for an empty or malformed reprStr. Returns
+    // the number of lines written. Does not change the value of the editor.
+    virtual int Enumerate(char *reprStr, int count, const int *codes, int numCodes, char *buf, int bufSize) const = 0;
+
+    // The value as sign, exponent and significand, see SoftFloat.cpp
+    virtual Unpacked Unpack() const = 0;
+
+    // Starts stream on the text of TMPL_STRCODE_EXACT_BASE10, returns false if the value has none
+    virtual bool StartExactStream(ExactDecimalStream &stream) const = 0;
+
+    // Whether valstr is a TMPL_SET_REPRSTR value of the type, which sets the others to zero
+    virtual bool IsReprString(const char *valstr) const = 0;
+
+    // Editors are not shared between threads, create one per thread with e_create. Everything they
+    // share, the bigint constants and the ResultCache, is either immutable or locked.
+    virtual ~Editor() = default;
+
+    const char* GetString(int code)
     {
         auto &c = _cachedStrings[code];
         if (c.version != _version)
@@ -122,1125 +427,3945 @@ struct Editor {
     };
 
     uint64_t _version = 1; // for caching
-    mutable CachedString _cachedStrings[{TMPL_STRCODE_MAX}];
+    CachedString _cachedStrings[{TMPL_STRCODE_MAX}];
+    EditorHistory _history;
+    int _precision = ScientificDefaultDigits; // of TMPL_STRCODE_SCIENTIFIC, set with TMPL_SET_PRECISION
 };
 
-template <typename TraitsType>
-struct CommonRepr
+// Powers of two that only depend on the binade, so stepping one ULP at a time
+// does not compute them again
+struct BinadeCache
 {
-    // Code that can be shared by all float types
-    static constexpr int NumBits = TraitsType::NumBits;
-    static_assert(NumBits % 8 == 0);
+    const SimpleNumber& Ulp(int ulpExp)
+    {
+        if (!_hasUlp || ulpExp != _ulpExp)
+        {
+            _ulp = SimpleNumber::pow2(ulpExp);
+            _ulpExp = ulpExp;
+            _hasUlp = true;
+        }
+        return _ulp;
+    }
 
-    static constexpr int NumBytes = NumBits / 8;
+    // 2 ** -ulpExp in base10, used as the denominator in the fraction form
+    const std::string& Denominator(int ulpExp)
+    {
+        if (!_hasDenom || ulpExp != _denomExp)
+        {
+            SetDenominator(ulpExp, SimpleNumber::pow2(-ulpExp).render10());
+        }
+        return _denom;
+    }
 
-    static constexpr const char ToHex[16] = { '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'a', 'b', 'c', 'd', 'e', 'f' };
-    static uint32_t FromHex(char c)
+    void SetDenominator(int ulpExp, std::string denom)
     {
-        if (c >= '0' && c <= '9') return c - '0';
-        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
-        return 16;
+        _denom = std::move(denom);
+        _denomExp = ulpExp;
+        _hasDenom = true;
     }
 
-    static std::string GetBitString(uint64_t val)
+    bool _hasUlp = false;
+    bool _hasDenom = false;
+    int _ulpExp = 0;
+    int _denomExp = 0;
+    SimpleNumber _ulp;
+    std::string _denom;
+};
+
+// Renders of recently computed values of all types, so revisiting a value, or switching type and
+// coming back, does not compute it again. Bounded by the bytes held, least recently used entries
+// are dropped first. Only the strings are kept, with the digits of the exact values packed by
+// PackedDigits, which is far smaller than the bigints.
+struct ResultCache
+{
+    struct Entry
     {
-        std::string res;
-        for (int i = 0; i < NumBits; ++i)
+        PackedDigits exact10;
+        PackedDigits exact2;
+        std::string math;
+
+        size_t Bytes() const
         {
-            res.push_back((val & (1ull << i)) ? '1' : '0');
+            // Includes an estimate for the list and index nodes
+            return sizeof(Entry) + 64 + exact10.Bytes() + exact2.Bytes() + math.capacity();
         }
-        return res;
+    };
+
+    static ResultCache& Global()
+    {
+        static ResultCache cache;
+        return cache;
     }
 
-    static std::string GetByteString(uint64_t val)
+    // Encodings are keyed as 128 bits, which fits every type
+    using Repr = unsigned __int128;
+
+    bool Lookup(int type, Repr repr, Entry &out)
     {
-        uint8_t bytes[8];
-        memcpy(bytes, &val, 8);
-        std::string res;
-        for (int i = 0; i < NumBytes; ++i)
+        STATS_SCOPE(STATS_CACHE_LOOKUP);
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto it = _index.find(Key{type, repr});
+        if (it == _index.end())
         {
-            res.push_back(ToHex[bytes[i]/16]);
-            res.push_back(ToHex[bytes[i]%16]);
+            return false;
         }
-        return res;
+        STATS_COUNT(STATS_CACHE_HIT);
+        _lru.splice(_lru.begin(), _lru, it->second);
+        out = it->second->second;
+        return true;
     }
 
-    static std::string GetBytesPretty(uint64_t val)
+    void Insert(int type, Repr repr, Entry entry)
     {
-        uint8_t bytes[8];
-        memcpy(bytes, &val, 8);
-        std::string res;
-        for (int i = 0; i < NumBytes; ++i)
+        std::lock_guard<std::mutex> lock(_mutex);
+        Key key{type, repr};
+        auto it = _index.find(key);
+        if (it != _index.end())
         {
-            res.push_back('0');
-            res.push_back('x');
-            res.push_back(ToHex[bytes[i]/16]);
-            res.push_back(ToHex[bytes[i]%16]);
-            if (i < NumBytes - 1)
-            {
-                res.push_back(' ');
-            }
+            _bytes -= it->second->second.Bytes();
+            _lru.erase(it->second);
+            _index.erase(it);
         }
-        if (NumBytes != 1)
+
+        size_t bytes = entry.Bytes();
+        if (bytes > _limit)
         {
-            res += " (little endian)";
+            return;
         }
-        return res;
+
+        _lru.emplace_front(key, std::move(entry));
+        _index[key] = _lru.begin();
+        _bytes += bytes;
+        evict();
     }
 
-    static std::string ToReprString(uint64_t val)
+    void SetLimit(size_t limit)
     {
-        return "hex:" + GetByteString(val);
+        std::lock_guard<std::mutex> lock(_mutex);
+        _limit = limit;
+        evict();
+    }
+
+    size_t Bytes()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _bytes;
     }
 
-    static uint64_t FromReprString(std::string_view valstr)
+    void evict()
     {
-        uint8_t bytes[8] = {};
-        if (valstr.size() == 4 + 2 * NumBytes && valstr.substr(0, 4) == "hex:")
+        while (_bytes > _limit)
         {
-            for (int i = 0; i < NumBytes; ++i)
-            {
-                uint32_t h1 = FromHex(valstr[4+2*i]);
-                uint32_t h2 = FromHex(valstr[5+2*i]);
-                if (h1 == 16 || h2 == 16) return 0;
-                bytes[i] = h1 << 4 | h2;
-            }
+            auto &last = _lru.back();
+            _bytes -= last.second.Bytes();
+            _index.erase(last.first);
+            _lru.pop_back();
         }
-        uint64_t res;
-        memcpy(&res, bytes, 8);
-        return res;
     }
-};
 
-template <typename TraitsType>
-struct IEEE754FloatRepresentation : CommonRepr<TraitsType>
-{
-    using Self = IEEE754FloatRepresentation<TraitsType>;
-
-    static constexpr int NumMantissaBits = TraitsType::NumMantissaBits;
-    static constexpr int NumExponentBits = TraitsType::NumExponentBits;
-    static_assert(NumMantissaBits + NumExponentBits + 1 == Self::NumBits);
+    struct Key
+    {
+        int type;
+        Repr repr;
 
-    static constexpr int ExponentBias = (1ull << (NumExponentBits - 1)) - 1;
-    static constexpr int ExponentForEpsilon = ExponentBias - NumMantissaBits;
-    static constexpr int ExponentForULP1 = ExponentBias + NumMantissaBits;
+        bool operator==(const Key &ot) const
+        {
+            return type == ot.type && repr == ot.repr;
+        }
+    };
 
-    static constexpr int SignShift = NumMantissaBits + NumExponentBits;
-    static constexpr int64_t SignMask = 1ull;
+    struct KeyHash
+    {
+        size_t operator()(const Key &key) const
+        {
+            return std::hash<uint64_t>()((uint64_t)key.repr * 31 + (uint64_t)(key.repr >> 64) * 961 + key.type);
+        }
+    };
 
-    static constexpr int ExponentShift = NumMantissaBits;
-    static constexpr int64_t ExponentMask = (1ull << NumExponentBits) - 1ull;
+    using List = std::list<std::pair<Key, Entry>>;
+    List _lru;
+    std::unordered_map<Key, List::iterator, KeyHash> _index;
+    size_t _limit = 32 << 20;
+    size_t _bytes = 0;
+    std::mutex _mutex;
+};
 
-    static constexpr int MantissaShift = 0;
-    static constexpr int64_t MantissaMask = (1ull << NumMantissaBits) - 1ull;
+// Exact value of an encoding, and the denominator of its fraction form if it is not an integer,
+// computed a slice at a time
+struct ValueJob
+{
+    template <typename UInt>
+    void Start(UInt num, int exp, bool isNegative)
+    {
+        _value.Start(num, exp);
+        _isNegative = isNegative;
+        _exp = exp;
+        if (exp < 0)
+        {
+            _denom.Start(1u, -exp);
+        }
+        _isActive = true;
+    }
 
-    static uint64_t GetSign(    uint64_t val) { return (val >>     SignShift) &     SignMask; }
-    static uint64_t GetExponent(uint64_t val) { return (val >> ExponentShift) & ExponentMask; }
-    static uint64_t GetMantissa(uint64_t val) { return (val >> MantissaShift) & MantissaMask; }
+    // Returns true when done, then the results can be moved out with Finish
+    bool Step(StepBudget &budget)
+    {
+        STATS_SCOPE(STATS_VALUE);
+        if (!_value.Step(budget) || (_exp < 0 && !_denom.Step(budget)))
+        {
+            return false;
+        }
+        STATS_DIGITS(_value._base10._store._digits.size());
+        return true;
+    }
 
-    static uint64_t Construct(uint64_t sign, uint64_t exponent, uint64_t mantissa)
+    void Finish(SimpleNumber &value, BinadeCache &binade)
     {
-        return ((sign     &     SignMask) <<     SignShift)
-             | ((exponent & ExponentMask) << ExponentShift)
-             | ((mantissa & MantissaMask) << MantissaShift);
+        value._base2 = std::move(_value._base2);
+        value._base10 = std::move(_value._base10);
+        value._isNegative = _isNegative;
+        if (_exp < 0)
+        {
+            SimpleNumber denom;
+            denom._base10 = std::move(_denom._base10);
+            binade.SetDenominator(_exp, denom.render10());
+        }
+        _isActive = false;
     }
 
-    static bool IsNanOrInf(uint64_t val)
+    ScaledNumberJob _value;
+    ScaledNumberJob _denom;
+    bool _isNegative = false;
+    int _exp = 0;
+    bool _isActive = false;
+};
+
+// Exact renders of a value that is a multiple of 2 ** ulpExp, all digits after the dot are shown
+// so the precision of the type is visible
+inline void RenderExact(const SimpleNumber &value, int ulpExp, std::string &exact10, std::string &exact2)
+{
+    // Nice thing is digitsAfterDot is same for both base2 and base10
+    int digitsAfterDot = std::max(0, -ulpExp);
+    exact10 = value.render10(digitsAfterDot);
+    exact2 = value.render2(digitsAfterDot);
+}
+
+// TMPL_STRCODE_SCIENTIFIC or TMPL_STRCODE_HEXFLOAT of sig * 2 ** exp, which need none of the bigint
+// value of the editors
+inline std::string RenderFixedPrecision(int code, bool sign, unsigned __int128 sig, int exp, int numDigits)
+{
+    if (code == {TMPL_STRCODE_SCIENTIFIC})
     {
-        return GetExponent(val) == ExponentMask;
+        return RenderScientific(sign, sig, exp, numDigits);
     }
+    return RenderHexFloat(sign, DigitBigInt::FromInteger(sig), exp);
+}
+
+// Value of a one ULP step from the previous value, where `step` is the change in magnitude
+inline void StepByUlp(SimpleNumber &value, const SimpleNumber &ulp, int step)
+{
+    STATS_SCOPE(STATS_VALUE);
+    bool isNegative = value._isNegative;
+    value = (step > 0 ? value + ulp : value - ulp);
+    value._isNegative = isNegative;
+}
 
-    static uint64_t PositiveInfinity() { return Construct(0,   ExponentMask,         0                               ); }
-    static uint64_t NegativeInfinity() { return Construct(1,   ExponentMask,         0                               ); }
-    static uint64_t QuietNan()         { return Construct(0,   ExponentMask,         1ull << (NumMantissaBits - 1)   ); }
-    static uint64_t SignalingNan()     { return Construct(0,   ExponentMask,         1ull << (NumMantissaBits - 2)   ); }
-    static uint64_t MinNormalized()    { return Construct(0,   1,                    0                               ); }
-    static uint64_t MaxFinite()        { return Construct(0,   ExponentMask - 1,     MantissaMask                    ); }
-    static uint64_t MinDenormalized()  { return Construct(0,   0,                    1                               ); }
-    static uint64_t Zero()             { return Construct(0,   0,                    0                               ); }
-    static uint64_t One()              { return Construct(0,   ExponentBias,         0                               ); }
-    static uint64_t Epsilon()          { return Construct(0,   ExponentForEpsilon,   0                               ); }
+template <typename EditorType>
+int EnumerateValues(char *reprStr, int count, const int *codes, int numCodes, char *buf, int bufSize, int precision)
+{
+    using ReprType = typename EditorType::ReprType;
 
-    static uint64_t DecrementMantissa(uint64_t val) { return Construct( GetSign(val), GetExponent(val),   GetMantissa(val)-1 ); }
-    static uint64_t IncrementMantissa(uint64_t val) { return Construct( GetSign(val), GetExponent(val),   GetMantissa(val)+1 ); }
-    static uint64_t DecrementExponent(uint64_t val) { return Construct( GetSign(val), GetExponent(val)-1, GetMantissa(val)   ); }
-    static uint64_t IncrementExponent(uint64_t val) { return Construct( GetSign(val), GetExponent(val)+1, GetMantissa(val)   ); }
+    bool needMath = std::find(codes, codes + numCodes, {TMPL_STRCODE_MATH}) != codes + numCodes;
 
-    static uint64_t Negate(uint64_t val)
+    typename ReprType::Storage start;
+    if (!ReprType::ParseReprString(reprStr, start))
     {
-        if (IsNanOrInf(val))
+        if (bufSize > 0)
         {
-            return val;
+            buf[0] = '\0';
         }
-        return Construct(1-GetSign(val), GetExponent(val), GetMantissa(val));
+        return 0;
     }
 
-    static uint64_t Next(uint64_t val)
-    {
-        uint64_t mantissa = GetMantissa(val);
-        uint64_t exponent = GetExponent(val);
-        uint64_t sign = GetSign(val);
+    // A separate editor, so neighbours share the ULP stepping without touching the one being viewed
+    EditorType walker;
+    walker._repr = start;
+    walker._value = ReprType::GetValue(walker._repr);
+    walker._precision = precision;
 
-        if (sign == 0)
+    int numWritten = 0;
+    int used = 0;
+    bool hasNext = true;
+    while (numWritten < count && hasNext)
+    {
+        walker.renderExact();
+        if (needMath)
         {
-            // Positive number, increment value
-            if (IsNanOrInf(val))
-            {
-                return val; // no more room
-            }
+            walker.recomputeMath();
+        }
 
-            if (mantissa == MantissaMask)
-            {
-                mantissa = 0;
-                exponent += 1;
-            }
-            else
+        int lineStart = used;
+        for (int i = 0; i < numCodes && used >= 0; ++i)
+        {
+            std::string field = walker.GetStringImpl(codes[i]);
+            if (used + (int)field.size() + 1 >= bufSize)
             {
-                mantissa += 1;
+                used = -1;
+                break;
             }
-
-            return Construct(sign, exponent, mantissa);
+            memcpy(buf + used, field.data(), field.size());
+            used += field.size();
+            buf[used++] = (i == numCodes - 1 ? '\n' : '\t');
         }
-        else
+        if (used < 0)
         {
-            // Negative, if zero, set to positive zero, if inf set to -MaxFinite, else decrement
-
-            if (IsNanOrInf(val))
-            {
-                if (mantissa == 0) // Inf
-                {
-                    return Construct(1ull, ExponentMask-1, MantissaMask);
-                }
-                else
-                {
-                    return val; // NaN
-                }
-            }
-
-            if (exponent == 0 && mantissa == 0)
-            {
-                return Zero();
-            }
-
-            if (mantissa == 0)
-            {
-                mantissa = MantissaMask;
-                exponent--;
-            }
-            else
-            {
-                mantissa--;
-            }
+            used = lineStart;
+            break;
+        }
+        ++numWritten;
 
-            return Construct(sign, exponent, mantissa);
+        // Next stays at the end of the IEEE 754 and decimal types, posits wrap around through NaR
+        auto prevRepr = walker._repr;
+        walker._repr = ReprType::Next(prevRepr);
+        hasNext = (walker._repr != prevRepr && ReprType::ValueClass(walker._repr) != {TMPL_VALUECLASS_NAR});
+        if (hasNext)
+        {
+            walker.recomputeValue(prevRepr);
         }
     }
 
-    static uint64_t Prev(uint64_t val)
+    if (bufSize > 0)
     {
-        val ^= (SignMask << SignShift);
-        val = Next(val);
-        val ^= (SignMask << SignShift);
-        return val;
+        buf[used] = '\0';
     }
+    std::string next = (hasNext ? ReprType::ToReprString(walker._repr) : "");
+    memcpy(reprStr, next.c_str(), next.size() + 1);
+    return numWritten;
+}
 
-    static SimpleNumber GetValue(uint64_t val)
-    {
-        SimpleNumber res;
+// Ordinal of NaN and NaR, below the ordinals of all ordered values
+constexpr int64_t NanOrdinal = INT64_MIN;
 
-        if (IsNanOrInf(val))
+// Queries on top of ToOrdinal/FromOrdinal of a representation, which turn into integer math.
+// The array versions have no branches in the loop, so they vectorize.
+template <typename ReprType>
+struct Ordinals
+{
+    // Result of UlpDistance when a value is NaN or NaR, distances of ordered values are smaller
+    static constexpr uint64_t Unordered = ~0ull;
+
+    // Number of steps with Next to get from one value to the other, zeros are one value
+    static uint64_t UlpDistance(uint64_t a, uint64_t b)
+    {
+        int64_t ordA = ReprType::ToOrdinal(a);
+        int64_t ordB = ReprType::ToOrdinal(b);
+        // Distances between the ends of the 64-bit types only fit unsigned
+        uint64_t dist = ordA > ordB ? (uint64_t)ordA - (uint64_t)ordB : (uint64_t)ordB - (uint64_t)ordA;
+        return (ordA == NanOrdinal || ordB == NanOrdinal) ? Unordered : dist;
+    }
+
+    // Number of distinct values in [lo, hi], 0 if hi is below lo or either is NaN or NaR
+    static uint64_t CountInRange(uint64_t lo, uint64_t hi)
+    {
+        int64_t ordLo = ReprType::ToOrdinal(lo);
+        int64_t ordHi = ReprType::ToOrdinal(hi);
+        uint64_t count = (uint64_t)ordHi - (uint64_t)ordLo + 1;
+        return (ordLo == NanOrdinal || ordHi == NanOrdinal || ordHi < ordLo) ? 0 : count;
+    }
+
+    // Value k steps above val, or below for negative k. Returns false for NaN and NaR, and when
+    // it would be past the ends.
+    static bool KthAfter(uint64_t val, int64_t k, uint64_t &res)
+    {
+        int64_t ord = ReprType::ToOrdinal(val);
+        int64_t target;
+        if (ord == NanOrdinal || __builtin_add_overflow(ord, k, &target))
         {
-            return res; // N/A
+            return false;
         }
+        return ReprType::FromOrdinal(target, res);
+    }
 
-        bool isDenormal = (GetExponent(val) == 0);
-
-        SimpleNumber expTerm = SimpleNumber::pow2((int)GetExponent(val) - ExponentBias + isDenormal);
+    static void ToOrdinals(const uint64_t *vals, int64_t *out, size_t n)
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            out[i] = ReprType::ToOrdinal(vals[i]);
+        }
+    }
 
-        SimpleNumber mTerm = SimpleNumber(GetMantissa(val)) * SimpleNumber::pow2(-TraitsType::NumMantissaBits);
-        if (!isDenormal)
+    static void UlpDistances(const uint64_t *a, const uint64_t *b, uint64_t *out, size_t n)
+    {
+        for (size_t i = 0; i < n; ++i)
         {
-            mTerm = mTerm + SimpleNumber::One();
+            out[i] = UlpDistance(a[i], b[i]);
         }
+    }
 
-        res = expTerm * mTerm;
-        res._isNegative = GetSign(val);
-        return res;
+    static void CountsInRange(const uint64_t *lo, const uint64_t *hi, uint64_t *out, size_t n)
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            out[i] = CountInRange(lo[i], hi[i]);
+        }
     }
 };
 
-template <typename TraitsType>
-struct PositRepresentation : CommonRepr<TraitsType>
+// Sorting and merging of encodings in the order of ToTotalOrderKey of a representation. The keys
+// compare as unsigned integers, so encodings are never converted to double and the sort is a radix
+// sort of one pass per byte of the type.
+template <typename ReprType>
+struct TotalOrder
 {
-    using Self = PositRepresentation<TraitsType>;
-
-    static constexpr uint64_t BitMask = (~0ull) >> (sizeof(uint64_t)*8 - Self::NumBits);
-    static constexpr int MinRegime = -Self::NumBits + 1;
-    static constexpr int MaxRegime = Self::NumBits - 2;
-
-    static uint64_t Zero() { return 0; }
-    static uint64_t One() { return 1ull << (Self::NumBits - 2); }
-    static uint64_t MinPositive() { return 1; }
-    static uint64_t MaxFinite() { return BitMask >> 1; }
-    static uint64_t NaR() { return 1ull << (Self::NumBits - 1); }
-    static uint64_t Epsilon() { return 5ull << (Self::NumBits - 1 - 2 - Self::NumBits / 4); }
-
-    static uint64_t Next(uint64_t val) { return (val + 1) & BitMask; }
-    static uint64_t Prev(uint64_t val) { return (val - 1) & BitMask; }
+    static constexpr int NumKeyBytes = (ReprType::NumBits + 7) / 8;
 
-    static uint64_t Negate(uint64_t val)
+    static void ToKeys(const uint64_t *vals, uint64_t *out, size_t n)
     {
-        if (val == NaR() || val == Zero())
+        for (size_t i = 0; i < n; ++i)
         {
-            return val;
+            out[i] = ReprType::ToTotalOrderKey(vals[i]);
         }
-
-        return (0ull - val) & BitMask;
     }
 
-    static uint64_t DecrementRegime(uint64_t val)
+    static void FromKeys(const uint64_t *keys, uint64_t *out, size_t n)
     {
-        int regime = GetRegime(val);
-        if (regime == MinRegime)
+        for (size_t i = 0; i < n; ++i)
         {
-            return val;
+            out[i] = ReprType::FromTotalOrderKey(keys[i]);
         }
-        if (regime > 0)
+    }
+
+    static void Sort(uint64_t *vals, size_t n, int numThreads)
+    {
+        std::vector<uint64_t> tmp(n);
+        ToKeys(vals, vals, n);
+        uint64_t *sorted = RadixSortKeys(vals, tmp.data(), n, NumKeyBytes, numThreads);
+        FromKeys(sorted, vals, n);
+    }
+
+    // Merges the sorted a and b into out, writing each encoding once. Returns the number written.
+    // With nb = 0, out may be a, which removes the duplicates of a in place.
+    static size_t MergeUnique(const uint64_t *a, size_t na, const uint64_t *b, size_t nb, uint64_t *out)
+    {
+        size_t i = 0;
+        size_t j = 0;
+        size_t numWritten = 0;
+        while (i < na || j < nb)
         {
-            return ((val << 1) & (BitMask >> 1)) | (GetSignBit(val) << (Self::NumBits - 1));
+            bool takeA = j == nb || (i < na && ReprType::ToTotalOrderKey(a[i]) <= ReprType::ToTotalOrderKey(b[j]));
+            uint64_t val = takeA ? a[i++] : b[j++];
+            if (numWritten == 0 || out[numWritten - 1] != val)
+            {
+                out[numWritten++] = val;
+            }
         }
-        if (regime == 0)
+        return numWritten;
+    }
+};
+
+// Word the encodings of a type are held in, the types wider than 64 bits take two
+template <int NumBits>
+using StorageFor = std::conditional_t<(NumBits > 64), unsigned __int128, uint64_t>;
+
+// std::to_string has no overload for the 128-bit storage
+inline std::string UintToString(unsigned __int128 val)
+{
+    char buf[40];
+    char *p = buf + sizeof(buf);
+    do
+    {
+        *--p = '0' + val % 10;
+        val /= 10;
+    } while (val);
+    return std::string(p, buf + sizeof(buf));
+}
+
+template <typename TraitsType, typename StorageType = StorageFor<TraitsType::NumBits>>
+struct CommonRepr
+{
+    // Code that can be shared by all float types
+    static constexpr int NumBits = TraitsType::NumBits;
+
+    using Storage = StorageType;
+    static_assert(NumBits <= sizeof(Storage) * 8);
+
+    // Types narrower than a byte take a whole one, with the high bits zero
+    static constexpr int NumBytes = (NumBits + 7) / 8;
+
+    static constexpr const char ToHex[16] = { '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'a', 'b', 'c', 'd', 'e', 'f' };
+    static uint32_t FromHex(char c)
+    {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        return 16;
+    }
+
+    static std::string GetBitString(Storage val)
+    {
+        std::string res;
+        for (int i = 0; i < NumBits; ++i)
         {
-            return val ^ (3ull << (Self::NumBits - 3));
+            res.push_back(((val >> i) & 1) ? '1' : '0');
         }
-        else
+        return res;
+    }
+
+    static std::string GetByteString(Storage val)
+    {
+        uint8_t bytes[sizeof(Storage)];
+        memcpy(bytes, &val, sizeof(Storage));
+        std::string res;
+        for (int i = 0; i < NumBytes; ++i)
         {
-            // regime < 0
-            return ((val >> 1) & (BitMask >> 2)) | (GetSignBit(val) << (Self::NumBits - 1));
+            res.push_back(ToHex[bytes[i]/16]);
+            res.push_back(ToHex[bytes[i]%16]);
         }
+        return res;
     }
 
-    static uint64_t IncrementRegime(uint64_t val)
+    static std::string GetBytesPretty(Storage val)
     {
-        int regime = GetRegime(val);
-        if (regime == MaxRegime)
+        uint8_t bytes[sizeof(Storage)];
+        memcpy(bytes, &val, sizeof(Storage));
+        std::string res;
+        for (int i = 0; i < NumBytes; ++i)
         {
-            return val;
+            res.push_back('0');
+            res.push_back('x');
+            res.push_back(ToHex[bytes[i]/16]);
+            res.push_back(ToHex[bytes[i]%16]);
+            if (i < NumBytes - 1)
+            {
+                res.push_back(' ');
+            }
         }
-        if (regime == MinRegime)
+        if (NumBytes != 1)
         {
-            return val | 1ull;
+            res += " (little endian)";
         }
-        if (regime >= 0)
+        return res;
+    }
+
+    static std::string ToReprString(Storage val)
+    {
+        return "hex:" + GetByteString(val);
+    }
+
+    // Returns false if valstr is not a string of ToReprString
+    static bool ParseReprString(std::string_view valstr, Storage &res)
+    {
+        uint8_t bytes[sizeof(Storage)] = {};
+        if (valstr.size() != 4 + 2 * NumBytes || valstr.substr(0, 4) != "hex:")
         {
-            return ((val >> 1) & (BitMask >> 2)) | (1ull << (Self::NumBits - 2))  | (GetSignBit(val) << (Self::NumBits - 1));
+            return false;
         }
-        if (regime == -1)
+        for (int i = 0; i < NumBytes; ++i)
         {
-            return val ^ (3ull << (Self::NumBits - 3));
+            uint32_t h1 = FromHex(valstr[4+2*i]);
+            uint32_t h2 = FromHex(valstr[5+2*i]);
+            if (h1 == 16 || h2 == 16) return false;
+            bytes[i] = h1 << 4 | h2;
         }
-        else
+        memcpy(&res, bytes, sizeof(Storage));
+        if constexpr (NumBits % 8 != 0)
         {
-            // regime < -1
-            return ((val << 1) & (BitMask >> 1)) | (GetSignBit(val) << (Self::NumBits - 1));
+            if (res >> NumBits) return false;
         }
+        return true;
     }
 
-    static uint64_t DecrementMantissa(uint64_t val)
-    {
-        int mb = NumMantissaBits(val);
-        return (val >> mb << mb) | ((val-1ull) & ((1ull << mb) - 1));
-    }
-    static uint64_t IncrementMantissa(uint64_t val)
+    // Zero for anything that is not a repr string
+    static Storage FromReprString(std::string_view valstr)
     {
-        int mb = NumMantissaBits(val);
-        return (val >> mb << mb) | ((val+1ull) & ((1ull << mb) - 1));
+        Storage res;
+        return ParseReprString(valstr, res) ? res : 0;
     }
+};
 
-    static uint64_t DecrementExponent(uint64_t val)
-    {
-        int eb = NumExponentBits(val);
-        int mb = NumMantissaBits(val);
-        if (eb == 0) return val;
-        if (eb == 1) return val ^ 1ull;
+template <typename TraitsType>
+struct IEEE754FloatRepresentation : CommonRepr<TraitsType>
+{
+    using Self = IEEE754FloatRepresentation<TraitsType>;
+    using Storage = typename CommonRepr<TraitsType>::Storage;
 
-        uint64_t newexpo = (GetExponent(val) - 1ull) & 3ull;
-        return (val >> (eb + mb) << (eb + mb)) | (newexpo << mb) | GetMantissa(val);
-    }
+    static constexpr int NumMantissaBits = TraitsType::NumMantissaBits;
+    static constexpr int NumExponentBits = TraitsType::NumExponentBits;
+    static_assert(NumMantissaBits + NumExponentBits + 1 == Self::NumBits);
 
-    static uint64_t IncrementExponent(uint64_t val)
-    {
-        int eb = NumExponentBits(val);
-        int mb = NumMantissaBits(val);
-        if (eb == 0) return val;
-        if (eb == 1) return val ^ 1ull;
+    // The mantissa field holds the integer bit too, the fraction is the bits below it
+    static constexpr bool ExplicitIntegerBit = TraitsType::ExplicitIntegerBit;
+    static constexpr int NumFractionBits = NumMantissaBits - ExplicitIntegerBit;
 
-        uint64_t newexpo = (GetExponent(val) + 1ull) & 3ull;
-        return (val >> (eb + mb) << (eb + mb)) | (newexpo << mb) | GetMantissa(val);
-    }
+    static constexpr int ExponentBias = (1ull << (NumExponentBits - 1)) - 1;
+    static constexpr int ExponentForEpsilon = ExponentBias - NumFractionBits;
+    static constexpr int ExponentForULP1 = ExponentBias + NumFractionBits;
+
+    static constexpr int SignShift = NumMantissaBits + NumExponentBits;
+    static constexpr int64_t SignMask = 1ull;
+
+    static constexpr int ExponentShift = NumMantissaBits;
+    static constexpr int64_t ExponentMask = (1ull << NumExponentBits) - 1ull;
 
+    static constexpr int MantissaShift = 0;
+    static constexpr Storage MantissaMask = ((Storage)1 << NumMantissaBits) - 1;
 
+    // Set in the mantissa of normal values of the types with an explicit integer bit, 0 otherwise
+    static constexpr Storage IntegerBit = (Storage)ExplicitIntegerBit << (NumMantissaBits - 1);
 
+    static constexpr uint64_t GetSign(    Storage val) { return (val >>     SignShift) &     SignMask; }
+    static constexpr uint64_t GetExponent(Storage val) { return (val >> ExponentShift) & ExponentMask; }
+    static constexpr Storage  GetMantissa(Storage val) { return (val >> MantissaShift) & MantissaMask; }
 
-    static uint64_t GetBit(uint64_t val, int bitIdx)
+    static constexpr Storage Construct(uint64_t sign, uint64_t exponent, Storage mantissa)
     {
-        if (bitIdx < 0) return 0; // Implicit for exponent
-        return (val >> bitIdx) & 1ull;
+        return ((Storage)(sign     &     SignMask) <<     SignShift)
+             | ((Storage)(exponent & ExponentMask) << ExponentShift)
+             | ((mantissa & MantissaMask) << MantissaShift);
     }
 
-    static int NumRegimeBits(uint64_t val)
+    static constexpr IEEE754Specials Specials = TraitsType::Specials;
+
+    // Unbiased exponent of MaxFinite()
+    static constexpr int MaxExponent = (Specials == IEEE754_INF_NAN ? ExponentMask - 1 : ExponentMask) - ExponentBias;
+
+    static constexpr bool IsNanOrInf(Storage val)
     {
-        int numRegimeBits = 0;
-        uint32_t regimeFirstBit = GetRegimeFirstBit(val);
-        for (int i = Self::NumBits - 2; i >= 0; --i)
+        if constexpr (Specials == IEEE754_INF_NAN)
         {
-            uint32_t regimeBit = (val >> i) & 1ull;
-            ++numRegimeBits;
-
-            if (regimeBit != regimeFirstBit)
-            {
-                break;
-            }
+            return GetExponent(val) == ExponentMask;
         }
-        return numRegimeBits;
+        else if constexpr (Specials == IEEE754_NAN_ONLY)
+        {
+            return GetExponent(val) == ExponentMask && GetMantissa(val) == MantissaMask;
+        }
+        return false;
     }
 
-    static int NumExponentBits(uint64_t val)
+    // Infinities without the integer bit are the pseudo-infinities of x87, which are NaNs
+    static int ValueClass(Storage val)
     {
-        return std::min(2, Self::NumBits - 1 - NumRegimeBits(val));
+        if (IsNanOrInf(val))
+        {
+            return GetMantissa(val) != IntegerBit ? {TMPL_VALUECLASS_NAN} : {TMPL_VALUECLASS_INFINITE};
+        }
+        if (GetExponent(val) == 0)
+        {
+            return GetMantissa(val) ? {TMPL_VALUECLASS_SUBNORMAL} : {TMPL_VALUECLASS_ZERO};
+        }
+        return {TMPL_VALUECLASS_NORMAL};
     }
 
-    static int NumMantissaBits(uint64_t val)
+    // Number of encodings of a TMPL_VALUECLASS_*, from the layout of the positive encodings: zero,
+    // subnormals, normals up to MaxFinite, the infinity and the NaNs. Like the ordinals, only for
+    // the types stored in 64 bits without an integer bit.
+    static uint64_t CountClass(int cls)
     {
-        return std::max(0, Self::NumBits - 1 - NumRegimeBits(val) - 2);
+        uint64_t numInfinite = (Specials == IEEE754_INF_NAN);
+        uint64_t perSign = 0;
+        switch (cls)
+        {
+        case {TMPL_VALUECLASS_ZERO}:      perSign = 1; break;
+        case {TMPL_VALUECLASS_SUBNORMAL}: perSign = MinNormalized() - 1; break;
+        case {TMPL_VALUECLASS_NORMAL}:    perSign = MaxFinite() - MinNormalized() + 1; break;
+        case {TMPL_VALUECLASS_INFINITE}:  perSign = numInfinite; break;
+        case {TMPL_VALUECLASS_NAN}:       perSign = (1ull << (Self::NumBits - 1)) - MaxFinite() - 1 - numInfinite; break;
+        }
+        return 2 * perSign;
     }
 
+    static Storage MinNormalized()    { return Construct(0,   1,                    IntegerBit                      ); }
+    static Storage MinDenormalized()  { return Construct(0,   0,                    1                               ); }
+    static Storage Zero()             { return Construct(0,   0,                    0                               ); }
+    static Storage One()              { return Construct(0,   ExponentBias,         IntegerBit                      ); }
 
-    static uint64_t GetSignBit(uint64_t val)
+    static Storage MaxFinite()
     {
-        return GetBit(val, Self::NumBits - 1);
+        return Construct(0, MaxExponent + ExponentBias, MantissaMask - (Specials == IEEE754_NAN_ONLY));
+    }
+
+    // Formats without infinities overflow to NaN, or saturate when they have no NaN either
+    static Storage PositiveInfinity()
+    {
+        if constexpr (Specials == IEEE754_INF_NAN)
+        {
+            return Construct(0, ExponentMask, IntegerBit);
+        }
+        return Specials == IEEE754_NAN_ONLY ? QuietNan() : MaxFinite();
     }
 
-    static uint32_t GetRegimeFirstBit(uint64_t val)
+    static Storage NegativeInfinity()
     {
-        return GetBit(val, Self::NumBits - 2);
+        return PositiveInfinity() | (Storage)SignMask << SignShift;
     }
 
-    static int GetRegime(uint64_t val)
+    // Formats without NaN get zero
+    static Storage QuietNan()
     {
-        int regBits = NumRegimeBits(val);
-        uint32_t reg0 = GetRegimeFirstBit(val);
-        if (reg0 == GetBit(val, Self::NumBits - 1 - regBits))
+        if constexpr (Specials == IEEE754_INF_NAN)
         {
-            regBits += 1;
+            return Construct(0, ExponentMask, IntegerBit | (Storage)1 << (NumFractionBits - 1));
         }
-        regBits -= 1;
+        return Specials == IEEE754_NAN_ONLY ? Construct(0, ExponentMask, MantissaMask) : Zero();
+    }
 
-        if (reg0 == 1)
+    static Storage SignalingNan()
+    {
+        if constexpr (Specials == IEEE754_INF_NAN && NumFractionBits >= 2)
         {
-            return regBits-1;
+            return Construct(0, ExponentMask, IntegerBit | (Storage)1 << (NumFractionBits - 2));
         }
         else
         {
-            return -regBits;
+            return QuietNan();
         }
     }
 
-    static int GetExponent(uint64_t val)
+    static Storage Epsilon()
     {
-        int numRegimeBits = NumRegimeBits(val);
-        return (GetBit(val, Self::NumBits - 2 - numRegimeBits) << 1) | GetBit(val, Self::NumBits - 3 - numRegimeBits);
+        // Subnormal when the mantissa is wider than the exponent range
+        if constexpr (ExponentForEpsilon > 0)
+        {
+            return Construct(0, ExponentForEpsilon, IntegerBit);
+        }
+        else
+        {
+            return Construct(0, 0, 1ull << (ExponentBias - 1));
+        }
     }
 
-    static uint64_t GetMantissa(uint64_t val)
+    static Storage DecrementMantissa(Storage val) { return Construct( GetSign(val), GetExponent(val),   GetMantissa(val)-1 ); }
+    static Storage IncrementMantissa(Storage val) { return Construct( GetSign(val), GetExponent(val),   GetMantissa(val)+1 ); }
+    static Storage DecrementExponent(Storage val) { return Construct( GetSign(val), GetExponent(val)-1, GetMantissa(val)   ); }
+    static Storage IncrementExponent(Storage val) { return Construct( GetSign(val), GetExponent(val)+1, GetMantissa(val)   ); }
+
+    static Storage Negate(Storage val)
     {
-        int mBits = NumMantissaBits(val);
-        uint64_t mask = (1ull << mBits) - 1;
-        return val & mask;
+        if (IsNanOrInf(val))
+        {
+            return val;
+        }
+        return Construct(1-GetSign(val), GetExponent(val), GetMantissa(val));
     }
 
-    static SimpleNumber GetValue(uint64_t val)
+    // Same value with the integer bit set exactly when the exponent is not zero. Only the x87
+    // pseudo-denormals and unnormals change, other encodings and types are returned as is.
+    static Storage Canonical(Storage val)
     {
-        int regime = GetRegime(val);
-        if (regime == -Self::NumBits+1)
+        if constexpr (ExplicitIntegerBit)
         {
-            return SimpleNumber();
+            Storage mantissa = GetMantissa(val);
+            int exponent = std::max((int)GetExponent(val), 1);
+            if (IsNanOrInf(val) || (mantissa & IntegerBit) == (Storage)(GetExponent(val) != 0) << (NumMantissaBits - 1))
+            {
+                return val;
+            }
+
+            // Shift the top set bit up to the integer bit, as far as the exponent allows
+            int leadingZeros = mantissa ? Clz(mantissa) - (int)(sizeof(Storage) * 8 - NumMantissaBits) : NumMantissaBits;
+            int shift = std::min(leadingZeros, exponent - 1);
+            mantissa <<= shift;
+            exponent -= shift;
+            return Construct(GetSign(val), (mantissa & IntegerBit) ? exponent : 0, mantissa);
         }
+        return val;
+    }
 
-        bool isPositive = (GetSignBit(val) == 0);
+    static int Clz(Storage val)
+    {
+        if constexpr (sizeof(Storage) > 8)
+        {
+            uint64_t hi = val >> 64;
+            return hi ? __builtin_clzll(hi) : 64 + __builtin_clzll((uint64_t)val);
+        }
+        return __builtin_clzll(val);
+    }
 
-        // implicit term can be 1 or -2, since bigint does not support negative numbers or substraction,
-        // if it is -2, compute it by complementing bigint and adding it to one
+    static Storage Next(Storage val)
+    {
+        val = Canonical(val);
+        Storage mantissa = GetMantissa(val);
+        uint64_t exponent = GetExponent(val);
+        uint64_t sign = GetSign(val);
 
-        SimpleNumber fractionTerm;
-        if (isPositive)
+        if (sign == 0)
         {
-            SimpleNumber fraction = SimpleNumber(GetMantissa(val)) * SimpleNumber::pow2(-NumMantissaBits(val));
-            fractionTerm = SimpleNumber::One() + fraction;
+            // Positive number, increment value
+            if (IsNanOrInf(val) || (Specials != IEEE754_INF_NAN && val == MaxFinite()))
+            {
+                return val; // no more room
+            }
+
+            if (mantissa == MantissaMask || mantissa == IntegerBit - 1)
+            {
+                // Into the next binade, for an explicit integer bit also from the subnormals
+                mantissa = IntegerBit;
+                exponent += 1;
+            }
+            else
+            {
+                mantissa += 1;
+            }
+
+            return Construct(sign, exponent, mantissa);
         }
         else
         {
-            uint64_t mantissa = GetMantissa(val);
-            if (mantissa == 0)
+            // Negative, if zero, set to positive zero, if inf set to -MaxFinite, else decrement
+
+            if (IsNanOrInf(val))
+            {
+                if (mantissa == IntegerBit) // Inf
+                {
+                    return Construct(1ull, ExponentMask-1, MantissaMask);
+                }
+                else
+                {
+                    return val; // NaN
+                }
+            }
+
+            if (exponent == 0 && mantissa == 0)
+            {
+                return Zero();
+            }
+
+            if (mantissa == IntegerBit)
             {
-                fractionTerm = SimpleNumber::Two();
+                mantissa = MantissaMask ^ (exponent == 1 ? IntegerBit : 0);
+                exponent--;
             }
             else
             {
-                int numMantissaBits = NumMantissaBits(val);
-                uint64_t mantissaComplement = ((~mantissa) + 1ull) & ((1ull << numMantissaBits) - 1);
-                SimpleNumber fraction = SimpleNumber(mantissaComplement) * SimpleNumber::pow2(-numMantissaBits);
-                fractionTerm = SimpleNumber::One() + fraction;
+                mantissa--;
             }
-        }
 
-        int p = (1 - 2 * (int)GetSignBit(val)) * (4 * GetRegime(val) + GetExponent(val) + (int)GetSignBit(val));
-        SimpleNumber powTerm = SimpleNumber::pow2(p);
-
-        SimpleNumber res = fractionTerm * powTerm;
-        res._isNegative = !isPositive;
-        return res;
+            return Construct(sign, exponent, mantissa);
+        }
     }
-};
-
-template <typename TraitsType>
-struct IEEE754FloatEditor : Editor {
 
-    using ReprType = IEEE754FloatRepresentation<TraitsType>;
+    static Storage Prev(Storage val)
+    {
+        val ^= ((Storage)SignMask << SignShift);
+        val = Next(val);
+        val ^= ((Storage)SignMask << SignShift);
+        return val;
+    }
 
-    static constexpr int NumBits = TraitsType::NumBits;
-    static constexpr int NumMantissaBits = TraitsType::NumMantissaBits;
-    static constexpr int NumExponentBits = TraitsType::NumExponentBits;
+    // Exponent of the ULP of a finite value, value is a multiple of 2 ** UlpExponent(val)
+    static constexpr int UlpExponent(Storage val)
+    {
+        return std::max((int)GetExponent(val), 1) - ExponentBias - NumFractionBits;
+    }
 
+    // +1 or -1 if magnitude of `to` is one ULP above or below `from` within the same binade, 0 otherwise
+    static int UlpStep(Storage from, Storage to)
+    {
+        if (IsNanOrInf(from) || GetSign(from) != GetSign(to) || GetExponent(from) != GetExponent(to))
+        {
+            return 0;
+        }
 
-    // "Final" form of float is (sign) A * 2 ** B
+        Storage mFrom = GetMantissa(from);
+        Storage mTo = GetMantissa(to);
+        if (mTo == mFrom + 1) return 1;
+        if (mTo + 1 == mFrom) return -1;
+        return 0;
+    }
 
-    std::string GetStringImpl(int code) const override
+    // Finite values are (-1)**sign * num * 2**exp, returns false for NaN and infinities
+    static constexpr bool GetScaledInteger(Storage val, Storage &num, int &exp)
     {
-        switch (code)
-        {
-        case {TMPL_IDENTIFIER_SIGN}: return std::to_string(ReprType::GetSign(_repr));
-        case {TMPL_IDENTIFIER_EXPONENT}: return std::to_string(ReprType::GetExponent(_repr));
-        case {TMPL_IDENTIFIER_EXPBIAS}: return std::to_string(ReprType::ExponentBias);
-        case {TMPL_IDENTIFIER_MANTISSA}: return std::to_string(ReprType::GetMantissa(_repr));
-        case {TMPL_IDENTIFIER_MBITS}: return std::to_string(NumMantissaBits);
-        case {TMPL_IDENTIFIER_NORMALIZED}:
+        if (IsNanOrInf(val))
         {
-            if (ReprType::IsNanOrInf(_repr)) return "N/A";
-            return ReprType::GetExponent(_repr) == 0 ? "0" : "1";
+            return false;
         }
-        case {TMPL_STRCODE_TYPENAME}: return TraitsType::TypeName;
-        case {TMPL_STRCODE_TYPENAME_LONG}: return TraitsType::TypeNameLong;
-        case {TMPL_STRCODE_BITSTRING}:  return ReprType::GetBitString(_repr);
-        case {TMPL_STRCODE_BYTES_PRETTY}: return ReprType::GetBytesPretty(_repr);
 
-        case {TMPL_STRCODE_EXACT_BASE10}:
-        case {TMPL_STRCODE_EXACT_BASE2}:
+        Storage implicitBit = (GetExponent(val) != 0) & !ExplicitIntegerBit;
+        num = GetMantissa(val) | (implicitBit << NumMantissaBits);
+        exp = UlpExponent(val);
+        return true;
+    }
+
+    static SimpleNumber GetValue(Storage val)
+    {
+        STATS_SCOPE(STATS_VALUE);
+        Storage num;
+        int exp;
+        if (!GetScaledInteger(val, num, exp))
         {
-            if (ReprType::IsNanOrInf(_repr))
-            {
-                if (ReprType::GetMantissa(_repr) == 0)
-                {
-                    return ReprType::GetSign(_repr) ? "-inf" : "inf";
-                }
+            return SimpleNumber(); // N/A
+        }
 
-                if (ReprType::GetMantissa(_repr) >> (ReprType::NumMantissaBits - 1))
-                {
-                    // when float is quiet nan with all other mantisa bits zero, and sign bit is set,
-                    // Microsoft (and clang as they seem to use same code for charconv) prints it as "nan(ind)"
-                    return "Quiet NaN";
-                }
-                else
-                {
-                    return "Signaling NaN";
-                }
-            }
+        SimpleNumber res = SimpleNumber::FromScaledInteger(num, exp);
+        res._isNegative = GetSign(val);
+        STATS_DIGITS(res._base10._store._digits.size());
+        return res;
+    }
 
-            constexpr uint32_t MaxDigitsAfterDot = ReprType::ExponentForULP1 - 1;
-            int digitsAfterDot = (ReprType::ExponentForULP1 - ReprType::GetExponent(_repr)) - (ReprType::GetExponent(_repr) == 0);
-            if (digitsAfterDot <= 0)
-            {
-                digitsAfterDot = 0;
-            }
-            // Nice thing is digitsAfterDot is same for both base2 and base10
+    // Position of the value in increasing order, consecutive values have consecutive ordinals and
+    // both zeros are 0. Infinities are the ends, NaNs are unordered and get NanOrdinal. Like the
+    // other uint64 APIs, only for the types that are stored in 64 bits without an integer bit.
+    static int64_t ToOrdinal(uint64_t val)
+    {
+        int64_t magnitude = val & ~(SignMask << SignShift);
+        int64_t neg = -(int64_t)GetSign(val);
+        int64_t ord = (magnitude ^ neg) - neg;
+        return magnitude > MaxOrdinal() ? NanOrdinal : ord;
+    }
 
-            if (code == {TMPL_STRCODE_EXACT_BASE10})
-            {
-                return _value.render10(digitsAfterDot);
-            }
-            else
-            {
-                return _value.render2(digitsAfterDot);
-            }
+    // Encoding at the ordinal, +0 for 0. Returns false if it is past the infinities.
+    static bool FromOrdinal(int64_t ord, uint64_t &val)
+    {
+        uint64_t magnitude = ord < 0 ? -(uint64_t)ord : ord;
+        if (magnitude > (uint64_t)MaxOrdinal())
+        {
+            return false;
         }
-        case {TMPL_STRCODE_URLHASH}: return "#"s + TraitsType::TypeName + "=" + ReprType::ToReprString(_repr);
-        case {TMPL_STRCODE_MATH}: return _math;
+        val = magnitude | (uint64_t)(ord < 0) << SignShift;
+        return true;
+    }
+
+    // Key that orders as IEEE 754 totalOrder when compared as an unsigned integer. Negative
+    // encodings have all their bits flipped and positive ones only the sign bit, so
+    // -NaN < -inf < -0 < +0 < +inf < +NaN, with NaNs of a sign in the order of their payloads.
+    static uint64_t ToTotalOrderKey(uint64_t val)
+    {
+        constexpr uint64_t Mask = ~0ull >> (64 - Self::NumBits);
+        return val ^ ((0 - (uint64_t)GetSign(val)) & Mask) ^ ((uint64_t)!GetSign(val) << SignShift);
+    }
+
+    static uint64_t FromTotalOrderKey(uint64_t key)
+    {
+        constexpr uint64_t Mask = ~0ull >> (64 - Self::NumBits);
+        uint64_t isPositive = (key >> SignShift) & 1;
+        return key ^ ((isPositive - 1) & Mask) ^ (isPositive << SignShift);
+    }
+
+    static int64_t MaxOrdinal() { return Specials == IEEE754_INF_NAN ? PositiveInfinity() : MaxFinite(); }
+    static uint64_t UnorderedValue() { return QuietNan(); }
+};
+
+template <typename TraitsType>
+struct PositRepresentation : CommonRepr<TraitsType>
+{
+    using Self = PositRepresentation<TraitsType>;
+
+    static constexpr int ExponentSize = TraitsType::ExponentSize;
+    using Codec = PositCodec<Self::NumBits, ExponentSize>;
+
+    static constexpr uint64_t BitMask = (~0ull) >> (sizeof(uint64_t)*8 - Self::NumBits);
+    static constexpr int MinRegime = Codec::MinRegime;
+    static constexpr int MaxRegime = Codec::MaxRegime;
+
+    static uint64_t Zero() { return 0; }
+    static uint64_t One() { return 1ull << (Self::NumBits - 2); }
+    static uint64_t MinPositive() { return 1; }
+    static uint64_t MaxFinite() { return BitMask >> 1; }
+    static uint64_t NaR() { return 1ull << (Self::NumBits - 1); }
+    static uint64_t Epsilon() { return Codec::PowerOfTwo(-(Self::NumBits - 3 - ExponentSize)); }
+
+    static uint64_t Next(uint64_t val) { return (val + 1) & BitMask; }
+    static uint64_t Prev(uint64_t val) { return (val - 1) & BitMask; }
+
+    static int ValueClass(uint64_t val)
+    {
+        if (val == NaR())
+        {
+            return {TMPL_VALUECLASS_NAR};
         }
-        return "error";
+        return val == Zero() ? {TMPL_VALUECLASS_ZERO} : {TMPL_VALUECLASS_NORMAL};
     }
 
-    int GetInt(int code) const override
+    // Number of encodings of a TMPL_VALUECLASS_*, all but zero and NaR are normal
+    static uint64_t CountClass(int cls)
     {
-        switch (code)
+        switch (cls)
         {
-            case {TMPL_BOOL_IS_IEEE754}:
-                return 1;
-            case {TMPL_BOOL_IS_ANY}:
-                return 1;
-            case {TMPL_BOOL_IS_POSIT}:
-                return 0;
-            case {TMPL_BOOL_IS_NORMAL}:
-                return ReprType::GetExponent(_repr) > 0 && !ReprType::IsNanOrInf(_repr);
-            case {TMPL_BOOL_IS_DENORMAL}:
-                return ReprType::GetExponent(_repr) == 0;
-            case {TMPL_BOOL_IS_FRACTION}:
-                return ReprType::GetExponent(_repr) < ReprType::ExponentForULP1;
-            case {TMPL_BOOL_IS_INTEGER}:
-                return ReprType::GetExponent(_repr) >= ReprType::ExponentForULP1;
-            case {TMPL_INT_BITTYPE_0} ... {TMPL_INT_BITTYPE_63}:
-            {
-                uint32_t bitIdx = code - {TMPL_INT_BITTYPE_0};
-                if (bitIdx < NumMantissaBits)
-                {
-                    return {TMPL_BITTYPE_MANTISSA};
-                }
+        case {TMPL_VALUECLASS_ZERO}:
+        case {TMPL_VALUECLASS_NAR}:    return 1;
+        case {TMPL_VALUECLASS_NORMAL}: return BitMask - 1;
+        }
+        return 0;
+    }
 
-                if (bitIdx < NumMantissaBits + NumExponentBits)
-                {
-                    return {TMPL_BITTYPE_EXPONENT};
-                }
+    static uint64_t Negate(uint64_t val)
+    {
+        if (val == NaR() || val == Zero())
+        {
+            return val;
+        }
 
-                if (bitIdx < NumMantissaBits + NumExponentBits + 1)
-                {
-                    return {TMPL_BITTYPE_SIGN};
-                }
+        return (0ull - val) & BitMask;
+    }
 
-                return {TMPL_BITTYPE_OOB};
-            }
+    static uint64_t DecrementRegime(uint64_t val)
+    {
+        int regime = GetRegime(val);
+        if (regime == MinRegime)
+        {
+            return val;
+        }
+        if (regime > 0)
+        {
+            return ((val << 1) & (BitMask >> 1)) | (GetSignBit(val) << (Self::NumBits - 1));
+        }
+        if (regime == 0)
+        {
+            return val ^ (3ull << (Self::NumBits - 3));
+        }
+        else
+        {
+            // regime < 0
+            return ((val >> 1) & (BitMask >> 2)) | (GetSignBit(val) << (Self::NumBits - 1));
         }
-        return -1;
     }
 
-    void SetValue(int code, const char *valstr) override
+    static uint64_t IncrementRegime(uint64_t val)
     {
-        ++_version;
-        switch (code)
+        int regime = GetRegime(val);
+        if (regime == MaxRegime)
         {
-            case {TMPL_SET_ZERO}:       _repr = ReprType::Zero();                 break;
-            case {TMPL_SET_ONE}:        _repr = ReprType::One();                    break;
-            case {TMPL_SET_INF}:        _repr = ReprType::PositiveInfinity(); break;
-            case {TMPL_SET_QNAN}:       _repr = ReprType::QuietNan(); break;
-            case {TMPL_SET_SNAN}:       _repr = ReprType::SignalingNan(); break;
-            case {TMPL_SET_MIN}:        _repr = ReprType::MinNormalized(); break;
-            case {TMPL_SET_MAX}:        _repr = ReprType::MaxFinite(); break;
-            case {TMPL_SET_EPS}:        _repr = ReprType::Epsilon();  break;
-            case {TMPL_SET_DENORM_MIN}: _repr = ReprType::MinDenormalized(); break;
-            case {TMPL_SET_NEGATE}:     _repr = ReprType::Negate(_repr); break;
-            case {TMPL_SET_PREV}:       _repr = ReprType::Prev(_repr); break;
-            case {TMPL_SET_NEXT}:       _repr = ReprType::Next(_repr); break;
-            case {TMPL_SET_MANTISSA_DECREMENT}: _repr = ReprType::DecrementMantissa(_repr); break;
-            case {TMPL_SET_MANTISSA_INCREMENT}: _repr = ReprType::IncrementMantissa(_repr); break;
-            case {TMPL_SET_EXPONENT_DECREMENT}: _repr = ReprType::DecrementExponent(_repr); break;
-            case {TMPL_SET_EXPONENT_INCREMENT}: _repr = ReprType::IncrementExponent(_repr); break;
-            case {TMPL_SET_BIT_FLIP_0} ... {TMPL_SET_BIT_FLIP_63}:
-            {
-                uint32_t bitIdx = code - {TMPL_SET_BIT_FLIP_0};
-                if (bitIdx < NumBits)
-                {
-                    _repr ^= (1ull << bitIdx);
-                }
-                break;
-            }
-            case {TMPL_SET_REPRSTR}: _repr = ReprType::FromReprString(valstr); break;
+            return val;
+        }
+        if (regime == MinRegime)
+        {
+            return val | 1ull;
+        }
+        if (regime >= 0)
+        {
+            return ((val >> 1) & (BitMask >> 2)) | (1ull << (Self::NumBits - 2))  | (GetSignBit(val) << (Self::NumBits - 1));
+        }
+        if (regime == -1)
+        {
+            return val ^ (3ull << (Self::NumBits - 3));
+        }
+        else
+        {
+            // regime < -1
+            return ((val << 1) & (BitMask >> 1)) | (GetSignBit(val) << (Self::NumBits - 1));
         }
+    }
 
-        recompute();
+    static uint64_t DecrementMantissa(uint64_t val)
+    {
+        int mb = NumMantissaBits(val);
+        return (val >> mb << mb) | ((val-1ull) & ((1ull << mb) - 1));
+    }
+    static uint64_t IncrementMantissa(uint64_t val)
+    {
+        int mb = NumMantissaBits(val);
+        return (val >> mb << mb) | ((val+1ull) & ((1ull << mb) - 1));
     }
 
-    void recompute()
+    static uint64_t DecrementExponent(uint64_t val) { return StepExponent(val, -1); }
+    static uint64_t IncrementExponent(uint64_t val) { return StepExponent(val, 1); }
+
+    // Steps the exponent bits that are in the encoding, wrapping around within them
+    static uint64_t StepExponent(uint64_t val, int step)
     {
-        _value = ReprType::GetValue(_repr);
+        PositFields f = Codec::Decode(val);
+        int eb = f.numExponentBits;
+        int mb = f.numFractionBits;
+        if (eb == 0) return val;
 
-        _math.clear();
+        uint64_t newexpo = ((f.exponent >> (ExponentSize - eb)) + step) & ((1ull << eb) - 1);
+        return (val >> (eb + mb) << (eb + mb)) | (newexpo << mb) | f.fraction;
+    }
 
-        if (ReprType::IsNanOrInf(_repr))
+
+
+
+    static uint64_t GetBit(uint64_t val, int bitIdx)
+    {
+        if (bitIdx < 0) return 0; // Implicit for exponent
+        return (val >> bitIdx) & 1ull;
+    }
+
+    static int NumRegimeBits(uint64_t val) { return Codec::Decode(val).numRegimeBits; }
+    static int NumExponentBits(uint64_t val) { return Codec::Decode(val).numExponentBits; }
+    static int NumMantissaBits(uint64_t val) { return Codec::Decode(val).numFractionBits; }
+
+    static uint64_t GetSignBit(uint64_t val)
+    {
+        return GetBit(val, Self::NumBits - 1);
+    }
+
+    static int GetRegime(uint64_t val) { return Codec::Decode(val).regime; }
+
+    // Exponent bits cut off by the end of the encoding are zero
+    static int GetExponent(uint64_t val) { return Codec::Decode(val).exponent; }
+
+    static uint64_t GetMantissa(uint64_t val) { return Codec::Decode(val).fraction; }
+
+    // Power of two of the implicit term, value is (1 - 3s + mantissa / 2**mbits) * 2 ** GetScale(val)
+    static int GetScale(uint64_t val)
+    {
+        return Codec::Scale(Codec::Decode(val));
+    }
+
+    // Exponent of the ULP of a real value, value is a multiple of 2 ** UlpExponent(val)
+    static int UlpExponent(uint64_t val)
+    {
+        return GetScale(val) - NumMantissaBits(val);
+    }
+
+    // +1 or -1 if magnitude of `to` is one ULP above or below `from` with the same regime and exponent, 0 otherwise
+    static int UlpStep(uint64_t from, uint64_t to)
+    {
+        if (from == NaR() || from == Zero() || to == NaR() || to == Zero())
         {
-            return;
+            return 0;
         }
-        else
+
+        int mb = NumMantissaBits(from);
+        if ((from >> mb) != (to >> mb) || NumMantissaBits(to) != mb)
         {
-            for (int rep = 0; rep <= 1; ++rep)
-            {
-
-                _math += "<math xmlns=\"http://www.w3.org/1998/Math/MathML\" display=\"block\">";
-                _math +=  "<mrow>";
-                _math +=    "<mi>value</mi>";
-                _math +=    "<mo>=</mo>";
-                _math +=    "<mrow>";
-                _math +=     "<msup>";
-                _math +=      "<mrow>";
-                _math +=       "<mo>(</mo>";
-                _math +=       "<mrow>";
-                _math +=        "<mrow>";
-                _math +=         "<mo>−</mo>";
-                _math +=         "<mn>1</mn>";
-                _math +=        "</mrow>";
-                _math +=       "</mrow>";
-                _math +=       "<mo>)</mo>";
-                _math +=      "</mrow>";
-                if (rep == 0) _math += "<mi class=\"identifier\" data-ic=\"{TMPL_IDENTIFIER_SIGN}\">sign</mi>";
-                else          _math += "<mn class=\"identifier\" data-ic=\"{TMPL_IDENTIFIER_SIGN}\">" + std::to_string(ReprType::GetSign(_repr)) + "</mn>";
-                _math +=     "</msup>";
-                _math +=     "<mo>×</mo>";
-                _math +=     "<msup>";
-                _math +=      "<mn>2</mn>";
-                _math +=      "<mrow>";
-                _math +=       "<mo>(</mo>";
-                _math +=       "<mrow>";
-                _math +=        "<mrow>";
-                if (rep == 0) _math += "<mi class=\"identifier\" data-ic=\"{TMPL_IDENTIFIER_EXPONENT}\">exponent</mi>";
-                else          _math += "<mn class=\"identifier\" data-ic=\"{TMPL_IDENTIFIER_EXPONENT}\">" + std::to_string(ReprType::GetExponent(_repr)) + "</mn>";
-                _math +=         "<mo>−</mo>";
-                if (rep == 0) _math += "<mi class=\"identifier\" data-ic=\"{TMPL_IDENTIFIER_EXPBIAS}\">expbias</mi>";
-                else          _math += "<mn class=\"identifier\" data-ic=\"{TMPL_IDENTIFIER_EXPBIAS}\">" + std::to_string(ReprType::ExponentBias) + "</mn>";
-                _math +=         "<mo>+</mo>";
-                _math +=         "<mn>1</mn>";
-                _math +=         "<mo>-</mo>";
-                if (rep == 0) _math += "<mi class=\"identifier\" data-ic=\"{TMPL_IDENTIFIER_NORMALIZED}\">N</mi>";
-                else          _math += "<mn class=\"identifier\" data-ic=\"{TMPL_IDENTIFIER_NORMALIZED}\">" + (ReprType::GetExponent(_repr) == 0 ? "0"s : "1"s) + "</mn>";
-                _math +=        "</mrow>";
-                _math +=       "</mrow>";
-                _math +=       "<mo>)</mo>";
-                _math +=      "</mrow>";
-                _math +=     "</msup>";
-                _math +=     "<mo>×</mo>";
-                _math +=     "<mrow>";
-                _math +=      "<mo>(</mo>";
-                _math +=      "<mrow>";
-                if (rep == 0) _math += "<mi class=\"identifier\" data-ic=\"{TMPL_IDENTIFIER_NORMALIZED}\">N</mi>";
-                else          _math += "<mn class=\"identifier\" data-ic=\"{TMPL_IDENTIFIER_NORMALIZED}\">" + (ReprType::GetExponent(_repr) == 0 ? "0"s : "1"s) + "</mn>";
-                _math +=       "<mo>+</mo>";
-                _math +=       "<mfrac>";
-                if (rep == 0) _math += "<mi class=\"identifier\" data-ic=\"{TMPL_IDENTIFIER_MANTISSA}\">mantissa</mi>";
-                else          _math += "<mn class=\"identifier\" data-ic=\"{TMPL_IDENTIFIER_MANTISSA}\">" + std::to_string(ReprType::GetMantissa(_repr)) + "</mn>";
-                _math +=        "<msup>";
-                _math +=         "<mn>2</mn>";
-                if (rep == 0) _math += "<mi class=\"identifier\" data-ic=\"{TMPL_IDENTIFIER_MBITS}\">mbits</mi>";
-                else          _math += "<mn class=\"identifier\" data-ic=\"{TMPL_IDENTIFIER_MBITS}\">" + std::to_string(ReprType::NumMantissaBits) + "</mn>";
-                _math +=        "</msup>";
-                _math +=       "</mfrac>";
-                _math +=      "</mrow>";
-                _math +=      "<mo>)</mo>";
-                _math +=     "</mrow>";
-                _math +=    "</mrow>";
-                _math +=   "</mrow>";
-                _math += "</math>";
-            }
-
+            return 0;
+        }
 
-            bool isNeg = ReprType::GetSign(_repr);
+        // For negative numbers the mantissa is subtracted from the implicit term
+        int dir = GetSignBit(from) ? -1 : 1;
+        if (GetMantissa(to) == GetMantissa(from) + 1) return dir;
+        if (GetMantissa(to) + 1 == GetMantissa(from)) return -dir;
+        return 0;
+    }
 
-            SimpleNumber finalEqInt(ReprType::GetMantissa(_repr));
-            if (ReprType::GetExponent(_repr) != 0)
-            {
-                finalEqInt = finalEqInt + SimpleNumber::pow2(NumMantissaBits);
-            }
+    // Real values are num * 2**exp with the sign of the sign bit, returns false for zero and NaR
+    static bool GetScaledInteger(uint64_t val, uint64_t &num, int &exp)
+    {
+        if (val == Zero() || val == NaR())
+        {
+            return false;
+        }
 
-            int finalEqExp = ((int)ReprType::GetExponent(_repr) - ReprType::ExponentBias - (int)NumMantissaBits + (ReprType::GetExponent(_repr) == 0));
+        // implicit term is 1 for positive numbers and -2 for negative numbers
+        int64_t implicitTerm = GetSignBit(val) ? -2 : 1;
+        int64_t top = (int64_t)GetMantissa(val) + implicitTerm * (1ll << NumMantissaBits(val));
+        num = (top < 0 ? -top : top);
+        exp = UlpExponent(val);
+        return true;
+    }
 
-            SimpleNumber finalEqDenom;
-            if (finalEqExp < 0)
-            {
-                finalEqDenom = SimpleNumber::pow2(-finalEqExp);
-            }
+    static SimpleNumber GetValue(uint64_t val)
+    {
+        STATS_SCOPE(STATS_VALUE);
+        uint64_t num;
+        int exp;
+        if (!GetScaledInteger(val, num, exp))
+        {
+            return SimpleNumber();
+        }
 
+        SimpleNumber res = SimpleNumber::FromScaledInteger(num, exp);
+        res._isNegative = GetSignBit(val);
+        STATS_DIGITS(res._base10._store._digits.size());
+        return res;
+    }
 
-            _math += "<math xmlns=\"http://www.w3.org/1998/Math/MathML\" display=\"block\">";
-            _math +=  "<mrow>";
-            _math +=    "<mo>=</mo>";
-            if (isNeg) _math += "<mo>-</mo>";
-            _math +=    "<mn>" + finalEqInt.render10() + "</mn>";
-            _math +=    "<mo>×</mo>";
-            _math +=    "<msup>";
-            _math +=     "<mn>2</mn>";
-            _math +=     "<mn>" + std::to_string(finalEqExp) + "</mn>";
-            _math +=    "</msup>";
-            _math +=  "</mrow>";
-            _math += "</math>";
+    // Posits are ordered as two's complement integers, the ordinal is the sign extended encoding.
+    // NaR is unordered and gets NanOrdinal.
+    static int64_t ToOrdinal(uint64_t val)
+    {
+        constexpr int Shift = 64 - Self::NumBits;
+        int64_t ord = (int64_t)(val << Shift) >> Shift;
+        return val == NaR() ? NanOrdinal : ord;
+    }
 
-            if (finalEqExp < 0)
-            {
-                _math += "<math xmlns=\"http://www.w3.org/1998/Math/MathML\" display=\"block\">";
-                _math +=  "<mrow>";
-                _math +=   "<mo>=</mo>";
-                if (isNeg) _math += "<mo>-</mo>";
-                _math +=   "<mfrac>";
-                _math +=    "<mn>" + finalEqInt.render10() + "</mn>";
-                _math +=    "<mn>" + finalEqDenom.render10() + "</mn>";
-                _math +=   "</mfrac>";
-                _math +=  "</mrow>";
-                _math += "</math>";
-            }
+    // Encoding at the ordinal. Returns false if it is past the largest magnitude.
+    static bool FromOrdinal(int64_t ord, uint64_t &val)
+    {
+        if (ord < -MaxOrdinal() || ord > MaxOrdinal())
+        {
+            return false;
         }
+        val = ord & BitMask;
+        return true;
     }
 
-    uint64_t _repr;
-    SimpleNumber _value;
-    std::string _math;
+    static int64_t MaxOrdinal() { return MaxFinite(); }
+    static uint64_t UnorderedValue() { return NaR(); }
+
+    // Key that orders as the posits when compared as an unsigned integer, the encoding with the
+    // sign bit flipped. NaR is below all the other values, as the standard orders it.
+    static uint64_t ToTotalOrderKey(uint64_t val) { return val ^ NaR(); }
+    static uint64_t FromTotalOrderKey(uint64_t key) { return key ^ NaR(); }
 };
 
+// Decimal encodings, value is (-1)**sign * coefficient * 10**(exponent - Bias). A value has a
+// cohort of encodings with different exponents, Next and Prev step between values, not encodings.
 template <typename TraitsType>
-struct PositEditor : Editor
+struct DecimalRepresentation : CommonRepr<TraitsType>
 {
-    using ReprType = PositRepresentation<TraitsType>;
+    using Self = DecimalRepresentation<TraitsType>;
+    using Codec = DecimalCodec<TraitsType::NumBits, TraitsType::IsDpd>;
+    using Storage = typename Codec::Storage;
+    using Fields = typename Codec::Fields;
+
+    static constexpr int Precision = Codec::Precision;
+    static constexpr int Bias = Codec::Bias;
+    static constexpr int MaxBiasedExponent = Codec::MaxBiasedExponent;
+    static constexpr Storage MaxCoefficient = Codec::MaxCoefficient;
+    static constexpr Storage MinNormalCoefficient = Codec::Pow10(Precision - 1);
+
+    static Storage Finite(bool sign, int exponent, Storage coefficient)
+    {
+        return Codec::Encode(Fields{ Codec::Finite, sign, exponent, coefficient });
+    }
 
-    static constexpr int NumBits = TraitsType::NumBits;
+    static Storage Zero() { return Finite(false, Bias, 0); }
+    static Storage One() { return Finite(false, Bias, 1); }
+    static Storage MaxFinite() { return Finite(false, MaxBiasedExponent, MaxCoefficient); }
+    static Storage MinNormal() { return Finite(false, 0, MinNormalCoefficient); }
+    static Storage MinSubnormal() { return Finite(false, 0, 1); }
+    static Storage Epsilon() { return Finite(false, Bias - (Precision - 1), 1); }
+    static Storage PositiveInfinity() { return Codec::Encode(Fields{ Codec::Infinite, false, 0, 0 }); }
+    static Storage QuietNan() { return Codec::Encode(Fields{ Codec::QuietNaN, false, 0, 0 }); }
+    static Storage SignalingNan() { return Codec::Encode(Fields{ Codec::SignalingNaN, false, 0, 0 }); }
 
-    std::string GetStringImpl(int code) const override
+    static Fields GetValue(Storage val) { return Codec::Decode(val); }
+
+    static bool GetSign(Storage val) { return (val >> (Self::NumBits - 1)) & 1; }
+
+    static Storage Negate(Storage val) { return val ^ ((Storage)1 << (Self::NumBits - 1)); }
+
+    // Member of the cohort with the smallest exponent, where a step of the coefficient is the
+    // smallest step of the value
+    static void Normalize(Fields &f)
     {
-        switch (code)
+        while (f.coefficient < MinNormalCoefficient && f.exponent > 0)
         {
-        case {TMPL_IDENTIFIER_SIGN}: return std::to_string(ReprType::GetSignBit(_repr));
-        case {TMPL_IDENTIFIER_EXPONENT}: return std::to_string(ReprType::GetExponent(_repr));
-        case {TMPL_IDENTIFIER_MANTISSA}: return std::to_string(ReprType::GetMantissa(_repr));
-        case {TMPL_IDENTIFIER_MBITS}: return std::to_string(ReprType::NumMantissaBits(_repr));
-        case {TMPL_IDENTIFIER_REGIME}:
+            f.coefficient *= 10;
+            --f.exponent;
+        }
+    }
+
+    // Next value away from zero, infinity past the largest
+    static void IncrementMagnitude(Fields &f)
+    {
+        Normalize(f);
+        if (++f.coefficient > MaxCoefficient)
         {
-            int regime = ReprType::GetRegime(_repr);
-            if (regime == -(NumBits - 1))
+            f.coefficient = MinNormalCoefficient;
+            if (++f.exponent > MaxBiasedExponent)
             {
-                // Display regime as -inf as described here: https://groups.google.com/g/unum-computing/c/BQ6ieoky5TU/m/tnHG7wQ2BQAJ
-                return "&minus;&infin;";
+                f.kind = Codec::Infinite;
             }
-            return std::to_string(regime);
         }
+    }
 
-        case {TMPL_STRCODE_BITSTRING}:  return ReprType::GetBitString(_repr);
-        case {TMPL_STRCODE_BYTES_PRETTY}: return ReprType::GetBytesPretty(_repr);
-        case {TMPL_STRCODE_URLHASH}: return "#"s + TraitsType::TypeName + "=" + ReprType::ToReprString(_repr);
-        case {TMPL_STRCODE_TYPENAME}: return TraitsType::TypeName;
-        case {TMPL_STRCODE_TYPENAME_LONG}: return TraitsType::TypeNameLong;
-        case {TMPL_STRCODE_EXACT_BASE10}:
-        case {TMPL_STRCODE_EXACT_BASE2}:
+    // Next value towards zero, f needs to be non-zero
+    static void DecrementMagnitude(Fields &f)
+    {
+        Normalize(f);
+        if (f.coefficient == MinNormalCoefficient && f.exponent > 0)
         {
-            if (_repr == (1ull << (NumBits - 1))) return "NaR";
+            f.coefficient = MaxCoefficient;
+            --f.exponent;
+        }
+        else
+        {
+            --f.coefficient;
+        }
+    }
 
-            int sign = ReprType::GetSignBit(_repr);
-            int mbits = ReprType::NumMantissaBits(_repr);
-            int p = (1-2*sign) * (4*ReprType::GetRegime(_repr) + ReprType::GetExponent(_repr) + sign) - mbits;
-            int digitsAfterDot = -p;
-            if (digitsAfterDot <= 0)
-            {
-                digitsAfterDot = 0;
-            }
+    // nextUp of IEEE 754, NaNs and +inf stay the same
+    static Storage Next(Storage val)
+    {
+        Fields f = Codec::Decode(val);
+        if (f.kind == Codec::QuietNaN || f.kind == Codec::SignalingNaN || (f.kind == Codec::Infinite && !f.sign))
+        {
+            return val;
+        }
+        if (f.kind == Codec::Infinite)
+        {
+            return Negate(MaxFinite());
+        }
+        if (f.coefficient == 0)
+        {
+            return MinSubnormal();
+        }
 
-            if (code == {TMPL_STRCODE_EXACT_BASE10})
-            {
-                return _value.render10(digitsAfterDot);
-            }
-            else
-            {
-                return _value.render2(digitsAfterDot);
-            }
+        if (f.sign)
+        {
+            DecrementMagnitude(f);
         }
-        case {TMPL_STRCODE_MATH}: return _math;
+        else
+        {
+            IncrementMagnitude(f);
         }
+        return Codec::Encode(f);
+    }
 
-        return "error";
+    static Storage Prev(Storage val) { return Negate(Next(Negate(val))); }
+
+    static Storage DecrementMantissa(Storage val) { return StepField(val, 0, -1); }
+    static Storage IncrementMantissa(Storage val) { return StepField(val, 0, 1); }
+    static Storage DecrementExponent(Storage val) { return StepField(val, -1, 0); }
+    static Storage IncrementExponent(Storage val) { return StepField(val, 1, 0); }
+
+    // Steps the exponent or the coefficient of a finite value, stopping at the ends of their ranges
+    static Storage StepField(Storage val, int exponentStep, int coefficientStep)
+    {
+        Fields f = Codec::Decode(val);
+        if (f.kind != Codec::Finite)
+        {
+            return val;
+        }
+        int exponent = f.exponent + exponentStep;
+        if (exponent >= 0 && exponent <= MaxBiasedExponent)
+        {
+            f.exponent = exponent;
+        }
+        if ((coefficientStep < 0 && f.coefficient > 0) || (coefficientStep > 0 && f.coefficient < MaxCoefficient))
+        {
+            f.coefficient += coefficientStep;
+        }
+        return Codec::Encode(f);
     }
 
-    int GetInt(int code) const override
+    static int ValueClass(Storage val) { return ValueClass(Codec::Decode(val)); }
+
+    // Subnormals are below 10**emin, which is the smallest value with all Precision digits at
+    // exponent 0
+    static int ValueClass(const Fields &f)
     {
-        switch (code)
+        switch (f.kind)
         {
-            case {TMPL_BOOL_IS_IEEE754}:
-                return 0;
-            case {TMPL_BOOL_IS_ANY}:
-                return 1;
-            case {TMPL_BOOL_IS_POSIT}:
-                return 1;
-            case {TMPL_INT_BITTYPE_0} ... {TMPL_INT_BITTYPE_63}:
-            {
-                uint32_t bitIdx = code - {TMPL_INT_BITTYPE_0};
-                if (bitIdx >= NumBits)
-                {
-                    return {TMPL_BITTYPE_OOB};
-                }
+        case Codec::Infinite: return {TMPL_VALUECLASS_INFINITE};
+        case Codec::QuietNaN:
+        case Codec::SignalingNaN: return {TMPL_VALUECLASS_NAN};
+        default: break;
+        }
+        if (f.coefficient == 0)
+        {
+            return {TMPL_VALUECLASS_ZERO};
+        }
+        bool isSubnormal = f.exponent < Precision - 1 && f.coefficient < Codec::PowersOf10.values[Precision - 1 - f.exponent];
+        return isSubnormal ? {TMPL_VALUECLASS_SUBNORMAL} : {TMPL_VALUECLASS_NORMAL};
+    }
+};
 
-                if (bitIdx == NumBits - 1)
-                {
-                    return {TMPL_BITTYPE_SIGN};
-                }
+#include "SoftFloat.cpp"
+#include "Quire.cpp"
+#include "MathTables.cpp"
+#include "Mx.cpp"
+#include "Expression.cpp"
 
-                int numRegimeBits = ReprType::NumRegimeBits(_repr);
+// Nearest double, which is infinite or zero past its range
+inline double UnpackedToDouble(const Unpacked &u)
+{
+    switch (u.kind)
+    {
+        case Unpacked::NaN: return NAN;
+        case Unpacked::Infinite: return u.sign ? -INFINITY : INFINITY;
+        case Unpacked::Zero: return u.sign ? -0.0 : 0.0;
+        case Unpacked::Finite: break;
+    }
+    double mag = ldexp((double)u.sig, u.exp);
+    return u.sign ? -mag : mag;
+}
 
-                if (bitIdx >= NumBits - 1 - numRegimeBits)
-                {
-                    return {TMPL_BITTYPE_REGIME};
-                }
+// |b - a| / |a|; infinite when a is zero and b is not, or b is infinite, and NaN when either
+// is NaN or a is infinite
+inline double UnpackedRelativeError(const Unpacked &a, const Unpacked &b)
+{
+    if (a.kind == Unpacked::NaN || b.kind == Unpacked::NaN || a.kind == Unpacked::Infinite)
+    {
+        return NAN;
+    }
+    if (b.kind == Unpacked::Infinite)
+    {
+        return INFINITY;
+    }
+    if (a.kind == Unpacked::Zero)
+    {
+        return b.kind == Unpacked::Zero ? 0.0 : INFINITY;
+    }
+    if (b.kind == Unpacked::Zero)
+    {
+        return 1.0;
+    }
 
-                if ((int)bitIdx >= (int)NumBits - 1 - (int)numRegimeBits - 2)
-                {
-                    return {TMPL_BITTYPE_EXPONENT};
-                }
+    // Significands have at most 65 bits, so when the exponents are close both fit in 128 bits
+    // at the smaller exponent and the difference is exact
+    int gap = b.exp - a.exp;
+    if (gap >= -60 && gap <= 60)
+    {
+        uint128 sa = gap < 0 ? a.sig << -gap : a.sig;
+        uint128 sb = gap > 0 ? b.sig << gap : b.sig;
+        uint128 diff = a.sign != b.sign ? sa + sb : (sa > sb ? sa - sb : sb - sa);
+        return (double)diff / (double)sa;
+    }
 
-                return {TMPL_BITTYPE_MANTISSA};
-            }
+    // Otherwise the smaller one is lost next to the bigger one
+    double ratio = ldexp((double)b.sig / (double)a.sig, gap);
+    return gap > 0 ? ratio : (a.sign != b.sign ? 1.0 + ratio : 1.0 - ratio);
+}
+
+// The effect of every single-bit error of an encoding: the flipped encodings, their values, their
+// errors relative to the original value and their classes (TMPL_VALUECLASS_*). The original is
+// decoded once and the flips are derived from it or unpacked without any bigint work, so whole
+// arrays can be swept.
+template <typename ReprType>
+struct BitFlips
+{
+    using Format = SoftFloatFormat<ReprType>;
+    static constexpr int NumBits = ReprType::NumBits;
+
+    // Outputs have NumBits entries, for the flips of bit 0 up
+    static void Compute(uint64_t val, uint64_t *reprs, double *values, double *relErrors, int *classes)
+    {
+        Unpacked base = Format::Unpack(val);
+        for (int bit = 0; bit < NumBits; ++bit)
+        {
+            uint64_t flipped = val ^ (uint64_t(1) << bit);
+            Unpacked u = Format::UnpackFlip(val, base, bit);
+            reprs[bit] = flipped;
+            values[bit] = UnpackedToDouble(u);
+            relErrors[bit] = UnpackedRelativeError(base, u);
+            classes[bit] = ReprType::ValueClass(flipped);
         }
-        return -1;
     }
 
-    void SetValue(int code, const char *valstr) override
+    // Outputs have n * NumBits entries
+    static void Compute(const uint64_t *vals, size_t n, uint64_t *reprs, double *values, double *relErrors, int *classes)
     {
-        ++_version;
-        switch (code)
+        for (size_t i = 0; i < n; ++i)
         {
-            case {TMPL_SET_ZERO}:       _repr = ReprType::Zero(); break;
-            case {TMPL_SET_ONE}:        _repr = ReprType::One(); break;
-            case {TMPL_SET_MIN}:        _repr = ReprType::MinPositive(); break;
-            case {TMPL_SET_MAX}:        _repr = ReprType::MaxFinite(); break;
-            case {TMPL_SET_NAR}:        _repr = ReprType::NaR(); break;
-            case {TMPL_SET_NEGATE}:     _repr = ReprType::Negate(_repr); break;
-            case {TMPL_SET_PREV}:       _repr = ReprType::Prev(_repr); break;
-            case {TMPL_SET_NEXT}:       _repr = ReprType::Next(_repr); break;
-            case {TMPL_SET_EPS}:        _repr = ReprType::Epsilon();  break;
-            case {TMPL_SET_BIT_FLIP_0} ... {TMPL_SET_BIT_FLIP_63}:
-            {
-                uint32_t bitIdx = code - {TMPL_SET_BIT_FLIP_0};
+            size_t offset = i * NumBits;
+            Compute(vals[i], reprs + offset, values + offset, relErrors + offset, classes + offset);
+        }
+    }
+};
+
+// |a| compared with |b|, for finite non-zero values
+inline int CompareMagnitude(Unpacked a, Unpacked b)
+{
+    NormalizeTo(a, 126);
+    NormalizeTo(b, 126);
+    if (a.exp != b.exp)
+    {
+        return a.exp < b.exp ? -1 : 1;
+    }
+    return a.sig < b.sig ? -1 : (a.sig > b.sig ? 1 : 0);
+}
+
+// a compared with b, for values that are not NaN
+inline int CompareValues(const Unpacked &a, const Unpacked &b)
+{
+    auto rank = [](const Unpacked &u)
+    {
+        int magnitude = u.kind == Unpacked::Zero ? 0 : (u.kind == Unpacked::Infinite ? 2 : 1);
+        return u.sign ? -magnitude : magnitude;
+    };
+    if (rank(a) != rank(b))
+    {
+        return rank(a) < rank(b) ? -1 : 1;
+    }
+    if (a.kind != Unpacked::Finite)
+    {
+        return 0;
+    }
+    int res = CompareMagnitude(a, b);
+    return a.sign ? -res : res;
+}
+
+// Counts of the values of a type that would otherwise take enumerating them with Next. The classes
+// come from the layout of the encodings, and the rest from binary searches over the ordinals, as
+// both the values and their ULPs grow with the ordinal, so each query is O(1) or O(bits) even for
+// binary64 and posit64.
+template <typename ReprType>
+struct ValueCounts
+{
+    using Format = SoftFloatFormat<ReprType>;
+
+    // Number of encodings of each TMPL_VALUECLASS_*, counts needs TMPL_VALUECLASS_MAX entries
+    static void ClassCounts(uint64_t *counts)
+    {
+        for (int cls = 0; cls < {TMPL_VALUECLASS_MAX}; ++cls)
+        {
+            counts[cls] = ReprType::CountClass(cls);
+        }
+    }
+
+    // Number of encodings whose value is an integer, with both zeros of the IEEE types. All integers
+    // below the first value whose ULP is at least 1 have encodings, and all values from it up are
+    // integers.
+    static uint64_t NumIntegers()
+    {
+        uint64_t first = FirstOrdinalWithUlp(0);
+        uint64_t numPositive = first > MaxFiniteOrdinal()
+            ? FloorValue(MaxFiniteOrdinal())
+            : FloorValue(first) - 1 + (MaxFiniteOrdinal() - first + 1);
+        return 2 * numPositive + ReprType::CountClass({TMPL_VALUECLASS_ZERO});
+    }
+
+    // Largest N such that every integer in [0, N] has an encoding, the first value whose ULP is at
+    // least 2 when there is one
+    static uint64_t MaxContiguousInteger()
+    {
+        return FloorValue(std::min(FirstOrdinalWithUlp(1), MaxFiniteOrdinal()));
+    }
+
+    // Number of distinct values in [lo, hi), zeros are one value and infinities are values.
+    // 0 if either is NaN.
+    static uint64_t CountBetween(const Unpacked &lo, const Unpacked &hi)
+    {
+        if (lo.kind == Unpacked::NaN || hi.kind == Unpacked::NaN)
+        {
+            return 0;
+        }
+        uint64_t numBelowLo = CountBelow(lo);
+        uint64_t numBelowHi = CountBelow(hi);
+        return numBelowHi > numBelowLo ? numBelowHi - numBelowLo : 0;
+    }
+
+    // Number of values below x. The ordinals of the 64-bit types span more than int64, so the
+    // search is over the ordinals plus MaxOrdinal().
+    static uint64_t CountBelow(const Unpacked &x)
+    {
+        uint64_t lo = 0;
+        uint64_t hi = 2 * (uint64_t)ReprType::MaxOrdinal() + 1;
+        while (lo < hi)
+        {
+            uint64_t mid = lo + (hi - lo) / 2;
+            if (CompareValues(UnpackOrdinal((int64_t)(mid - ReprType::MaxOrdinal())), x) >= 0)
+            {
+                hi = mid;
+            }
+            else
+            {
+                lo = mid + 1;
+            }
+        }
+        return lo;
+    }
+
+    // First positive ordinal whose value has a ULP of at least 2**ulpExp, past MaxFiniteOrdinal()
+    // if there is none
+    static uint64_t FirstOrdinalWithUlp(int ulpExp)
+    {
+        uint64_t lo = 1;
+        uint64_t hi = MaxFiniteOrdinal() + 1;
+        while (lo < hi)
+        {
+            uint64_t mid = lo + (hi - lo) / 2;
+            uint64_t val = 0;
+            ReprType::FromOrdinal(mid, val);
+            if (ReprType::UlpExponent(val) >= ulpExp)
+            {
+                hi = mid;
+            }
+            else
+            {
+                lo = mid + 1;
+            }
+        }
+        return lo;
+    }
+
+    static uint64_t MaxFiniteOrdinal()
+    {
+        return ReprType::ToOrdinal(ReprType::MaxFinite());
+    }
+
+    // Integer part of the positive value at the ordinal
+    static uint64_t FloorValue(uint64_t ord)
+    {
+        uint64_t val = 0;
+        ReprType::FromOrdinal(ord, val);
+        uint64_t num = 0;
+        int exp = 0;
+        ReprType::GetScaledInteger(val, num, exp);
+        return exp >= 0 ? num << exp : (exp > -64 ? num >> -exp : 0);
+    }
+
+    static Unpacked UnpackOrdinal(int64_t ord)
+    {
+        uint64_t val = 0;
+        ReprType::FromOrdinal(ord, val);
+        return Format::Unpack(val);
+    }
+};
+
+// Conversion of a value to a type, rounded once from its sign, exponent and significand, so a
+// value can be shown in every type as it changes. Values come from the editors, with significands
+// of up to 127 bits.
+template <typename ReprType>
+struct Conversion
+{
+    using Format = SoftFloatFormat<ReprType>;
+
+    static void Convert(const Unpacked &value, RoundingMode mode, uint64_t &repr, double &approx, int &status, double &relError)
+    {
+        repr = Format::Round(value, mode);
+        Unpacked res = Format::Unpack(repr);
+        approx = UnpackedToDouble(res);
+        status = Status(value, res);
+
+        // The relative error only needs the leading bits of the value
+        Unpacked narrowed = value;
+        if (value.kind == Unpacked::Finite && Msb(value.sig) > 63)
+        {
+            NormalizeTo(narrowed, 63);
+        }
+        relError = UnpackedRelativeError(narrowed, res);
+    }
+
+    // TMPL_CONVERT_* of converting value to res. Overflow and underflow are for magnitudes past the
+    // largest finite and the smallest non-zero ones, whatever they were rounded to.
+    static int Status(const Unpacked &value, const Unpacked &res)
+    {
+        switch (value.kind)
+        {
+            case Unpacked::NaN: return {TMPL_CONVERT_NAN};
+            case Unpacked::Zero: return {TMPL_CONVERT_EXACT};
+            case Unpacked::Infinite:
+                if (res.kind == Unpacked::Infinite) return {TMPL_CONVERT_EXACT};
+                return res.kind == Unpacked::NaN ? {TMPL_CONVERT_NAN} : {TMPL_CONVERT_OVERFLOW};
+            case Unpacked::Finite: break;
+        }
+
+        uint64_t minPositive = 0;
+        ReprType::FromOrdinal(1, minPositive);
+        if (CompareMagnitude(value, Format::Unpack(ReprType::MaxFinite())) > 0)
+        {
+            return {TMPL_CONVERT_OVERFLOW};
+        }
+        if (CompareMagnitude(value, Format::Unpack(minPositive)) < 0)
+        {
+            return {TMPL_CONVERT_UNDERFLOW};
+        }
+        bool isExact = res.kind == Unpacked::Finite && res.sign == value.sign && CompareMagnitude(value, res) == 0;
+        return isExact ? {TMPL_CONVERT_EXACT} : {TMPL_CONVERT_INEXACT};
+    }
+};
+
+template <typename TraitsType>
+struct IEEE754FloatEditor : Editor {
+
+    using ReprType = IEEE754FloatRepresentation<TraitsType>;
+    using Storage = typename ReprType::Storage;
+
+    static constexpr int NumBits = TraitsType::NumBits;
+    static constexpr int NumMantissaBits = TraitsType::NumMantissaBits;
+    static constexpr int NumExponentBits = TraitsType::NumExponentBits;
+
+
+    // "Final" form of float is (sign) A * 2 ** B
+
+    // Renders the first encoding, zero, which needs no job, so that a new editor and undoing back
+    // to it show its strings
+    IEEE754FloatEditor()
+    {
+        finishValue();
+    }
+
+    std::string GetStringImpl(int code) const override
+    {
+        switch (code)
+        {
+        case {TMPL_IDENTIFIER_SIGN}: return std::to_string(ReprType::GetSign(_repr));
+        case {TMPL_IDENTIFIER_EXPONENT}: return std::to_string(ReprType::GetExponent(_repr));
+        case {TMPL_IDENTIFIER_EXPBIAS}: return std::to_string(ReprType::ExponentBias);
+        case {TMPL_IDENTIFIER_MANTISSA}: return UintToString(ReprType::GetMantissa(_repr));
+        case {TMPL_IDENTIFIER_MBITS}: return std::to_string(NumMantissaBits);
+        case {TMPL_IDENTIFIER_NORMALIZED}:
+        {
+            if (ReprType::IsNanOrInf(_repr)) return "N/A";
+            return ReprType::GetExponent(_repr) == 0 ? "0" : "1";
+        }
+        case {TMPL_STRCODE_TYPENAME}: return TraitsType::TypeName;
+        case {TMPL_STRCODE_TYPENAME_LONG}: return TraitsType::TypeNameLong;
+        case {TMPL_STRCODE_BITSTRING}:  return ReprType::GetBitString(_repr);
+        case {TMPL_STRCODE_BYTES_PRETTY}: return ReprType::GetBytesPretty(_repr);
+
+        case {TMPL_STRCODE_EXACT_BASE10}:
+        case {TMPL_STRCODE_EXACT_BASE2}:
+        case {TMPL_STRCODE_SCIENTIFIC}:
+        case {TMPL_STRCODE_HEXFLOAT}:
+        {
+            if (ReprType::IsNanOrInf(_repr))
+            {
+                if (ReprType::Specials == IEEE754_NAN_ONLY)
+                {
+                    return "NaN";
+                }
+
+                if (ReprType::GetMantissa(_repr) == ReprType::IntegerBit)
+                {
+                    return ReprType::GetSign(_repr) ? "-inf" : "inf";
+                }
+
+                if (ReprType::ExplicitIntegerBit && !(ReprType::GetMantissa(_repr) & ReprType::IntegerBit))
+                {
+                    return ReprType::GetMantissa(_repr) ? "Pseudo-NaN" : "Pseudo-infinity";
+                }
+
+                if ((ReprType::GetMantissa(_repr) >> (ReprType::NumFractionBits - 1)) & 1)
+                {
+                    // when float is quiet nan with all other mantisa bits zero, and sign bit is set,
+                    // Microsoft (and clang as they seem to use same code for charconv) prints it as "nan(ind)"
+                    return "Quiet NaN";
+                }
+                else
+                {
+                    return "Signaling NaN";
+                }
+            }
+
+            if (code == {TMPL_STRCODE_SCIENTIFIC} || code == {TMPL_STRCODE_HEXFLOAT})
+            {
+                Storage num;
+                int exp;
+                ReprType::GetScaledInteger(_repr, num, exp);
+                return RenderFixedPrecision(code, ReprType::GetSign(_repr), num, exp, _precision);
+            }
+
+            if (_job._isActive)
+            {
+                return "…";
+            }
+
+            return (code == {TMPL_STRCODE_EXACT_BASE10} ? _exact10 : _exact2);
+        }
+        case {TMPL_STRCODE_URLHASH}: return "#"s + TraitsType::TypeName + "=" + ReprType::ToReprString(_repr);
+        case {TMPL_STRCODE_MATH}: return _math;
+        }
+        return "error";
+    }
+
+    int GetInt(int code) const override
+    {
+        switch (code)
+        {
+            case {TMPL_BOOL_IS_IEEE754}:
+                return 1;
+            case {TMPL_BOOL_IS_ANY}:
+                return 1;
+            case {TMPL_BOOL_IS_COMPUTING}:
+                return _job._isActive;
+            case {TMPL_BOOL_CAN_UNDO}:
+                return _history.CanUndo();
+            case {TMPL_BOOL_CAN_REDO}:
+                return _history.CanRedo();
+            case {TMPL_BOOL_IS_POSIT}:
+                return 0;
+            case {TMPL_BOOL_IS_NORMAL}:
+                return ReprType::GetExponent(_repr) > 0 && !ReprType::IsNanOrInf(_repr);
+            case {TMPL_BOOL_IS_DENORMAL}:
+                return ReprType::GetExponent(_repr) == 0;
+            case {TMPL_BOOL_IS_FRACTION}:
+                return ReprType::GetExponent(_repr) < ReprType::ExponentForULP1;
+            case {TMPL_BOOL_IS_INTEGER}:
+                return ReprType::GetExponent(_repr) >= ReprType::ExponentForULP1;
+            case {TMPL_INT_BITTYPE_0} ... {TMPL_INT_BITTYPE_127}:
+            {
+                uint32_t bitIdx = code - {TMPL_INT_BITTYPE_0};
+                if (bitIdx < NumMantissaBits)
+                {
+                    return {TMPL_BITTYPE_MANTISSA};
+                }
+
+                if (bitIdx < NumMantissaBits + NumExponentBits)
+                {
+                    return {TMPL_BITTYPE_EXPONENT};
+                }
+
+                if (bitIdx < NumMantissaBits + NumExponentBits + 1)
+                {
+                    return {TMPL_BITTYPE_SIGN};
+                }
+
+                return {TMPL_BITTYPE_OOB};
+            }
+        }
+        return -1;
+    }
+
+    void SetValue(int code, const char *valstr) override
+    {
+        SetValueDeferred(code, valstr);
+        StepJob(0, 0);
+    }
+
+    void SetValueDeferred(int code, const char *valstr) override
+    {
+        ++_version;
+        if (code == {TMPL_SET_UNDO} || code == {TMPL_SET_REDO})
+        {
+            stepHistory(code == {TMPL_SET_UNDO});
+            return;
+        }
+        if (code == {TMPL_SET_PRECISION})
+        {
+            _precision = ParseScientificDigits(valstr);
+            return;
+        }
+
+        Storage prevRepr = _repr;
+        switch (code)
+        {
+            case {TMPL_SET_ZERO}:       _repr = ReprType::Zero();                 break;
+            case {TMPL_SET_ONE}:        _repr = ReprType::One();                    break;
+            case {TMPL_SET_INF}:        _repr = ReprType::PositiveInfinity(); break;
+            case {TMPL_SET_QNAN}:       _repr = ReprType::QuietNan(); break;
+            case {TMPL_SET_SNAN}:       _repr = ReprType::SignalingNan(); break;
+            case {TMPL_SET_MIN}:        _repr = ReprType::MinNormalized(); break;
+            case {TMPL_SET_MAX}:        _repr = ReprType::MaxFinite(); break;
+            case {TMPL_SET_EPS}:        _repr = ReprType::Epsilon();  break;
+            case {TMPL_SET_DENORM_MIN}: _repr = ReprType::MinDenormalized(); break;
+            case {TMPL_SET_NEGATE}:     _repr = ReprType::Negate(_repr); break;
+            case {TMPL_SET_PREV}:       _repr = ReprType::Prev(_repr); break;
+            case {TMPL_SET_NEXT}:       _repr = ReprType::Next(_repr); break;
+            case {TMPL_SET_MANTISSA_DECREMENT}: _repr = ReprType::DecrementMantissa(_repr); break;
+            case {TMPL_SET_MANTISSA_INCREMENT}: _repr = ReprType::IncrementMantissa(_repr); break;
+            case {TMPL_SET_EXPONENT_DECREMENT}: _repr = ReprType::DecrementExponent(_repr); break;
+            case {TMPL_SET_EXPONENT_INCREMENT}: _repr = ReprType::IncrementExponent(_repr); break;
+            case {TMPL_SET_BIT_FLIP_0} ... {TMPL_SET_BIT_FLIP_127}:
+            {
+                uint32_t bitIdx = code - {TMPL_SET_BIT_FLIP_0};
+                if (bitIdx < NumBits)
+                {
+                    _repr ^= ((Storage)1 << bitIdx);
+                }
+                break;
+            }
+            case {TMPL_SET_REPRSTR}: _repr = ReprType::FromReprString(valstr); break;
+        }
+
+        if (_repr != prevRepr)
+        {
+            _history.Push(historyEntry(prevRepr));
+        }
+        startValueJob(prevRepr);
+    }
+
+    // Entry of the strings of repr, which are only kept when they are complete. While the job is
+    // running they are left out, and the job starts again when the entry comes back.
+    EditorHistory::Entry historyEntry(Storage repr)
+    {
+        if (_job._isActive)
+        {
+            return {repr, false, {}, {}, {}};
+        }
+        return {repr, true, PackedDigits::Pack(_exact10, 10), PackedDigits::Pack(_exact2, 2), std::move(_math)};
+    }
+
+    // Swaps in the encoding and results one step back or forward. The bigint value is not kept in
+    // the history, so the editor goes on as after a ResultCache hit.
+    void stepHistory(bool isUndo)
+    {
+        EditorHistory::Entry current = historyEntry(_repr);
+        bool isMoved = isUndo ? _history.Undo(current) : _history.Redo(current);
+        _repr = (Storage)current.repr;
+        _exact10 = current.exact10.Unpack();
+        _exact2 = current.exact2.Unpack();
+        _math = std::move(current.math);
+        if (!isMoved)
+        {
+            return;
+        }
+
+        _job._isActive = false;
+        _hasValue = false;
+        if (!current.isComplete)
+        {
+            startValueJob(_repr);
+        }
+    }
+
+    bool StepJob(int64_t maxOps, int64_t maxMicros) override
+    {
+        if (!_job._isActive)
+        {
+            return true;
+        }
+
+        StepBudget budget(maxOps, maxMicros);
+        if (!_job.Step(budget))
+        {
+            return false;
+        }
+
+        _job.Finish(_value, _binade);
+        finishValue();
+        ++_version;
+        return true;
+    }
+
+    int Enumerate(char *reprStr, int count, const int *codes, int numCodes, char *buf, int bufSize) const override
+    {
+        return EnumerateValues<IEEE754FloatEditor>(reprStr, count, codes, numCodes, buf, bufSize, _precision);
+    }
+
+    Unpacked Unpack() const override
+    {
+        bool sign = ReprType::GetSign(_repr);
+        Storage num;
+        int exp;
+        if (!ReprType::GetScaledInteger(_repr, num, exp))
+        {
+            bool isInf = ReprType::Specials != IEEE754_NAN_ONLY && ReprType::GetMantissa(_repr) == ReprType::IntegerBit;
+            return Unpacked::Make(isInf ? Unpacked::Infinite : Unpacked::NaN, sign);
+        }
+        if (num == 0)
+        {
+            return Unpacked::Make(Unpacked::Zero, sign);
+        }
+        Unpacked res = Unpacked::Make(Unpacked::Finite, sign);
+        res.sig = num;
+        res.exp = exp;
+        return res;
+    }
+
+    bool IsReprString(const char *valstr) const override
+    {
+        typename ReprType::Storage repr;
+        return ReprType::ParseReprString(valstr, repr);
+    }
+
+    bool StartExactStream(ExactDecimalStream &stream) const override
+    {
+        Storage num;
+        int exp;
+        if (!ReprType::GetScaledInteger(_repr, num, exp))
+        {
+            return false;
+        }
+        stream.StartBinary(ReprType::GetSign(_repr), num, exp, std::max(0, -exp));
+        return true;
+    }
+
+    void startValueJob(Storage prevRepr)
+    {
+        _job._isActive = false;
+
+        Storage num;
+        int exp;
+        if (!ReprType::GetScaledInteger(_repr, num, exp))
+        {
+            _value = SimpleNumber();
+            _hasValue = true;
+            renderExact();
+            recomputeMath();
+            return;
+        }
+
+        if (_hasValue && ReprType::UlpStep(prevRepr, _repr) != 0)
+        {
+            recomputeValue(prevRepr);
+            finishValue();
+            return;
+        }
+
+        ResultCache::Entry cached;
+        if (ResultCache::Global().Lookup(TraitsType::TypeCode, _repr, cached))
+        {
+            _exact10 = cached.exact10.Unpack();
+            _exact2 = cached.exact2.Unpack();
+            _math = std::move(cached.math);
+            _hasValue = false;
+            return;
+        }
+
+        _value = SimpleNumber();
+        _hasValue = false;
+        _exact10.clear();
+        _exact2.clear();
+        _math.clear();
+        _job.Start(num, exp, ReprType::GetSign(_repr));
+    }
+
+    // Renders and caches the value once it is computed
+    void finishValue()
+    {
+        _hasValue = true;
+        renderExact();
+        recomputeMath();
+        ResultCache::Global().Insert(TraitsType::TypeCode, _repr, ResultCache::Entry{PackedDigits::Pack(_exact10, 10), PackedDigits::Pack(_exact2, 2), _math});
+    }
+
+    void renderExact()
+    {
+        RenderExact(_value, ReprType::UlpExponent(_repr), _exact10, _exact2);
+    }
+
+    void recomputeValue(Storage prevRepr)
+    {
+        int step = ReprType::UlpStep(prevRepr, _repr);
+        if (step != 0)
+        {
+            StepByUlp(_value, _binade.Ulp(ReprType::UlpExponent(prevRepr)), step);
+        }
+        else
+        {
+            _value = ReprType::GetValue(_repr);
+        }
+    }
+
+    void recomputeMath()
+    {
+        STATS_SCOPE(STATS_MATH);
+        _math.clear();
+
+        if (ReprType::IsNanOrInf(_repr))
+        {
+            return;
+        }
+        else
+        {
+            for (int rep = 0; rep <= 1; ++rep)
+            {
+
+                _math += "<math xmlns=\"http://www.w3.org/1998/Math/MathML\" display=\"block\">";
+                _math +=  "<mrow>";
+                _math +=    "<mi>value</mi>";
+                _math +=    "<mo>=</mo>";
+                _math +=    "<mrow>";
+                _math +=     "<msup>";
+                _math +=      "<mrow>";
+                _math +=       "<mo>(</mo>";
+                _math +=       "<mrow>";
+                _math +=        "<mrow>";
+                _math +=         "<mo>−</mo>";
+                _math +=         "<mn>1</mn>";
+                _math +=        "</mrow>";
+                _math +=       "</mrow>";
+                _math +=       "<mo>)</mo>";
+                _math +=      "</mrow>";
+                if (rep == 0) _math += "<mi class=\"identifier\" data-ic=\"{TMPL_IDENTIFIER_SIGN}\">sign</mi>";
+                else          _math += "<mn class=\"identifier\" data-ic=\"{TMPL_IDENTIFIER_SIGN}\">" + std::to_string(ReprType::GetSign(_repr)) + "</mn>";
+                _math +=     "</msup>";
+                _math +=     "<mo>×</mo>";
+                _math +=     "<msup>";
+                _math +=      "<mn>2</mn>";
+                _math +=      "<mrow>";
+                _math +=       "<mo>(</mo>";
+                _math +=       "<mrow>";
+                _math +=        "<mrow>";
+                if (rep == 0) _math += "<mi class=\"identifier\" data-ic=\"{TMPL_IDENTIFIER_EXPONENT}\">exponent</mi>";
+                else          _math += "<mn class=\"identifier\" data-ic=\"{TMPL_IDENTIFIER_EXPONENT}\">" + std::to_string(ReprType::GetExponent(_repr)) + "</mn>";
+                _math +=         "<mo>−</mo>";
+                if (rep == 0) _math += "<mi class=\"identifier\" data-ic=\"{TMPL_IDENTIFIER_EXPBIAS}\">expbias</mi>";
+                else          _math += "<mn class=\"identifier\" data-ic=\"{TMPL_IDENTIFIER_EXPBIAS}\">" + std::to_string(ReprType::ExponentBias) + "</mn>";
+                _math +=         "<mo>+</mo>";
+                _math +=         "<mn>1</mn>";
+                _math +=         "<mo>-</mo>";
+                if (rep == 0) _math += "<mi class=\"identifier\" data-ic=\"{TMPL_IDENTIFIER_NORMALIZED}\">N</mi>";
+                else          _math += "<mn class=\"identifier\" data-ic=\"{TMPL_IDENTIFIER_NORMALIZED}\">" + (ReprType::GetExponent(_repr) == 0 ? "0"s : "1"s) + "</mn>";
+                _math +=        "</mrow>";
+                _math +=       "</mrow>";
+                _math +=       "<mo>)</mo>";
+                _math +=      "</mrow>";
+                _math +=     "</msup>";
+                _math +=     "<mo>×</mo>";
+                _math +=     "<mrow>";
+                _math +=      "<mo>(</mo>";
+                _math +=      "<mrow>";
+                if constexpr (!ReprType::ExplicitIntegerBit)
+                {
+                    if (rep == 0) _math += "<mi class=\"identifier\" data-ic=\"{TMPL_IDENTIFIER_NORMALIZED}\">N</mi>";
+                    else          _math += "<mn class=\"identifier\" data-ic=\"{TMPL_IDENTIFIER_NORMALIZED}\">" + (ReprType::GetExponent(_repr) == 0 ? "0"s : "1"s) + "</mn>";
+                    _math +=       "<mo>+</mo>";
+                }
+                _math +=       "<mfrac>";
+                if (rep == 0) _math += "<mi class=\"identifier\" data-ic=\"{TMPL_IDENTIFIER_MANTISSA}\">mantissa</mi>";
+                else          _math += "<mn class=\"identifier\" data-ic=\"{TMPL_IDENTIFIER_MANTISSA}\">" + UintToString(ReprType::GetMantissa(_repr)) + "</mn>";
+                _math +=        "<msup>";
+                _math +=         "<mn>2</mn>";
+                // The integer bit is the top bit of the mantissa, so the fraction is one bit shorter
+                if (ReprType::ExplicitIntegerBit) _math += "<mrow>";
+                if (rep == 0) _math += "<mi class=\"identifier\" data-ic=\"{TMPL_IDENTIFIER_MBITS}\">mbits</mi>";
+                else          _math += "<mn class=\"identifier\" data-ic=\"{TMPL_IDENTIFIER_MBITS}\">" + std::to_string(ReprType::NumMantissaBits) + "</mn>";
+                if (ReprType::ExplicitIntegerBit) _math += "<mo>−</mo><mn>1</mn></mrow>";
+                _math +=        "</msup>";
+                _math +=       "</mfrac>";
+                _math +=      "</mrow>";
+                _math +=      "<mo>)</mo>";
+                _math +=     "</mrow>";
+                _math +=    "</mrow>";
+                _math +=   "</mrow>";
+                _math += "</math>";
+            }
+
+
+            bool isNeg = ReprType::GetSign(_repr);
+
+            Storage finalEqNum = 0;
+            int finalEqExp = 0;
+            ReprType::GetScaledInteger(_repr, finalEqNum, finalEqExp);
+            std::string finalEqInt = UintToString(finalEqNum);
+
+
+            _math += "<math xmlns=\"http://www.w3.org/1998/Math/MathML\" display=\"block\">";
+            _math +=  "<mrow>";
+            _math +=    "<mo>=</mo>";
+            if (isNeg) _math += "<mo>-</mo>";
+            _math +=    "<mn>" + finalEqInt + "</mn>";
+            _math +=    "<mo>×</mo>";
+            _math +=    "<msup>";
+            _math +=     "<mn>2</mn>";
+            _math +=     "<mn>" + std::to_string(finalEqExp) + "</mn>";
+            _math +=    "</msup>";
+            _math +=  "</mrow>";
+            _math += "</math>";
+
+            if (finalEqExp < 0)
+            {
+                _math += "<math xmlns=\"http://www.w3.org/1998/Math/MathML\" display=\"block\">";
+                _math +=  "<mrow>";
+                _math +=   "<mo>=</mo>";
+                if (isNeg) _math += "<mo>-</mo>";
+                _math +=   "<mfrac>";
+                _math +=    "<mn>" + finalEqInt + "</mn>";
+                _math +=    "<mn>" + _binade.Denominator(finalEqExp) + "</mn>";
+                _math +=   "</mfrac>";
+                _math +=  "</mrow>";
+                _math += "</math>";
+            }
+        }
+    }
+
+    Storage _repr = 0;
+    SimpleNumber _value;
+    bool _hasValue = true; // false when the strings below came from the cache
+    std::string _exact10;
+    std::string _exact2;
+    std::string _math;
+    BinadeCache _binade;
+    ValueJob _job;
+};
+
+template <typename TraitsType>
+struct PositEditor : Editor
+{
+    using ReprType = PositRepresentation<TraitsType>;
+
+    static constexpr int NumBits = TraitsType::NumBits;
+
+    PositEditor()
+    {
+        finishValue();
+    }
+
+    std::string GetStringImpl(int code) const override
+    {
+        switch (code)
+        {
+        case {TMPL_IDENTIFIER_SIGN}: return std::to_string(ReprType::GetSignBit(_repr));
+        case {TMPL_IDENTIFIER_EXPONENT}: return std::to_string(ReprType::GetExponent(_repr));
+        case {TMPL_IDENTIFIER_MANTISSA}: return std::to_string(ReprType::GetMantissa(_repr));
+        case {TMPL_IDENTIFIER_MBITS}: return std::to_string(ReprType::NumMantissaBits(_repr));
+        case {TMPL_IDENTIFIER_REGIME}:
+        {
+            int regime = ReprType::GetRegime(_repr);
+            if (regime == -(NumBits - 1))
+            {
+                // Display regime as -inf as described here: https://groups.google.com/g/unum-computing/c/BQ6ieoky5TU/m/tnHG7wQ2BQAJ
+                return "&minus;&infin;";
+            }
+            return std::to_string(regime);
+        }
+
+        case {TMPL_STRCODE_BITSTRING}:  return ReprType::GetBitString(_repr);
+        case {TMPL_STRCODE_BYTES_PRETTY}: return ReprType::GetBytesPretty(_repr);
+        case {TMPL_STRCODE_URLHASH}: return "#"s + TraitsType::TypeName + "=" + ReprType::ToReprString(_repr);
+        case {TMPL_STRCODE_TYPENAME}: return TraitsType::TypeName;
+        case {TMPL_STRCODE_TYPENAME_LONG}: return TraitsType::TypeNameLong;
+        case {TMPL_STRCODE_EXACT_BASE10}:
+        case {TMPL_STRCODE_EXACT_BASE2}:
+        case {TMPL_STRCODE_SCIENTIFIC}:
+        case {TMPL_STRCODE_HEXFLOAT}:
+        {
+            if (_repr == (1ull << (NumBits - 1))) return "NaR";
+            if (code == {TMPL_STRCODE_SCIENTIFIC} || code == {TMPL_STRCODE_HEXFLOAT})
+            {
+                uint64_t num = 0;
+                int exp = 0;
+                ReprType::GetScaledInteger(_repr, num, exp);
+                return RenderFixedPrecision(code, ReprType::GetSignBit(_repr), num, exp, _precision);
+            }
+            if (_job._isActive) return "…";
+
+            return (code == {TMPL_STRCODE_EXACT_BASE10} ? _exact10 : _exact2);
+        }
+        case {TMPL_STRCODE_MATH}: return _math;
+        }
+
+        return "error";
+    }
+
+    int GetInt(int code) const override
+    {
+        switch (code)
+        {
+            case {TMPL_BOOL_IS_IEEE754}:
+                return 0;
+            case {TMPL_BOOL_IS_ANY}:
+                return 1;
+            case {TMPL_BOOL_IS_COMPUTING}:
+                return _job._isActive;
+            case {TMPL_BOOL_CAN_UNDO}:
+                return _history.CanUndo();
+            case {TMPL_BOOL_CAN_REDO}:
+                return _history.CanRedo();
+            case {TMPL_BOOL_IS_POSIT}:
+                return 1;
+            case {TMPL_INT_BITTYPE_0} ... {TMPL_INT_BITTYPE_127}:
+            {
+                uint32_t bitIdx = code - {TMPL_INT_BITTYPE_0};
+                if (bitIdx >= NumBits)
+                {
+                    return {TMPL_BITTYPE_OOB};
+                }
+
+                if (bitIdx == NumBits - 1)
+                {
+                    return {TMPL_BITTYPE_SIGN};
+                }
+
+                int numRegimeBits = ReprType::NumRegimeBits(_repr);
+
+                if (bitIdx >= NumBits - 1 - numRegimeBits)
+                {
+                    return {TMPL_BITTYPE_REGIME};
+                }
+
+                if ((int)bitIdx >= (int)NumBits - 1 - (int)numRegimeBits - ReprType::ExponentSize)
+                {
+                    return {TMPL_BITTYPE_EXPONENT};
+                }
+
+                return {TMPL_BITTYPE_MANTISSA};
+            }
+        }
+        return -1;
+    }
+
+    void SetValue(int code, const char *valstr) override
+    {
+        SetValueDeferred(code, valstr);
+        StepJob(0, 0);
+    }
+
+    void SetValueDeferred(int code, const char *valstr) override
+    {
+        ++_version;
+        if (code == {TMPL_SET_UNDO} || code == {TMPL_SET_REDO})
+        {
+            stepHistory(code == {TMPL_SET_UNDO});
+            return;
+        }
+        if (code == {TMPL_SET_PRECISION})
+        {
+            _precision = ParseScientificDigits(valstr);
+            return;
+        }
+
+        uint64_t prevRepr = _repr;
+        switch (code)
+        {
+            case {TMPL_SET_ZERO}:       _repr = ReprType::Zero(); break;
+            case {TMPL_SET_ONE}:        _repr = ReprType::One(); break;
+            case {TMPL_SET_MIN}:        _repr = ReprType::MinPositive(); break;
+            case {TMPL_SET_MAX}:        _repr = ReprType::MaxFinite(); break;
+            case {TMPL_SET_NAR}:        _repr = ReprType::NaR(); break;
+            case {TMPL_SET_NEGATE}:     _repr = ReprType::Negate(_repr); break;
+            case {TMPL_SET_PREV}:       _repr = ReprType::Prev(_repr); break;
+            case {TMPL_SET_NEXT}:       _repr = ReprType::Next(_repr); break;
+            case {TMPL_SET_EPS}:        _repr = ReprType::Epsilon();  break;
+            case {TMPL_SET_BIT_FLIP_0} ... {TMPL_SET_BIT_FLIP_127}:
+            {
+                uint32_t bitIdx = code - {TMPL_SET_BIT_FLIP_0};
+                if (bitIdx < NumBits)
+                {
+                    _repr ^= (((uint64_t)1ul) << bitIdx);
+                }
+                break;
+            }
+            case {TMPL_SET_REGIME_DECREMENT}:   _repr = ReprType::DecrementRegime(   _repr ); break;
+            case {TMPL_SET_REGIME_INCREMENT}:   _repr = ReprType::IncrementRegime(   _repr ); break;
+            case {TMPL_SET_MANTISSA_DECREMENT}: _repr = ReprType::DecrementMantissa( _repr ); break;
+            case {TMPL_SET_MANTISSA_INCREMENT}: _repr = ReprType::IncrementMantissa( _repr ); break;
+            case {TMPL_SET_EXPONENT_DECREMENT}: _repr = ReprType::DecrementExponent( _repr ); break;
+            case {TMPL_SET_EXPONENT_INCREMENT}: _repr = ReprType::IncrementExponent( _repr ); break;
+            case {TMPL_SET_REPRSTR}: _repr = ReprType::FromReprString(valstr); break;
+        }
+
+        if (_repr != prevRepr)
+        {
+            _history.Push(historyEntry(prevRepr));
+        }
+        startValueJob(prevRepr);
+    }
+
+    // See IEEE754FloatEditor::historyEntry
+    EditorHistory::Entry historyEntry(uint64_t repr)
+    {
+        if (_job._isActive)
+        {
+            return {repr, false, {}, {}, {}};
+        }
+        return {repr, true, PackedDigits::Pack(_exact10, 10), PackedDigits::Pack(_exact2, 2), std::move(_math)};
+    }
+
+    // See IEEE754FloatEditor::stepHistory
+    void stepHistory(bool isUndo)
+    {
+        EditorHistory::Entry current = historyEntry(_repr);
+        bool isMoved = isUndo ? _history.Undo(current) : _history.Redo(current);
+        _repr = (uint64_t)current.repr;
+        _exact10 = current.exact10.Unpack();
+        _exact2 = current.exact2.Unpack();
+        _math = std::move(current.math);
+        if (!isMoved)
+        {
+            return;
+        }
+
+        _job._isActive = false;
+        _hasValue = false;
+        if (!current.isComplete)
+        {
+            startValueJob(_repr);
+        }
+    }
+
+    bool StepJob(int64_t maxOps, int64_t maxMicros) override
+    {
+        if (!_job._isActive)
+        {
+            return true;
+        }
+
+        StepBudget budget(maxOps, maxMicros);
+        if (!_job.Step(budget))
+        {
+            return false;
+        }
+
+        _job.Finish(_value, _binade);
+        finishValue();
+        ++_version;
+        return true;
+    }
+
+    int Enumerate(char *reprStr, int count, const int *codes, int numCodes, char *buf, int bufSize) const override
+    {
+        return EnumerateValues<PositEditor>(reprStr, count, codes, numCodes, buf, bufSize, _precision);
+    }
+
+    Unpacked Unpack() const override
+    {
+        return SoftFloatFormat<ReprType>::Unpack(_repr);
+    }
+
+    bool IsReprString(const char *valstr) const override
+    {
+        typename ReprType::Storage repr;
+        return ReprType::ParseReprString(valstr, repr);
+    }
+
+    bool StartExactStream(ExactDecimalStream &stream) const override
+    {
+        uint64_t num = 0;
+        int exp = 0;
+        if (_repr == ReprType::NaR())
+        {
+            return false;
+        }
+        ReprType::GetScaledInteger(_repr, num, exp);
+        stream.StartBinary(ReprType::GetSignBit(_repr), num, exp, std::max(0, -ReprType::UlpExponent(_repr)));
+        return true;
+    }
+
+    void startValueJob(uint64_t prevRepr)
+    {
+        _job._isActive = false;
+
+        uint64_t num;
+        int exp;
+        if (!ReprType::GetScaledInteger(_repr, num, exp))
+        {
+            _value = SimpleNumber();
+            _hasValue = true;
+            renderExact();
+            recomputeMath();
+            return;
+        }
+
+        if (_hasValue && ReprType::UlpStep(prevRepr, _repr) != 0)
+        {
+            recomputeValue(prevRepr);
+            finishValue();
+            return;
+        }
+
+        ResultCache::Entry cached;
+        if (ResultCache::Global().Lookup(TraitsType::TypeCode, _repr, cached))
+        {
+            _exact10 = cached.exact10.Unpack();
+            _exact2 = cached.exact2.Unpack();
+            _math = std::move(cached.math);
+            _hasValue = false;
+            return;
+        }
+
+        _value = SimpleNumber();
+        _hasValue = false;
+        _exact10.clear();
+        _exact2.clear();
+        _math.clear();
+        _job.Start(num, exp, ReprType::GetSignBit(_repr));
+    }
+
+    // Renders and caches the value once it is computed
+    void finishValue()
+    {
+        _hasValue = true;
+        renderExact();
+        recomputeMath();
+        ResultCache::Global().Insert(TraitsType::TypeCode, _repr, ResultCache::Entry{PackedDigits::Pack(_exact10, 10), PackedDigits::Pack(_exact2, 2), _math});
+    }
+
+    void renderExact()
+    {
+        RenderExact(_value, ReprType::UlpExponent(_repr), _exact10, _exact2);
+    }
+
+    void recomputeValue(uint64_t prevRepr)
+    {
+        int step = ReprType::UlpStep(prevRepr, _repr);
+        if (step != 0)
+        {
+            StepByUlp(_value, _binade.Ulp(ReprType::UlpExponent(prevRepr)), step);
+        }
+        else
+        {
+            _value = ReprType::GetValue(_repr);
+        }
+    }
+
+    void recomputeMath()
+    {
+        STATS_SCOPE(STATS_MATH);
+        _math.clear();
+        if (_repr == ReprType::NaR() || _repr == ReprType::Zero())
+        {
+            _math = "";
+        }
+        else
+        {
+            for (int rep = 0; rep <= 1; ++rep)
+            {
+
+                _math += R"(<math xmlns="http://www.w3.org/1998/Math/MathML" display="block">)";
+                _math +=    "<mrow>";
+                _math +=      "<mi>value</mi>";
+                _math +=      "<mo>=</mo>";
+                _math +=      "<mo>(</mo>";
+                _math +=       "<mo>(</mo>";
+                _math +=        "<mn>1</mn>";
+                _math +=        "<mo>-</mo>";
+                _math +=        "<mn>3</mn>";
+                _math +=        "<mo>×</mo>";
+
+                if (rep == 0) _math += "<mi class=\"identifier\" data-ic=\"{TMPL_IDENTIFIER_SIGN}\">s</mi>";
+                else          _math += "<mn class=\"identifier\" data-ic=\"{TMPL_IDENTIFIER_SIGN}\">" + std::to_string(ReprType::GetSignBit(_repr)) + "</mn>";
+
+                _math +=       "<mo>)</mo>";
+                _math +=       "<mo>+</mo>";
+                _math +=       "<mfrac>";
+
+                if (rep == 0) _math += "<mi class=\"identifier\" data-ic=\"{TMPL_IDENTIFIER_MANTISSA}\">mantissa</mi>";
+                else          _math += "<mn class=\"identifier\" data-ic=\"{TMPL_IDENTIFIER_MANTISSA}\">" + std::to_string(ReprType::GetMantissa(_repr)) + "</mn>";
+
+                _math +=        "<msup>";
+                _math +=         "<mn>2</mn>";
+
+                if (rep == 0) _math += "<mi class=\"identifier\" data-ic=\"{TMPL_IDENTIFIER_MBITS}\">mbits</mi>";
+                else          _math += "<mn class=\"identifier\" data-ic=\"{TMPL_IDENTIFIER_MBITS}\">" + std::to_string(ReprType::NumMantissaBits(_repr)) + "</mn>";
+
+                _math +=        "</msup>";
+                _math +=       "</mfrac>";
+                _math +=      "<mo>)</mo>";
+                _math +=      "<mo>×</mo>";
+                _math +=      "<msup>";
+                _math +=       "<mn>2</mn>";
+                _math +=       "<mrow>";
+                _math +=        "<mo>(</mo>";
+                _math +=         "<mn>1</mn>";
+                _math +=         "<mo>-</mo>";
+                _math +=         "<mn>2</mn>";
+                _math +=         "<mo>×</mo>";
+
+                if (rep == 0) _math += "<mi class=\"identifier\" data-ic=\"{TMPL_IDENTIFIER_SIGN}\">s</mi>";
+                else          _math += "<mn class=\"identifier\" data-ic=\"{TMPL_IDENTIFIER_SIGN}\">" + std::to_string(ReprType::GetSignBit(_repr)) + "</mn>";
+
+                _math +=        "<mo>)</mo>";
+                _math +=        "<mo>×</mo>";
+                _math +=        "<mo>(</mo>";
+                _math +=         "<mn>" + std::to_string(1 << ReprType::ExponentSize) + "</mn>";
+                _math +=         "<mo>×</mo>";
+
+                if (rep == 0) _math += "<mi class=\"identifier\" data-ic=\"{TMPL_IDENTIFIER_REGIME}\">r</mi>";
+                else          _math += "<mn class=\"identifier\" data-ic=\"{TMPL_IDENTIFIER_REGIME}\">" + std::to_string(ReprType::GetRegime(_repr)) + "</mn>";
+
+                _math +=         "<mo>+</mo>";
+
+                if (rep == 0) _math += "<mi class=\"identifier\" data-ic=\"{TMPL_IDENTIFIER_EXPONENT}\">e</mi>";
+                else          _math += "<mn class=\"identifier\" data-ic=\"{TMPL_IDENTIFIER_EXPONENT}\">" + std::to_string(ReprType::GetExponent(_repr)) + "</mn>";
+
+                _math +=         "<mo>+</mo>";
+
+                if (rep == 0) _math += "<mi class=\"identifier\" data-ic=\"{TMPL_IDENTIFIER_SIGN}\">s</mi>";
+                else          _math += "<mn class=\"identifier\" data-ic=\"{TMPL_IDENTIFIER_SIGN}\">" + std::to_string(ReprType::GetSignBit(_repr)) + "</mn>";
+
+                _math +=        "<mo>)</mo>";
+                _math +=       "</mrow>";
+                _math +=      "</msup>";
+                _math +=     "</mrow>";
+                _math += R"(</math>)";
+            }
+
+
+            int signImplicitTerm = 1 - 3 * (int)ReprType::GetSignBit(_repr);
+            int finalEqPow = ReprType::GetScale(_repr);
+
+            _math += "<div class=\"large-content\">";
+            _math +=  "<math xmlns=\"http://www.w3.org/1998/Math/MathML\" display=\"block\">";
+            _math +=   "<mrow>";
+            _math +=     "<mo>=</mo>";
+            _math +=     "<mo>(</mo>";
+            _math +=      "<mn>" + std::to_string(signImplicitTerm) + "</mn>";
+            _math +=      "<mo>+</mo>";
+            _math +=       "<mfrac>";
+            _math +=        "<mn>" + std::to_string(ReprType::GetMantissa(_repr)) + "</mn>";
+            _math +=        "<msup>";
+            _math +=         "<mn>2</mn>";
+            _math +=          "<mn>" + std::to_string(ReprType::NumMantissaBits(_repr)) + "</mn>";
+            _math +=        "</msup>";
+            _math +=       "</mfrac>";
+            _math +=     "<mo>)</mo>";
+            _math +=     "<mo>×</mo>";
+            _math +=     "<msup>";
+            _math +=      "<mn>2</mn>";
+            _math +=      "<mn>" + std::to_string(finalEqPow) + "</mn>";
+            _math +=     "</msup>";
+            _math +=   "</mrow>";
+            _math +=  "</math>";
+            _math += "</div>";
+
+
+            int64_t topn = ReprType::GetMantissa(_repr) + signImplicitTerm * (1ll << ReprType::NumMantissaBits(_repr));
+            bool isNeg = topn < 0;
+            if (isNeg)
+            {
+                topn = -topn;
+            }
+            std::string top = std::to_string(topn);
+            int finalPow = ReprType::UlpExponent(_repr);
+
+            _math += "<div class=\"large-content\">";
+            _math +=  "<math xmlns=\"http://www.w3.org/1998/Math/MathML\" display=\"block\">";
+            _math +=   "<mrow>";
+            _math +=     "<mo>=</mo>";
+            if (isNeg) _math += "<mo>-</mo>";
+            _math +=     "<mn>" + top + "</mn>";
+            _math +=     "<mo>×</mo>";
+            _math +=      "<msup>";
+            _math +=       "<mn>2</mn>";
+            _math +=       "<mn>" + std::to_string(finalPow) + "</mn>";
+            _math +=      "</msup>";
+            _math +=   "</mrow>";
+            _math +=  "</math>";
+            _math += "</div>";
+
+            if (finalPow < 0)
+            {
+                _math += "<div class=\"large-content\">";
+                _math +=  "<math xmlns=\"http://www.w3.org/1998/Math/MathML\" display=\"block\">";
+                _math +=   "<mrow>";
+                _math +=     "<mo>=</mo>";
+                if (isNeg) _math += "<mo>-</mo>";
+                _math +=     "<mfrac>";
+                _math +=      "<mn>" + top + "</mn>";
+                _math +=      "<mn>" + _binade.Denominator(finalPow) + "</mn>";
+                _math +=     "</mfrac>";
+                _math +=   "</mrow>";
+                _math +=  "</math>";
+                _math += "</div>";
+            }
+            else
+            {
+                _math += "<div class=\"large-content\">";
+                _math +=  "<math xmlns=\"http://www.w3.org/1998/Math/MathML\" display=\"block\">";
+                _math +=   "<mrow>";
+                _math +=     "<mo>=</mo>";
+                if (isNeg) _math += "<mo>-</mo>";
+                // top * 2**finalPow is the magnitude of the value itself
+                _math +=     "<mn>" + _value._base10.render(0) + "</mn>";
+                _math +=   "</mrow>";
+                _math +=  "</math>";
+                _math += "</div>";
+            }
+        }
+    }
+
+    uint64_t _repr = 0;
+    SimpleNumber _value;
+    bool _hasValue = true; // false when the strings below came from the cache
+    std::string _exact10;
+    std::string _exact2;
+    std::string _math;
+    BinadeCache _binade;
+    ValueJob _job;
+};
+
+template <typename TraitsType>
+struct DecimalEditor : Editor
+{
+    using ReprType = DecimalRepresentation<TraitsType>;
+    using Codec = typename ReprType::Codec;
+    using Storage = typename ReprType::Storage;
+
+    static constexpr int NumBits = TraitsType::NumBits;
+    static constexpr int NumTrailingBits = Codec::NumTrailingBits;
+    static constexpr int NumExponentContinuationBits = Codec::NumExponentContinuationBits;
+
+    bool IsFinite() const { return _value.kind == Codec::Finite; }
+
+    // Exponent of the value, as opposed to the biased one of the encoding
+    int GetScale() const { return _value.exponent - ReprType::Bias; }
+
+    DecimalEditor()
+    {
+        renderExact();
+        recomputeMath();
+    }
+
+    std::string GetStringImpl(int code) const override
+    {
+        switch (code)
+        {
+        case {TMPL_IDENTIFIER_SIGN}: return std::to_string(_value.sign);
+        case {TMPL_IDENTIFIER_EXPONENT}: return IsFinite() ? std::to_string(_value.exponent) : "N/A";
+        case {TMPL_IDENTIFIER_EXPBIAS}: return std::to_string(ReprType::Bias);
+        case {TMPL_IDENTIFIER_MANTISSA}: return UintToString(_value.coefficient);
+        case {TMPL_IDENTIFIER_MBITS}: return std::to_string(ReprType::Precision);
+        case {TMPL_IDENTIFIER_NORMALIZED}: return "N/A";
+        case {TMPL_STRCODE_TYPENAME}: return TraitsType::TypeName;
+        case {TMPL_STRCODE_TYPENAME_LONG}: return TraitsType::TypeNameLong;
+        case {TMPL_STRCODE_BITSTRING}:  return ReprType::GetBitString(_repr);
+        case {TMPL_STRCODE_BYTES_PRETTY}: return ReprType::GetBytesPretty(_repr);
+        case {TMPL_STRCODE_EXACT_BASE10}:
+        case {TMPL_STRCODE_EXACT_BASE2}:
+        case {TMPL_STRCODE_SCIENTIFIC}:
+        case {TMPL_STRCODE_HEXFLOAT}:
+        {
+            switch (_value.kind)
+            {
+            case Codec::Infinite: return _value.sign ? "-inf" : "inf";
+            case Codec::QuietNaN: return "Quiet NaN";
+            case Codec::SignalingNaN: return "Signaling NaN";
+            default: break;
+            }
+            if (code == {TMPL_STRCODE_SCIENTIFIC})
+            {
+                return RenderScientificDecimal(_value.sign, UintToString(_value.coefficient), GetScale(), _precision);
+            }
+            if (code == {TMPL_STRCODE_HEXFLOAT})
+            {
+                return renderHexFloat();
+            }
+            return (code == {TMPL_STRCODE_EXACT_BASE10} ? _exact10 : _exact2);
+        }
+        case {TMPL_STRCODE_URLHASH}: return "#"s + TraitsType::TypeName + "=" + ReprType::ToReprString(_repr);
+        case {TMPL_STRCODE_MATH}: return _math;
+        }
+        return "error";
+    }
+
+    int GetInt(int code) const override
+    {
+        switch (code)
+        {
+            case {TMPL_BOOL_IS_IEEE754}:
+                return 0;
+            case {TMPL_BOOL_IS_POSIT}:
+                return 0;
+            case {TMPL_BOOL_IS_DECIMAL}:
+                return 1;
+            case {TMPL_BOOL_IS_ANY}:
+                return 1;
+            case {TMPL_BOOL_IS_COMPUTING}:
+                return 0;
+            case {TMPL_BOOL_CAN_UNDO}:
+                return _history.CanUndo();
+            case {TMPL_BOOL_CAN_REDO}:
+                return _history.CanRedo();
+            case {TMPL_BOOL_IS_NORMAL}:
+                return ReprType::ValueClass(_value) == {TMPL_VALUECLASS_NORMAL};
+            case {TMPL_BOOL_IS_DENORMAL}:
+                return ReprType::ValueClass(_value) == {TMPL_VALUECLASS_SUBNORMAL};
+            case {TMPL_BOOL_IS_FRACTION}:
+                return IsFinite() && GetScale() < 0;
+            case {TMPL_BOOL_IS_INTEGER}:
+                return IsFinite() && GetScale() >= 0;
+            case {TMPL_INT_BITTYPE_0} ... {TMPL_INT_BITTYPE_127}:
+            {
+                uint32_t bitIdx = code - {TMPL_INT_BITTYPE_0};
+                if (bitIdx >= NumBits)
+                {
+                    return {TMPL_BITTYPE_OOB};
+                }
+                if (bitIdx == NumBits - 1)
+                {
+                    return {TMPL_BITTYPE_SIGN};
+                }
+                if (bitIdx < NumTrailingBits)
+                {
+                    return {TMPL_BITTYPE_MANTISSA};
+                }
+                return CombinationBitType(NumBits - 2 - bitIdx);
+            }
+        }
+        return -1;
+    }
+
+    // Bits of the combination field from the top, which depend on its leading bits. The bits that
+    // select the form, and the ones that mark infinities and NaNs, are neither exponent nor
+    // coefficient.
+    int CombinationBitType(int i) const
+    {
+        constexpr int W = NumExponentContinuationBits;
+        if (!IsFinite())
+        {
+            return i < 6 ? {TMPL_BITTYPE_COMBINATION} : {TMPL_BITTYPE_MANTISSA};
+        }
+
+        bool isLargeForm = (_repr >> (NumBits - 3) & 3) == 3;
+        if (TraitsType::IsDpd)
+        {
+            if (isLargeForm)
+            {
+                return i < 2 ? {TMPL_BITTYPE_COMBINATION} : i == 4 ? {TMPL_BITTYPE_MANTISSA} : {TMPL_BITTYPE_EXPONENT};
+            }
+            return i >= 2 && i < 5 ? {TMPL_BITTYPE_MANTISSA} : {TMPL_BITTYPE_EXPONENT};
+        }
+
+        if (isLargeForm)
+        {
+            return i < 2 ? {TMPL_BITTYPE_COMBINATION} : i < W + 4 ? {TMPL_BITTYPE_EXPONENT} : {TMPL_BITTYPE_MANTISSA};
+        }
+        return i < W + 2 ? {TMPL_BITTYPE_EXPONENT} : {TMPL_BITTYPE_MANTISSA};
+    }
+
+    // Decimals do not need bigint work beyond a few passes over the digits, so values are always
+    // computed immediately
+    void SetValue(int code, const char *valstr) override
+    {
+        ++_version;
+        if (code == {TMPL_SET_UNDO} || code == {TMPL_SET_REDO})
+        {
+            stepHistory(code == {TMPL_SET_UNDO});
+            return;
+        }
+        if (code == {TMPL_SET_PRECISION})
+        {
+            _precision = ParseScientificDigits(valstr);
+            return;
+        }
+
+        Storage prevRepr = _repr;
+        switch (code)
+        {
+            case {TMPL_SET_ZERO}:       _repr = ReprType::Zero(); break;
+            case {TMPL_SET_ONE}:        _repr = ReprType::One(); break;
+            case {TMPL_SET_INF}:        _repr = ReprType::PositiveInfinity(); break;
+            case {TMPL_SET_QNAN}:       _repr = ReprType::QuietNan(); break;
+            case {TMPL_SET_SNAN}:       _repr = ReprType::SignalingNan(); break;
+            case {TMPL_SET_MIN}:        _repr = ReprType::MinNormal(); break;
+            case {TMPL_SET_MAX}:        _repr = ReprType::MaxFinite(); break;
+            case {TMPL_SET_EPS}:        _repr = ReprType::Epsilon(); break;
+            case {TMPL_SET_DENORM_MIN}: _repr = ReprType::MinSubnormal(); break;
+            case {TMPL_SET_NEGATE}:     _repr = ReprType::Negate(_repr); break;
+            case {TMPL_SET_PREV}:       _repr = ReprType::Prev(_repr); break;
+            case {TMPL_SET_NEXT}:       _repr = ReprType::Next(_repr); break;
+            case {TMPL_SET_MANTISSA_DECREMENT}: _repr = ReprType::DecrementMantissa(_repr); break;
+            case {TMPL_SET_MANTISSA_INCREMENT}: _repr = ReprType::IncrementMantissa(_repr); break;
+            case {TMPL_SET_EXPONENT_DECREMENT}: _repr = ReprType::DecrementExponent(_repr); break;
+            case {TMPL_SET_EXPONENT_INCREMENT}: _repr = ReprType::IncrementExponent(_repr); break;
+            case {TMPL_SET_BIT_FLIP_0} ... {TMPL_SET_BIT_FLIP_127}:
+            {
+                uint32_t bitIdx = code - {TMPL_SET_BIT_FLIP_0};
                 if (bitIdx < NumBits)
                 {
-                    _repr ^= (((uint64_t)1ul) << bitIdx);
+                    _repr ^= ((Storage)1 << bitIdx);
                 }
                 break;
             }
-            case {TMPL_SET_REGIME_DECREMENT}:   _repr = ReprType::DecrementRegime(   _repr ); break;
-            case {TMPL_SET_REGIME_INCREMENT}:   _repr = ReprType::IncrementRegime(   _repr ); break;
-            case {TMPL_SET_MANTISSA_DECREMENT}: _repr = ReprType::DecrementMantissa( _repr ); break;
-            case {TMPL_SET_MANTISSA_INCREMENT}: _repr = ReprType::IncrementMantissa( _repr ); break;
-            case {TMPL_SET_EXPONENT_DECREMENT}: _repr = ReprType::DecrementExponent( _repr ); break;
-            case {TMPL_SET_EXPONENT_INCREMENT}: _repr = ReprType::IncrementExponent( _repr ); break;
             case {TMPL_SET_REPRSTR}: _repr = ReprType::FromReprString(valstr); break;
         }
-
-        recompute();
+
+        if (_repr != prevRepr)
+        {
+            _history.Push({prevRepr, true, PackedDigits::Pack(_exact10, 10), PackedDigits::Pack(_exact2, 2), std::move(_math)});
+        }
+        _value = ReprType::GetValue(_repr);
+        renderExact();
+        recomputeMath();
+    }
+
+    // See IEEE754FloatEditor::stepHistory, the fields are decoded again as that is cheap
+    void stepHistory(bool isUndo)
+    {
+        EditorHistory::Entry current{_repr, true, PackedDigits::Pack(_exact10, 10), PackedDigits::Pack(_exact2, 2), std::move(_math)};
+        bool isMoved = isUndo ? _history.Undo(current) : _history.Redo(current);
+        _repr = (Storage)current.repr;
+        _exact10 = current.exact10.Unpack();
+        _exact2 = current.exact2.Unpack();
+        _math = std::move(current.math);
+        if (isMoved)
+        {
+            _value = ReprType::GetValue(_repr);
+        }
+    }
+
+    void SetValueDeferred(int code, const char *valstr) override
+    {
+        SetValue(code, valstr);
+    }
+
+    bool StepJob(int64_t, int64_t) override
+    {
+        return true;
+    }
+
+    int Enumerate(char *reprStr, int count, const int *codes, int numCodes, char *buf, int bufSize) const override
+    {
+        return EnumerateValues<DecimalEditor>(reprStr, count, codes, numCodes, buf, bufSize, _precision);
+    }
+
+    Unpacked Unpack() const override
+    {
+        switch (_value.kind)
+        {
+            case Codec::Infinite: return Unpacked::Make(Unpacked::Infinite, _value.sign);
+            case Codec::QuietNaN:
+            case Codec::SignalingNaN: return Unpacked::Make(Unpacked::NaN, _value.sign);
+            default: break;
+        }
+        return UnpackDecimal(_value.sign, _value.coefficient, GetScale());
+    }
+
+    bool IsReprString(const char *valstr) const override
+    {
+        typename ReprType::Storage repr;
+        return ReprType::ParseReprString(valstr, repr);
+    }
+
+    bool StartExactStream(ExactDecimalStream &stream) const override
+    {
+        if (!IsFinite())
+        {
+            return false;
+        }
+        int scale = GetScale();
+        stream.StartDecimal(_value.sign, _value.coefficient, scale, std::max(0, -scale));
+        return true;
+    }
+
+    // All digits of the quantum are shown, so 1.0 and 1.00 render differently. In base2 the
+    // value only has a finite expansion when 5**-scale divides the coefficient.
+    void renderExact()
+    {
+        _exact10.clear();
+        _exact2.clear();
+        if (!IsFinite())
+        {
+            return;
+        }
+
+        std::string sign = _value.sign ? "-" : "";
+        int scale = GetScale();
+        int digitsAfterDot = std::max(0, -scale);
+
+        SimpleNumberBase<10> base10 = SimpleNumberBase<10>::FromInteger(_value.coefficient);
+        base10._store._minExpo = _value.coefficient ? scale : 0;
+        _exact10 = sign + base10.render(digitsAfterDot);
+
+        // Either multiply by 5**scale, or divide by 5**-scale if it is exact
+        Storage coefficient = _value.coefficient;
+        int fives = scale;
+        for (; fives < 0 && coefficient && coefficient % 5 == 0; ++fives)
+        {
+            coefficient /= 5;
+        }
+        if (fives < 0 && coefficient)
+        {
+            _exact2 = "non-terminating";
+            return;
+        }
+
+        SimpleNumberBase<2> base2 = SimpleNumberBase<2>::FromInteger(coefficient);
+        for (; fives > 0; fives -= std::min(fives, 27))
+        {
+            uint64_t pow5 = 1;
+            for (int i = 0; i < std::min(fives, 27); ++i)
+            {
+                pow5 *= 5;
+            }
+            base2.MulSmall(pow5);
+        }
+        base2._store._minExpo = coefficient ? scale : 0;
+        _exact2 = sign + base2.render(coefficient ? digitsAfterDot : 0);
+    }
+
+    // Like the exact base 2 value, only when the value is a multiple of a power of two
+    std::string renderHexFloat() const
+    {
+        Storage coefficient = _value.coefficient;
+        int fives = GetScale();
+        for (; fives < 0 && coefficient && coefficient % 5 == 0; ++fives)
+        {
+            coefficient /= 5;
+        }
+        if (fives < 0 && coefficient)
+        {
+            return "non-terminating";
+        }
+
+        DigitBigInt sig = DigitBigInt::FromInteger(coefficient);
+        for (; fives > 0; fives -= std::min(fives, 13))
+        {
+            uint32_t pow5 = 1;
+            for (int i = 0; i < std::min(fives, 13); ++i)
+            {
+                pow5 *= 5;
+            }
+            sig.MulSmall(pow5);
+        }
+        return RenderHexFloat(_value.sign, std::move(sig), GetScale());
+    }
+
+    // Decoding a decimal is cheap, so unlike the binary editors the previous encoding is not used
+    void recomputeValue(Storage)
+    {
+        _value = ReprType::GetValue(_repr);
+    }
+
+    void recomputeMath()
+    {
+        STATS_SCOPE(STATS_MATH);
+        _math.clear();
+        if (!IsFinite())
+        {
+            return;
+        }
+
+        for (int rep = 0; rep <= 1; ++rep)
+        {
+            _math += R"(<math xmlns="http://www.w3.org/1998/Math/MathML" display="block">)";
+            _math +=    "<mrow>";
+            _math +=      "<mi>value</mi>";
+            _math +=      "<mo>=</mo>";
+            _math +=      "<msup>";
+            _math +=       "<mrow>";
+            _math +=        "<mo>(</mo>";
+            _math +=        "<mn>-1</mn>";
+            _math +=        "<mo>)</mo>";
+            _math +=       "</mrow>";
+
+            if (rep == 0) _math += "<mi class=\"identifier\" data-ic=\"{TMPL_IDENTIFIER_SIGN}\">sign</mi>";
+            else          _math += "<mn class=\"identifier\" data-ic=\"{TMPL_IDENTIFIER_SIGN}\">" + std::to_string(_value.sign) + "</mn>";
+
+            _math +=      "</msup>";
+            _math +=      "<mo>×</mo>";
+
+            if (rep == 0) _math += "<mi class=\"identifier\" data-ic=\"{TMPL_IDENTIFIER_MANTISSA}\">coefficient</mi>";
+            else          _math += "<mn class=\"identifier\" data-ic=\"{TMPL_IDENTIFIER_MANTISSA}\">" + UintToString(_value.coefficient) + "</mn>";
+
+            _math +=      "<mo>×</mo>";
+            _math +=      "<msup>";
+            _math +=       "<mn>10</mn>";
+            _math +=       "<mrow>";
+
+            if (rep == 0) _math += "<mi class=\"identifier\" data-ic=\"{TMPL_IDENTIFIER_EXPONENT}\">exponent</mi>";
+            else          _math += "<mn class=\"identifier\" data-ic=\"{TMPL_IDENTIFIER_EXPONENT}\">" + std::to_string(_value.exponent) + "</mn>";
+
+            _math +=        "<mo>-</mo>";
+
+            if (rep == 0) _math += "<mi class=\"identifier\" data-ic=\"{TMPL_IDENTIFIER_EXPBIAS}\">expbias</mi>";
+            else          _math += "<mn class=\"identifier\" data-ic=\"{TMPL_IDENTIFIER_EXPBIAS}\">" + std::to_string(ReprType::Bias) + "</mn>";
+
+            _math +=       "</mrow>";
+            _math +=      "</msup>";
+            _math +=    "</mrow>";
+            _math += R"(</math>)";
+        }
+
+        _math += "<div class=\"large-content\">";
+        _math +=  "<math xmlns=\"http://www.w3.org/1998/Math/MathML\" display=\"block\">";
+        _math +=   "<mrow>";
+        _math +=     "<mo>=</mo>";
+        if (_value.sign) _math += "<mo>-</mo>";
+        _math +=     "<mn>" + UintToString(_value.coefficient) + "</mn>";
+        _math +=     "<mo>×</mo>";
+        _math +=     "<msup>";
+        _math +=      "<mn>10</mn>";
+        _math +=      "<mn>" + std::to_string(GetScale()) + "</mn>";
+        _math +=     "</msup>";
+        _math +=   "</mrow>";
+        _math +=  "</math>";
+        _math += "</div>";
+    }
+
+    Storage _repr = 0;
+    typename ReprType::Fields _value = ReprType::GetValue(0);
+    std::string _exact10;
+    std::string _exact2;
+    std::string _math;
+};
+
+// Calls f with a default constructed representation of the type code, for APIs that take the type
+// as an argument but need the representation at compile time. Returns false for unknown types, and
+// for binary128 and float80 which do not fit the uint64 arrays of these APIs.
+template <typename F>
+bool DispatchRepr(int type, F &&f)
+{
+    switch (type)
+    {
+    case {TMPL_TYPE_BINARY16}:  f(IEEE754FloatRepresentation<IEEE754Float16Traits>()); return true;
+    case {TMPL_TYPE_BFLOAT16}:  f(IEEE754FloatRepresentation<IEEE754BFloat16Traits>()); return true;
+    case {TMPL_TYPE_MINIFLOAT}: f(IEEE754FloatRepresentation<IEEE754MinifloatTraits>()); return true;
+    case {TMPL_TYPE_BINARY32}:  f(IEEE754FloatRepresentation<IEEE754Float32Traits>()); return true;
+    case {TMPL_TYPE_BINARY64}:  f(IEEE754FloatRepresentation<IEEE754Float64Traits>()); return true;
+    case {TMPL_TYPE_E4M3}:      f(IEEE754FloatRepresentation<OcpE4M3Traits>()); return true;
+    case {TMPL_TYPE_E5M2}:      f(IEEE754FloatRepresentation<OcpE5M2Traits>()); return true;
+    case {TMPL_TYPE_E2M1}:      f(IEEE754FloatRepresentation<OcpE2M1Traits>()); return true;
+    case {TMPL_TYPE_POSIT8}:    f(PositRepresentation<Posit8Traits>()); return true;
+    case {TMPL_TYPE_POSIT16}:   f(PositRepresentation<Posit16Traits>()); return true;
+    case {TMPL_TYPE_POSIT32}:   f(PositRepresentation<Posit32Traits>()); return true;
+    case {TMPL_TYPE_POSIT64}:   f(PositRepresentation<Posit64Traits>()); return true;
+    case {TMPL_TYPE_POSIT8_ES0}:  f(PositRepresentation<Posit8Es0Traits>()); return true;
+    case {TMPL_TYPE_POSIT16_ES1}: f(PositRepresentation<Posit16Es1Traits>()); return true;
+    case {TMPL_TYPE_POSIT12}:   f(PositRepresentation<Posit12Traits>()); return true;
+    case {TMPL_TYPE_POSIT24}:   f(PositRepresentation<Posit24Traits>()); return true;
+    }
+
+    return false;
+}
+
+// Calls f with a default constructed DecimalRepresentation of the type code, returns false for the
+// other types
+template <typename F>
+bool DispatchDecimal(int type, F &&f)
+{
+    switch (type)
+    {
+    case {TMPL_TYPE_DECIMAL32_BID}:  f(DecimalRepresentation<Decimal32BidTraits>()); return true;
+    case {TMPL_TYPE_DECIMAL32_DPD}:  f(DecimalRepresentation<Decimal32DpdTraits>()); return true;
+    case {TMPL_TYPE_DECIMAL64_BID}:  f(DecimalRepresentation<Decimal64BidTraits>()); return true;
+    case {TMPL_TYPE_DECIMAL64_DPD}:  f(DecimalRepresentation<Decimal64DpdTraits>()); return true;
+    case {TMPL_TYPE_DECIMAL128_BID}: f(DecimalRepresentation<Decimal128BidTraits>()); return true;
+    case {TMPL_TYPE_DECIMAL128_DPD}: f(DecimalRepresentation<Decimal128DpdTraits>()); return true;
+    }
+
+    return false;
+}
+
+// Encodings in arrays of uint64, two words per encoding for decimal128 with the low word first
+template <typename Storage>
+inline Storage LoadWords(const uint64_t *words, size_t i)
+{
+    if constexpr (sizeof(Storage) > 8)
+    {
+        return (Storage)words[2 * i + 1] << 64 | words[2 * i];
+    }
+    return words[i];
+}
+
+template <typename Storage>
+inline void StoreWords(uint64_t *words, size_t i, Storage val)
+{
+    if constexpr (sizeof(Storage) > 8)
+    {
+        words[2 * i] = (uint64_t)val;
+        words[2 * i + 1] = (uint64_t)(val >> 64);
+        return;
+    }
+    words[i] = val;
+}
+
+// Calls f with a default constructed MxFormat of the TMPL_MX_* code, returns false for unknown codes
+template <typename F>
+bool DispatchMx(int format, F &&f)
+{
+    switch (format)
+    {
+    case {TMPL_MX_FP8_E4M3}: f(MxFormat<MxFloatElement<IEEE754FloatRepresentation<OcpE4M3Traits>>>()); return true;
+    case {TMPL_MX_FP8_E5M2}: f(MxFormat<MxFloatElement<IEEE754FloatRepresentation<OcpE5M2Traits>>>()); return true;
+    case {TMPL_MX_FP4_E2M1}: f(MxFormat<MxFloatElement<IEEE754FloatRepresentation<OcpE2M1Traits>>>()); return true;
+    case {TMPL_MX_INT8}:     f(MxFormat<MxInt8Element>()); return true;
+    }
+
+    return false;
+}
+
+inline RoundingMode ToRoundingMode(int code)
+{
+    switch (code)
+    {
+    case {TMPL_ROUND_NEAREST_AWAY}: return ROUND_NEAREST_AWAY;
+    case {TMPL_ROUND_TOWARD_ZERO}:  return ROUND_TOWARD_ZERO;
+    case {TMPL_ROUND_UP}:           return ROUND_UP;
+    case {TMPL_ROUND_DOWN}:         return ROUND_DOWN;
+    }
+    return ROUND_NEAREST_EVEN;
+}
+
+extern "C" {
+
+const char* e_get_string(Editor *e, int code)
+{
+    return e->GetString(code);
+}
+
+int e_get_int(Editor *e, int code)
+{
+    return e->GetInt(code);
+}
+
+void e_set_value(Editor *e, int code, const char *valstr)
+{
+    e->SetValue(code, valstr);
+}
+
+void e_set_value_deferred(Editor *e, int code, const char *valstr)
+{
+    e->SetValueDeferred(code, valstr);
+}
+
+// Returns 1 when the value set with e_set_value_deferred is fully computed
+int e_step_job(Editor *e, int maxOps, int maxMicros)
+{
+    return e->StepJob(maxOps, maxMicros);
+}
+
+// A new editor owned by the caller, for use from a single thread at a time. Free with e_destroy.
+Editor* e_create(int code)
+{
+    switch (code)
+    {
+    case {TMPL_TYPE_BINARY16}:  return new IEEE754FloatEditor<IEEE754Float16Traits>;
+    case {TMPL_TYPE_BFLOAT16}:  return new IEEE754FloatEditor<IEEE754BFloat16Traits>;
+    case {TMPL_TYPE_MINIFLOAT}: return new IEEE754FloatEditor<IEEE754MinifloatTraits>;
+    case {TMPL_TYPE_BINARY32}:  return new IEEE754FloatEditor<IEEE754Float32Traits>;
+    case {TMPL_TYPE_BINARY64}:  return new IEEE754FloatEditor<IEEE754Float64Traits>;
+    case {TMPL_TYPE_BINARY128}: return new IEEE754FloatEditor<IEEE754Float128Traits>;
+    case {TMPL_TYPE_FLOAT80}:   return new IEEE754FloatEditor<X87ExtendedTraits>;
+    case {TMPL_TYPE_E4M3}:      return new IEEE754FloatEditor<OcpE4M3Traits>;
+    case {TMPL_TYPE_E5M2}:      return new IEEE754FloatEditor<OcpE5M2Traits>;
+    case {TMPL_TYPE_E2M1}:      return new IEEE754FloatEditor<OcpE2M1Traits>;
+    case {TMPL_TYPE_POSIT8}:    return new PositEditor<Posit8Traits>;
+    case {TMPL_TYPE_POSIT16}:   return new PositEditor<Posit16Traits>;
+    case {TMPL_TYPE_POSIT32}:   return new PositEditor<Posit32Traits>;
+    case {TMPL_TYPE_POSIT64}:   return new PositEditor<Posit64Traits>;
+    case {TMPL_TYPE_POSIT8_ES0}:  return new PositEditor<Posit8Es0Traits>;
+    case {TMPL_TYPE_POSIT16_ES1}: return new PositEditor<Posit16Es1Traits>;
+    case {TMPL_TYPE_POSIT12}:   return new PositEditor<Posit12Traits>;
+    case {TMPL_TYPE_POSIT24}:   return new PositEditor<Posit24Traits>;
+    case {TMPL_TYPE_DECIMAL32_BID}:  return new DecimalEditor<Decimal32BidTraits>;
+    case {TMPL_TYPE_DECIMAL32_DPD}:  return new DecimalEditor<Decimal32DpdTraits>;
+    case {TMPL_TYPE_DECIMAL64_BID}:  return new DecimalEditor<Decimal64BidTraits>;
+    case {TMPL_TYPE_DECIMAL64_DPD}:  return new DecimalEditor<Decimal64DpdTraits>;
+    case {TMPL_TYPE_DECIMAL128_BID}: return new DecimalEditor<Decimal128BidTraits>;
+    case {TMPL_TYPE_DECIMAL128_DPD}: return new DecimalEditor<Decimal128DpdTraits>;
+    }
+
+    return nullptr;
+}
+
+void e_destroy(Editor *e)
+{
+    delete e;
+}
+
+// Editors of the page, one per type, only constructed when their type is first selected
+Editor* get_fe(int code)
+{
+    if (code <= 0 || code >= {TMPL_TYPE_MAX})
+    {
+        return nullptr;
+    }
+
+    static Editor* gEditors[{TMPL_TYPE_MAX}] = {};
+    if (!gEditors[code])
+    {
+        gEditors[code] = e_create(code);
+    }
+    return gEditors[code];
+};
+
+// Same as TMPL_STRCODE_TYPENAME of the editor, without constructing it
+const char* get_type_name(int code)
+{
+    switch (code)
+    {
+    case {TMPL_TYPE_BINARY16}:  return IEEE754Float16Traits::TypeName;
+    case {TMPL_TYPE_BFLOAT16}:  return IEEE754BFloat16Traits::TypeName;
+    case {TMPL_TYPE_MINIFLOAT}: return IEEE754MinifloatTraits::TypeName;
+    case {TMPL_TYPE_BINARY32}:  return IEEE754Float32Traits::TypeName;
+    case {TMPL_TYPE_BINARY64}:  return IEEE754Float64Traits::TypeName;
+    case {TMPL_TYPE_BINARY128}: return IEEE754Float128Traits::TypeName;
+    case {TMPL_TYPE_FLOAT80}:   return X87ExtendedTraits::TypeName;
+    case {TMPL_TYPE_E4M3}:      return OcpE4M3Traits::TypeName;
+    case {TMPL_TYPE_E5M2}:      return OcpE5M2Traits::TypeName;
+    case {TMPL_TYPE_E2M1}:      return OcpE2M1Traits::TypeName;
+    case {TMPL_TYPE_POSIT8}:    return Posit8Traits::TypeName;
+    case {TMPL_TYPE_POSIT16}:   return Posit16Traits::TypeName;
+    case {TMPL_TYPE_POSIT32}:   return Posit32Traits::TypeName;
+    case {TMPL_TYPE_POSIT64}:   return Posit64Traits::TypeName;
+    case {TMPL_TYPE_POSIT8_ES0}:  return Posit8Es0Traits::TypeName;
+    case {TMPL_TYPE_POSIT16_ES1}: return Posit16Es1Traits::TypeName;
+    case {TMPL_TYPE_POSIT12}:   return Posit12Traits::TypeName;
+    case {TMPL_TYPE_POSIT24}:   return Posit24Traits::TypeName;
+    case {TMPL_TYPE_DECIMAL32_BID}:  return Decimal32BidTraits::TypeName;
+    case {TMPL_TYPE_DECIMAL32_DPD}:  return Decimal32DpdTraits::TypeName;
+    case {TMPL_TYPE_DECIMAL64_BID}:  return Decimal64BidTraits::TypeName;
+    case {TMPL_TYPE_DECIMAL64_DPD}:  return Decimal64DpdTraits::TypeName;
+    case {TMPL_TYPE_DECIMAL128_BID}: return Decimal128BidTraits::TypeName;
+    case {TMPL_TYPE_DECIMAL128_DPD}: return Decimal128DpdTraits::TypeName;
+    }
+
+    return nullptr;
+}
+
+// Bounds the memory of the cache of computed values shared by all editors
+void e_set_cache_limit(int bytes)
+{
+    ResultCache::Global().SetLimit(bytes);
+}
+
+int e_get_cache_bytes()
+{
+    return ResultCache::Global().Bytes();
+}
+
+// Bounds the memory of the undo and redo history of an editor
+void e_set_history_limit(Editor *e, int bytes)
+{
+    e->_history.SetLimit(bytes);
+}
+
+// Counters of the FLOATINFO_STATS build as a JSON object, {"enabled": false} in other builds.
+// The string stays valid until the next call from the same thread.
+const char* e_get_stats()
+{
+    static thread_local std::string json;
+    json = StatsJson();
+    return json.c_str();
+}
+
+void e_reset_stats()
+{
+    StatsReset();
+}
+
+// Array versions of the Ordinals queries. Encodings are passed as uint64 with the bits of the
+// type in the low bits. Return 0 for unknown types, 1 otherwise.
+int e_to_ordinals(int type, const uint64_t *vals, int64_t *out, int n)
+{
+    return DispatchRepr(type, [&](auto repr) { Ordinals<decltype(repr)>::ToOrdinals(vals, out, n); });
+}
+
+// Encodings at the ordinals, NaN or NaR where an ordinal is out of range
+int e_from_ordinals(int type, const int64_t *ords, uint64_t *out, int n)
+{
+    return DispatchRepr(type, [&](auto repr)
+    {
+        using ReprType = decltype(repr);
+        for (int i = 0; i < n; ++i)
+        {
+            if (!ReprType::FromOrdinal(ords[i], out[i]))
+            {
+                out[i] = ReprType::UnorderedValue();
+            }
+        }
+    });
+}
+
+int e_ulp_distances(int type, const uint64_t *a, const uint64_t *b, uint64_t *out, int n)
+{
+    return DispatchRepr(type, [&](auto repr) { Ordinals<decltype(repr)>::UlpDistances(a, b, out, n); });
+}
+
+int e_counts_in_range(int type, const uint64_t *lo, const uint64_t *hi, uint64_t *out, int n)
+{
+    return DispatchRepr(type, [&](auto repr) { Ordinals<decltype(repr)>::CountsInRange(lo, hi, out, n); });
+}
+
+// Number of encodings of the type in each class, counts[c] for each TMPL_VALUECLASS_* c, see
+// ValueCounts. counts needs TMPL_VALUECLASS_MAX entries. Returns 0 for unknown types.
+int e_class_counts(int type, uint64_t *counts)
+{
+    return DispatchRepr(type, [&](auto repr) { ValueCounts<decltype(repr)>::ClassCounts(counts); });
+}
+
+// Number of encodings with integer values, and the largest N with every integer in [0, N]
+// representable
+int e_integer_counts(int type, uint64_t *numIntegers, uint64_t *maxContiguous)
+{
+    return DispatchRepr(type, [&](auto repr)
+    {
+        *numIntegers = ValueCounts<decltype(repr)>::NumIntegers();
+        *maxContiguous = ValueCounts<decltype(repr)>::MaxContiguousInteger();
+    });
+}
+
+// Number of distinct values in each [lo[i], hi[i]), without going through the encodings
+int e_counts_between(int type, const double *lo, const double *hi, uint64_t *out, int n)
+{
+    using DoubleFormat = SoftFloatFormat<IEEE754FloatRepresentation<IEEE754Float64Traits>>;
+    return DispatchRepr(type, [&](auto repr)
+    {
+        for (int i = 0; i < n; ++i)
+        {
+            uint64_t loBits, hiBits;
+            memcpy(&loBits, &lo[i], 8);
+            memcpy(&hiBits, &hi[i], 8);
+            out[i] = ValueCounts<decltype(repr)>::CountBetween(DoubleFormat::Unpack(loBits), DoubleFormat::Unpack(hiBits));
+        }
+    });
+}
+
+// Values ks[i] steps after vals[i], NaN or NaR where that is past the ends
+int e_kth_after(int type, const uint64_t *vals, const int64_t *ks, uint64_t *out, int n)
+{
+    return DispatchRepr(type, [&](auto repr)
+    {
+        using ReprType = decltype(repr);
+        for (int i = 0; i < n; ++i)
+        {
+            if (!Ordinals<ReprType>::KthAfter(vals[i], ks[i], out[i]))
+            {
+                out[i] = ReprType::UnorderedValue();
+            }
+        }
+    });
+}
+
+// Keys of the n values of vals into out, see ToTotalOrderKey. Returns 0 for unknown types.
+int e_total_order_keys(int type, const uint64_t *vals, uint64_t *out, int n)
+{
+    return DispatchRepr(type, [&](auto repr) { TotalOrder<decltype(repr)>::ToKeys(vals, out, n); });
+}
+
+// Sorts the n values of vals in place, in IEEE 754 totalOrder or in the order of posits with NaR
+// first, on up to numThreads threads. Returns 0 for unknown types.
+int e_sort(int type, uint64_t *vals, int n, int numThreads)
+{
+    return DispatchRepr(type, [&](auto repr) { TotalOrder<decltype(repr)>::Sort(vals, n, numThreads); });
+}
+
+// Merges the sorted arrays a and b into out, which needs room for na + nb values, dropping
+// duplicate encodings. With nb = 0 and out = a it deduplicates a in place. Returns the number of
+// values written, or -1 for unknown types.
+int e_merge_unique(int type, const uint64_t *a, int na, const uint64_t *b, int nb, uint64_t *out)
+{
+    int numWritten = -1;
+    DispatchRepr(type, [&](auto repr) { numWritten = TotalOrder<decltype(repr)>::MergeUnique(a, na, b, nb, out); });
+    return numWritten;
+}
+
+// Array at a time soft float arithmetic, out[i] = a[i] op b[i], or op(a[i]) for sqrt and
+// a[i] * b[i] + c[i] for fma. Unused inputs may be null. Rounding is one of TMPL_ROUND_*, and only
+// applies to the IEEE types. Returns 0 for unknown types or ops, 1 otherwise.
+int e_soft_float(int type, int op, int rounding, const uint64_t *a, const uint64_t *b, const uint64_t *c, uint64_t *out, int n)
+{
+    RoundingMode mode = ToRoundingMode(rounding);
+    bool found = false;
+    bool ok = DispatchRepr(type, [&](auto repr)
+    {
+        using SF = SoftFloat<decltype(repr)>;
+        found = true;
+        switch (op)
+        {
+        case {TMPL_SOFTOP_ADD}:  SF::Add(a, b, out, n, mode); break;
+        case {TMPL_SOFTOP_SUB}:  SF::Sub(a, b, out, n, mode); break;
+        case {TMPL_SOFTOP_MUL}:  SF::Mul(a, b, out, n, mode); break;
+        case {TMPL_SOFTOP_DIV}:  SF::Div(a, b, out, n, mode); break;
+        case {TMPL_SOFTOP_SQRT}: SF::Sqrt(a, out, n, mode); break;
+        case {TMPL_SOFTOP_FMA}:  SF::Fma(a, b, c, out, n, mode); break;
+        default: found = false;
+        }
+    });
+    return ok && found;
+}
+
+// The value of the editor converted to each of the numTypes types, which must fit 64 bits, rounded
+// with TMPL_ROUND_* which only applies to the IEEE types. Each gets its encoding, its value as the
+// nearest double, a TMPL_CONVERT_* status and its error relative to the value. Returns 0 for unknown
+// types, 1 otherwise.
+int e_convert(Editor *e, int rounding, const int *types, int numTypes, uint64_t *reprs, double *values, int *statuses, double *relErrors)
+{
+    Unpacked value = e->Unpack();
+    RoundingMode mode = ToRoundingMode(rounding);
+    for (int i = 0; i < numTypes; ++i)
+    {
+        bool ok = DispatchRepr(types[i], [&](auto repr)
+        {
+            Conversion<decltype(repr)>::Convert(value, mode, reprs[i], values[i], statuses[i], relErrors[i]);
+        });
+        if (!ok)
+        {
+            return 0;
+        }
     }
+    return 1;
+}
 
-    void recompute()
+// Streams TMPL_STRCODE_EXACT_BASE10 of the value of an editor a piece at a time, without rendering
+// the whole of it. Returns null for values without one, like NaN and infinities, otherwise a stream
+// to be freed with e_exact_stream_end. The stream does not follow later changes of the editor.
+ExactDecimalStream* e_exact_stream_begin(const Editor *e)
+{
+    ExactDecimalStream *stream = new ExactDecimalStream();
+    if (!e->StartExactStream(*stream))
     {
-        _value = ReprType::GetValue(_repr);
+        delete stream;
+        return nullptr;
+    }
+    return stream;
+}
 
+// Writes the next at most bufSize - 1 characters of the stream to buf, null terminated, and
+// returns their number, 0 once the whole text was written. bufSize must be at least 2.
+int e_exact_stream_next(ExactDecimalStream *stream, char *buf, int bufSize)
+{
+    std::string chunk;
+    stream->Next(chunk, bufSize - 1);
+    memcpy(buf, chunk.c_str(), chunk.size() + 1);
+    return chunk.size();
+}
 
-        _math.clear();
-        if (_repr == ReprType::NaR() || _repr == ReprType::Zero())
-        {
-            _math = "";
-        }
-        else
-        {
-            for (int rep = 0; rep <= 1; ++rep)
-            {
+void e_exact_stream_end(ExactDecimalStream *stream)
+{
+    delete stream;
+}
 
-                _math += R"(<math xmlns="http://www.w3.org/1998/Math/MathML" display="block">)";
-                _math +=    "<mrow>";
-                _math +=      "<mi>value</mi>";
-                _math +=      "<mo>=</mo>";
-                _math +=      "<mo>(</mo>";
-                _math +=       "<mo>(</mo>";
-                _math +=        "<mn>1</mn>";
-                _math +=        "<mo>-</mo>";
-                _math +=        "<mn>3</mn>";
-                _math +=        "<mo>×</mo>";
+// Compiles an expression of +, -, *, /, parentheses, decimal literals and variables for
+// e_expr_eval and e_expr_sweep, see Expression.cpp. Always returns an expression, to be freed with
+// e_expr_destroy, whose e_expr_error is empty when it compiled.
+Expression* e_expr_compile(const char *text)
+{
+    Expression *expr = new Expression();
+    expr->Compile(text);
+    return expr;
+}
 
-                if (rep == 0) _math += "<mi class=\"identifier\" data-ic=\"{TMPL_IDENTIFIER_SIGN}\">s</mi>";
-                else          _math += "<mn class=\"identifier\" data-ic=\"{TMPL_IDENTIFIER_SIGN}\">" + std::to_string(ReprType::GetSignBit(_repr)) + "</mn>";
+void e_expr_destroy(Expression *expr)
+{
+    delete expr;
+}
 
-                _math +=       "<mo>)</mo>";
-                _math +=       "<mo>+</mo>";
-                _math +=       "<mfrac>";
+const char* e_expr_error(const Expression *expr)
+{
+    return expr->error.c_str();
+}
 
-                if (rep == 0) _math += "<mi class=\"identifier\" data-ic=\"{TMPL_IDENTIFIER_MANTISSA}\">mantissa</mi>";
-                else          _math += "<mn class=\"identifier\" data-ic=\"{TMPL_IDENTIFIER_MANTISSA}\">" + std::to_string(ReprType::GetMantissa(_repr)) + "</mn>";
+int e_expr_num_vars(const Expression *expr)
+{
+    return expr->varNames.size();
+}
 
-                _math +=        "<msup>";
-                _math +=         "<mn>2</mn>";
+// Name of variable i in the order of first use, null when there is no such variable
+const char* e_expr_var_name(const Expression *expr, int i)
+{
+    if (i < 0 || i >= (int)expr->varNames.size())
+    {
+        return nullptr;
+    }
+    return expr->varNames[i].c_str();
+}
 
-                if (rep == 0) _math += "<mi class=\"identifier\" data-ic=\"{TMPL_IDENTIFIER_MBITS}\">mbits</mi>";
-                else          _math += "<mn class=\"identifier\" data-ic=\"{TMPL_IDENTIFIER_MBITS}\">" + std::to_string(ReprType::NumMantissaBits(_repr)) + "</mn>";
+// Runs expr on n points of the type, with e_expr_num_vars encodings per point in vars, into out.
+// When ulpErrors or relErrors is given the expression is also evaluated exactly, and each result
+// is compared to it, see ExpressionEvaluator::Evaluate. Any output may be null. Rounding is one of
+// TMPL_ROUND_*, and only applies to the IEEE types. Returns 0 for unknown types and expressions
+// that did not compile.
+int e_expr_eval(const Expression *expr, int type, int rounding, const uint64_t *vars, int n, uint64_t *out, uint64_t *ulpErrors, double *relErrors, int numThreads)
+{
+    ExpressionFormat format;
+    if (!expr->error.empty() || !DispatchRepr(type, [&](auto repr) { format = ExpressionFormat::Of<decltype(repr)>(); }))
+    {
+        return 0;
+    }
+    ExpressionEvaluator::EvaluatePoints(*expr, format, ToRoundingMode(rounding), vars, n, out, ulpErrors, relErrors, numThreads);
+    return 1;
+}
 
-                _math +=        "</msup>";
-                _math +=       "</mfrac>";
-                _math +=      "<mo>)</mo>";
-                _math +=      "<mo>×</mo>";
-                _math +=      "<msup>";
-                _math +=       "<mn>2</mn>";
-                _math +=       "<mrow>";
-                _math +=        "<mo>(</mo>";
-                _math +=         "<mn>1</mn>";
-                _math +=         "<mo>-</mo>";
-                _math +=         "<mn>2</mn>";
-                _math +=         "<mo>×</mo>";
+// As e_expr_eval, on the grid where variable v runs over counts[v] consecutive encodings from
+// lo[v] in the order of their values, with the last variable changing fastest. The outputs need
+// room for the product of the counts. Returns 0 for unknown types, expressions that did not
+// compile, and empty or huge grids.
+int e_expr_sweep(const Expression *expr, int type, int rounding, const uint64_t *lo, const int64_t *counts, uint64_t *out, uint64_t *ulpErrors, double *relErrors, int numThreads)
+{
+    ExpressionFormat format;
+    if (!expr->error.empty() || !DispatchRepr(type, [&](auto repr) { format = ExpressionFormat::Of<decltype(repr)>(); }))
+    {
+        return 0;
+    }
+    return ExpressionEvaluator::Sweep(*expr, format, ToRoundingMode(rounding), lo, counts, out, ulpErrors, relErrors, numThreads);
+}
 
-                if (rep == 0) _math += "<mi class=\"identifier\" data-ic=\"{TMPL_IDENTIFIER_SIGN}\">s</mi>";
-                else          _math += "<mn class=\"identifier\" data-ic=\"{TMPL_IDENTIFIER_SIGN}\">" + std::to_string(ReprType::GetSignBit(_repr)) + "</mn>";
+// Sum of a[i] * b[i] rounded once, accumulated exactly in the quire of the type, into out.
+// Rounding is one of TMPL_ROUND_*, and only applies to the IEEE types. Returns 0 for unknown types.
+int e_dot(int type, const uint64_t *a, const uint64_t *b, int n, int rounding, uint64_t *out)
+{
+    RoundingMode mode = ToRoundingMode(rounding);
+    return DispatchRepr(type, [&](auto repr)
+    {
+        Quire<decltype(repr)> quire;
+        quire.AddProducts(a, b, n);
+        *out = quire.Round(mode);
+    });
+}
 
-                _math +=        "<mo>)</mo>";
-                _math +=        "<mo>×</mo>";
-                _math +=        "<mo>(</mo>";
-                _math +=         "<mn>4</mn>";
-                _math +=         "<mo>×</mo>";
+// f of each of the n values of vals, correctly rounded, into out. Function is one of TMPL_MATH_*.
+// Returns 0 when the tables of the type are not compiled in, see MathTables.cpp.
+int e_math(int type, int function, const uint64_t *vals, uint64_t *out, int n)
+{
+    MathFunction f;
+    switch (function)
+    {
+    case {TMPL_MATH_EXP}:        f = MATH_EXP; break;
+    case {TMPL_MATH_LOG}:        f = MATH_LOG; break;
+    case {TMPL_MATH_SIN}:        f = MATH_SIN; break;
+    case {TMPL_MATH_COS}:        f = MATH_COS; break;
+    case {TMPL_MATH_SQRT}:       f = MATH_SQRT; break;
+    case {TMPL_MATH_RECIPROCAL}: f = MATH_RECIPROCAL; break;
+    default: return 0;
+    }
 
-                if (rep == 0) _math += "<mi class=\"identifier\" data-ic=\"{TMPL_IDENTIFIER_REGIME}\">r</mi>";
-                else          _math += "<mn class=\"identifier\" data-ic=\"{TMPL_IDENTIFIER_REGIME}\">" + std::to_string(ReprType::GetRegime(_repr)) + "</mn>";
+    bool available = false;
+    DispatchRepr(type, [&](auto repr)
+    {
+        using Repr = decltype(repr);
+        if constexpr (MathTableData<Repr>::IsAvailable)
+        {
+            MathTable<Repr>::Eval(f, vals, out, n);
+            available = true;
+        }
+    });
+    return available;
+}
 
-                _math +=         "<mo>+</mo>";
+// Class (TMPL_VALUECLASS_*) of each of the n values of vals into out. Returns 0 for unknown types.
+int e_value_classes(int type, const uint64_t *vals, int *out, int n)
+{
+    return DispatchRepr(type, [&](auto repr)
+    {
+        for (int i = 0; i < n; ++i)
+        {
+            out[i] = decltype(repr)::ValueClass(vals[i]);
+        }
+    });
+}
 
-                if (rep == 0) _math += "<mi class=\"identifier\" data-ic=\"{TMPL_IDENTIFIER_EXPONENT}\">e</mi>";
-                else          _math += "<mn class=\"identifier\" data-ic=\"{TMPL_IDENTIFIER_EXPONENT}\">" + std::to_string(ReprType::GetExponent(_repr)) + "</mn>";
+// Every single-bit flip of each of the n values of vals, see BitFlips. Each output has NumBits
+// entries per value, for bit 0 up. Returns NumBits, or 0 for unknown types.
+int e_bit_flips(int type, const uint64_t *vals, int n, uint64_t *reprs, double *values, double *relErrors, int *classes)
+{
+    int numBits = 0;
+    DispatchRepr(type, [&](auto repr)
+    {
+        using Flips = BitFlips<decltype(repr)>;
+        Flips::Compute(vals, n, reprs, values, relErrors, classes);
+        numBits = Flips::NumBits;
+    });
+    return numBits;
+}
 
-                _math +=         "<mo>+</mo>";
+// Decodes numBlocks MX blocks of the TMPL_MX_* format to 32 binary32 values each. Returns the bytes
+// per block, or 0 for unknown formats.
+int e_mx_decode(int format, const uint8_t *blocks, int numBlocks, float *out)
+{
+    int bytesPerBlock = 0;
+    DispatchMx(format, [&](auto mx)
+    {
+        mx.Decode(blocks, numBlocks, out);
+        bytesPerBlock = mx.BytesPerBlock;
+    });
+    return bytesPerBlock;
+}
 
-                if (rep == 0) _math += "<mi class=\"identifier\" data-ic=\"{TMPL_IDENTIFIER_SIGN}\">s</mi>";
-                else          _math += "<mn class=\"identifier\" data-ic=\"{TMPL_IDENTIFIER_SIGN}\">" + std::to_string(ReprType::GetSignBit(_repr)) + "</mn>";
+// Encodes numBlocks * 32 binary32 values to MX blocks of the TMPL_MX_* format. Returns the bytes per
+// block, or 0 for unknown formats.
+int e_mx_encode(int format, const float *in, int numBlocks, uint8_t *blocks)
+{
+    int bytesPerBlock = 0;
+    DispatchMx(format, [&](auto mx)
+    {
+        mx.Encode(in, numBlocks, blocks);
+        bytesPerBlock = mx.BytesPerBlock;
+    });
+    return bytesPerBlock;
+}
 
-                _math +=        "<mo>)</mo>";
-                _math +=       "</mrow>";
-                _math +=      "</msup>";
-                _math +=     "</mrow>";
-                _math += R"(</math>)";
-            }
+// Decodes n encodings of a decimal type. Encodings and coefficients take one word each, or two for
+// decimal128 with the low word first. Exponents are unbiased, the value is
+// (-1)**sign * coefficient * 10**exponent, and classes are TMPL_VALUECLASS_*. Infinities and NaNs
+// have exponent 0, and NaNs their payload as the coefficient. Returns the words per encoding, or 0
+// for types that are not decimal.
+int e_decimal_decode(int type, const uint64_t *vals, int n, int *signs, uint64_t *coefficients, int *exponents, int *classes)
+{
+    int numWords = 0;
+    DispatchDecimal(type, [&](auto repr)
+    {
+        using ReprType = decltype(repr);
+        using Storage = typename ReprType::Storage;
+        for (int i = 0; i < n; ++i)
+        {
+            typename ReprType::Fields f = ReprType::Codec::Decode(LoadWords<Storage>(vals, i));
+            signs[i] = f.sign;
+            StoreWords<Storage>(coefficients, i, f.coefficient);
+            exponents[i] = f.kind == ReprType::Codec::Finite ? f.exponent - ReprType::Bias : 0;
+            classes[i] = ReprType::ValueClass(f);
+        }
+        numWords = sizeof(Storage) / 8;
+    });
+    return numWords;
+}
 
+// Converts n encodings between the BID and DPD encodings of a decimal width, or to the canonical
+// encodings of the same type. Returns the words per encoding, or 0 if the types are not decimal
+// types of the same width.
+int e_decimal_convert(int fromType, int toType, const uint64_t *vals, int n, uint64_t *out)
+{
+    int numWords = 0;
+    DispatchDecimal(fromType, [&](auto fromRepr)
+    {
+        DispatchDecimal(toType, [&](auto toRepr)
+        {
+            using From = typename decltype(fromRepr)::Codec;
+            using To = typename decltype(toRepr)::Codec;
+            if constexpr (From::NumDeclets == To::NumDeclets)
+            {
+                using Storage = typename From::Storage;
+                for (int i = 0; i < n; ++i)
+                {
+                    typename From::Fields f = From::Decode(LoadWords<Storage>(vals, i));
+                    StoreWords<Storage>(out, i, To::Encode({ (typename To::Kind)f.kind, f.sign, f.exponent, f.coefficient }));
+                }
+                numWords = sizeof(Storage) / 8;
+            }
+        });
+    });
+    return numWords;
+}
 
-            int signImplicitTerm = 1 - 3 * (int)ReprType::GetSignBit(_repr);
-            int finalEqPow = (1 - 2 * (int)ReprType::GetSignBit(_repr)) * (4 * ReprType::GetRegime(_repr) + ReprType::GetExponent(_repr) + (int)ReprType::GetSignBit(_repr));
+// Editor::Enumerate on an editor of its own, so it can be called from any thread, with the default
+// precision of TMPL_STRCODE_SCIENTIFIC. Returns the number of lines written, 0 for unknown types.
+int e_enumerate(int type, char *reprStr, int count, const int *codes, int numCodes, char *buf, int bufSize)
+{
+    Editor *e = e_create(type);
+    if (!e)
+    {
+        return 0;
+    }
+    int numWritten = e->Enumerate(reprStr, count, codes, numCodes, buf, bufSize);
+    e_destroy(e);
+    return numWritten;
+}
 
-            _math += "<div class=\"large-content\">";
-            _math +=  "<math xmlns=\"http://www.w3.org/1998/Math/MathML\" display=\"block\">";
-            _math +=   "<mrow>";
-            _math +=     "<mo>=</mo>";
-            _math +=     "<mo>(</mo>";
-            _math +=      "<mn>" + std::to_string(signImplicitTerm) + "</mn>";
-            _math +=      "<mo>+</mo>";
-            _math +=       "<mfrac>";
-            _math +=        "<mn>" + std::to_string(ReprType::GetMantissa(_repr)) + "</mn>";
-            _math +=        "<msup>";
-            _math +=         "<mn>2</mn>";
-            _math +=          "<mn>" + std::to_string(ReprType::NumMantissaBits(_repr)) + "</mn>";
-            _math +=        "</msup>";
-            _math +=       "</mfrac>";
-            _math +=     "<mo>)</mo>";
-            _math +=     "<mo>×</mo>";
-            _math +=     "<msup>";
-            _math +=      "<mn>2</mn>";
-            _math +=      "<mn>" + std::to_string(finalEqPow) + "</mn>";
-            _math +=     "</msup>";
-            _math +=   "</mrow>";
-            _math +=  "</math>";
-            _math += "</div>";
+}
 
+#ifdef RUN_TEST_FLOATINFO
 
-            int64_t topn = ReprType::GetMantissa(_repr) + signImplicitTerm * (1ll << ReprType::NumMantissaBits(_repr));
-            bool isNeg = topn < 0;
-            if (isNeg)
-            {
-                topn = -topn;
-            }
-            SimpleNumber top(topn);
-            int finalPow = finalEqPow - ReprType::NumMantissaBits(_repr);
+#include <float.h>
+#include <stdio.h>
 
-            _math += "<div class=\"large-content\">";
-            _math +=  "<math xmlns=\"http://www.w3.org/1998/Math/MathML\" display=\"block\">";
-            _math +=   "<mrow>";
-            _math +=     "<mo>=</mo>";
-            if (isNeg) _math += "<mo>-</mo>";
-            _math +=     "<mn>" + top.render10() + "</mn>";
-            _math +=     "<mo>×</mo>";
-            _math +=      "<msup>";
-            _math +=       "<mn>2</mn>";
-            _math +=       "<mn>" + std::to_string(finalPow) + "</mn>";
-            _math +=      "</msup>";
-            _math +=   "</mrow>";
-            _math +=  "</math>";
-            _math += "</div>";
+// Tests of the editors, and of the parts that need the representations so do not build on their own
+// like the RUN_TEST of SimpleBigInt.cpp. Build with `ninja out/floatinfo-test`.
 
-            if (finalPow < 0)
-            {
-                _math += "<div class=\"large-content\">";
-                _math +=  "<math xmlns=\"http://www.w3.org/1998/Math/MathML\" display=\"block\">";
-                _math +=   "<mrow>";
-                _math +=     "<mo>=</mo>";
-                if (isNeg) _math += "<mo>-</mo>";
-                _math +=     "<mfrac>";
-                _math +=      "<mn>" + top.render10() + "</mn>";
-                _math +=      "<mn>" + SimpleNumber::pow2(-finalPow).render10() + "</mn>";
-                _math +=     "</mfrac>";
-                _math +=   "</mrow>";
-                _math +=  "</math>";
-                _math += "</div>";
-            }
-            else
+// Strings of a new editor, and after undoing back to its first value, are those of setting the
+// same encoding
+static bool TestInitialStrings()
+{
+    int bad = 0;
+    for (int type = 1; type < {TMPL_TYPE_MAX}; ++type)
+    {
+        Editor *e = e_create(type);
+        Editor *expected = e_create(type);
+        std::string hash = e->GetString({TMPL_STRCODE_URLHASH});
+        expected->SetValue({TMPL_SET_ONE}, nullptr);
+        expected->SetValue({TMPL_SET_REPRSTR}, hash.substr(hash.find('=') + 1).c_str());
+        for (int pass = 0; pass < 2; ++pass)
+        {
+            bad += *e->GetString({TMPL_STRCODE_EXACT_BASE10}) == '\0';
+            for (int code = 1; code < {TMPL_STRCODE_MAX}; ++code)
             {
-                _math += "<div class=\"large-content\">";
-                _math +=  "<math xmlns=\"http://www.w3.org/1998/Math/MathML\" display=\"block\">";
-                _math +=   "<mrow>";
-                _math +=     "<mo>=</mo>";
-                if (isNeg) _math += "<mo>-</mo>";
-                _math +=     "<mn>" + (top * SimpleNumber::pow2(finalPow)).render10() + "</mn>";
-                _math +=   "</mrow>";
-                _math +=  "</math>";
-                _math += "</div>";
+                bad += std::string(e->GetString(code)) != expected->GetString(code);
             }
+            e->SetValue({TMPL_SET_ONE}, nullptr);
+            e->SetValue({TMPL_SET_UNDO}, nullptr);
         }
+        e_destroy(e);
+        e_destroy(expected);
     }
+    return bad == 0;
+}
 
-    uint64_t _repr;
-    SimpleNumber _value;
-    std::string _math;
-};
+// Undoing back to a value whose job was stopped part way computes it again, and its strings
+// are not those left by the stopped job
+static bool TestUndoPartialJob()
+{
+    int bad = 0;
+    for (int type : { {TMPL_TYPE_BINARY128}, {TMPL_TYPE_POSIT64} })
+    {
+        Editor *expected = e_create(type);
+        Editor *e = e_create(type);
+        e->SetValue({TMPL_SET_MAX}, nullptr);
+        std::string max = e->GetString({TMPL_STRCODE_EXACT_BASE10});
+        e->SetValueDeferred({TMPL_SET_MIN}, nullptr);
+        e->StepJob(1, 0);
+        bad += !e->GetInt({TMPL_BOOL_IS_COMPUTING});
+        e->SetValue({TMPL_SET_ONE}, nullptr);
+        std::string one = e->GetString({TMPL_STRCODE_EXACT_BASE10});
+
+        e->SetValueDeferred({TMPL_SET_UNDO}, nullptr);
+        while (!e->StepJob(1000, 0))
+        {
+        }
+        std::string hash = e->GetString({TMPL_STRCODE_URLHASH});
+        expected->SetValue({TMPL_SET_REPRSTR}, hash.substr(hash.find('=') + 1).c_str());
+        for (int code : { {TMPL_STRCODE_EXACT_BASE10}, {TMPL_STRCODE_EXACT_BASE2}, {TMPL_STRCODE_MATH} })
+        {
+            bad += std::string(e->GetString(code)) != expected->GetString(code);
+            bad += *e->GetString(code) == '\0' && code != {TMPL_STRCODE_MATH};
+        }
 
-extern "C" {
+        e->SetValue({TMPL_SET_REDO}, nullptr);
+        bad += e->GetString({TMPL_STRCODE_EXACT_BASE10}) != one;
+        e->SetValue({TMPL_SET_UNDO}, nullptr);
+        bad += e->GetString({TMPL_STRCODE_EXACT_BASE10}) != std::string(expected->GetString({TMPL_STRCODE_EXACT_BASE10}));
+        e->SetValue({TMPL_SET_UNDO}, nullptr);
+        bad += e->GetString({TMPL_STRCODE_EXACT_BASE10}) != max;
+        e_destroy(e);
+        e_destroy(expected);
+    }
+    return bad == 0;
+}
 
-const char* e_get_string(Editor *e, int code)
+// Enumerating a type in chunks writes the same lines as at once, and stops after its last value
+static bool TestEnumerateEnd()
 {
-    return e->GetString(code);
+    int bad = 0;
+    const int codes[] = { {TMPL_STRCODE_URLHASH}, {TMPL_STRCODE_EXACT_BASE10} };
+    for (int type : { {TMPL_TYPE_E2M1}, {TMPL_TYPE_POSIT8} })
+    {
+        Editor *e = e_create(type);
+        e->SetValue({TMPL_SET_MAX}, nullptr);
+        e->SetValue({TMPL_SET_NEGATE}, nullptr);
+        std::string hash = e->GetString({TMPL_STRCODE_URLHASH});
+        std::string start = hash.substr(hash.find('=') + 1);
+        e_destroy(e);
+
+        char reprStr[64];
+        static char buf[1 << 16];
+        strcpy(reprStr, start.c_str());
+        int numAll = e_enumerate(type, reprStr, 1000, codes, 2, buf, sizeof(buf));
+        std::string all = buf;
+        bad += reprStr[0] != '\0' || numAll < 2 || numAll != std::count(all.begin(), all.end(), '\n');
+
+        std::string chunks;
+        int numChunks = 0;
+        strcpy(reprStr, start.c_str());
+        while (reprStr[0] != '\0')
+        {
+            int n = e_enumerate(type, reprStr, 3, codes, 2, buf, sizeof(buf));
+            if (n == 0)
+            {
+                ++bad;
+                break;
+            }
+            numChunks += n;
+            chunks += buf;
+        }
+        bad += chunks != all || numChunks != numAll;
+        bad += e_enumerate(type, reprStr, 3, codes, 2, buf, sizeof(buf)) != 0 || buf[0] != '\0';
+    }
+    return bad == 0;
 }
 
-int e_get_int(Editor *e, int code)
+// Every ordinal between the ends of a 16-bit type belongs to one encoding and round trips, except
+// that both IEEE zeros are 0 and come back as +0. NaNs and NaR are unordered.
+template <typename ReprType>
+static int CheckOrdinals16(int numZeros)
 {
-    return e->GetInt(code);
+    int bad = 0;
+    int64_t maxOrd = ReprType::MaxOrdinal();
+    std::vector<int> hits(2 * maxOrd + 1);
+    for (uint64_t val = 0; val < 0x10000; ++val)
+    {
+        int64_t ord = ReprType::ToOrdinal(val);
+        if (ord == NanOrdinal)
+        {
+            continue;
+        }
+        uint64_t back = ~0ull;
+        if (ord < -maxOrd || ord > maxOrd || !ReprType::FromOrdinal(ord, back))
+        {
+            ++bad;
+            continue;
+        }
+        bad += back != (ord == 0 ? 0 : val);
+        ++hits[ord + maxOrd];
+    }
+    for (int64_t ord = -maxOrd; ord <= maxOrd; ++ord)
+    {
+        bad += hits[ord + maxOrd] != (ord == 0 ? numZeros : 1);
+    }
+    uint64_t val;
+    bad += ReprType::FromOrdinal(maxOrd + 1, val) || ReprType::FromOrdinal(-maxOrd - 1, val);
+    return bad;
 }
 
-void e_set_value(Editor *e, int code, const char *valstr)
+// Ordinals, ulp distances and steps at the zeros, infinities and NaNs, and the total order
+static bool TestOrdinals()
 {
-    e->SetValue(code, valstr);
+    int bad = CheckOrdinals16<IEEE754FloatRepresentation<IEEE754Float16Traits>>(2);
+    bad += CheckOrdinals16<PositRepresentation<Posit16Traits>>(1);
+
+    using Binary64 = IEEE754FloatRepresentation<IEEE754Float64Traits>;
+    using Ords = Ordinals<Binary64>;
+    auto bits = [](double d) { uint64_t u; memcpy(&u, &d, 8); return u; };
+    const uint64_t inf = bits(INFINITY), zero = bits(0.0), negZero = bits(-0.0);
+    const uint64_t denormMin = bits(4.9406564584124654e-324), nan = bits(NAN), negNan = bits(-NAN);
+    const int64_t maxOrd = Binary64::MaxOrdinal();
+
+    bad += Binary64::ToOrdinal(zero) != 0 || Binary64::ToOrdinal(negZero) != 0;
+    bad += Binary64::ToOrdinal(denormMin) != 1 || Binary64::ToOrdinal(denormMin | negZero) != -1;
+    bad += Binary64::ToOrdinal(inf) != maxOrd || Binary64::ToOrdinal(inf | negZero) != -maxOrd;
+    bad += Binary64::ToOrdinal(bits(DBL_MAX)) != maxOrd - 1;
+    bad += Binary64::ToOrdinal(nan) != NanOrdinal || Binary64::ToOrdinal(negNan) != NanOrdinal;
+    bad += Binary64::ToOrdinal(inf + 1) != NanOrdinal;
+
+    uint64_t val;
+    bad += !Binary64::FromOrdinal(0, val) || val != zero;
+    bad += !Binary64::FromOrdinal(-maxOrd, val) || val != (inf | negZero);
+    bad += Binary64::FromOrdinal(maxOrd + 1, val) || Binary64::FromOrdinal(-maxOrd - 1, val);
+
+    bad += Ords::UlpDistance(negZero, zero) != 0 || Ords::UlpDistance(denormMin | negZero, denormMin) != 2;
+    bad += Ords::UlpDistance(inf | negZero, inf) != 2 * (uint64_t)maxOrd;
+    bad += Ords::UlpDistance(nan, zero) != Ords::Unordered || Ords::UlpDistance(negNan, negNan) != Ords::Unordered;
+    bad += Ords::CountInRange(negZero, zero) != 1 || Ords::CountInRange(inf | negZero, inf) != 2 * (uint64_t)maxOrd + 1;
+    bad += Ords::CountInRange(inf, inf | negZero) != 0 || Ords::CountInRange(zero, nan) != 0;
+    bad += !Ords::KthAfter(bits(DBL_MAX), 1, val) || val != inf;
+    bad += !Ords::KthAfter(negZero, -1, val) || val != (denormMin | negZero);
+    bad += Ords::KthAfter(inf, 1, val) || Ords::KthAfter(nan, 0, val);
+
+    // The 64-bit posits span all of int64 but its minimum, which is NaR
+    using Posit64 = PositRepresentation<Posit64Traits>;
+    const uint64_t maxPos = Posit64::MaxFinite();
+    bad += Posit64::ToOrdinal(Posit64::NaR()) != NanOrdinal || Posit64::ToOrdinal(maxPos + 2) != -(int64_t)maxPos;
+    bad += Ordinals<Posit64>::UlpDistance(maxPos + 2, maxPos) != ~1ull;
+    bad += Ordinals<Posit64>::KthAfter(maxPos, INT64_MAX, val) || Ordinals<Posit64>::KthAfter(maxPos + 2, INT64_MIN, val);
+    bad += !Ordinals<Posit64>::KthAfter(maxPos + 2, INT64_MAX, val) || val != 0;
+
+    // -NaN < -inf < -0 < +0 < +inf < +NaN
+    uint64_t vals[] = { nan, zero, inf, negZero, negNan, bits(1.0), inf | negZero };
+    const uint64_t sorted[] = { negNan, inf | negZero, negZero, zero, bits(1.0), inf, nan };
+    TotalOrder<Binary64>::Sort(vals, 7, 1);
+    bad += memcmp(vals, sorted, sizeof(vals)) != 0;
+    return bad == 0;
 }
 
-Editor* get_fe(int code)
+// The cache drops its least recently used entries first, where lookups that hit count as uses,
+// and holds the bytes of the entries it keeps
+static bool TestResultCache()
 {
-    static IEEE754FloatEditor<IEEE754Float16Traits> gBinary16;
-    static IEEE754FloatEditor<IEEE754BFloat16Traits> gBFloat16;
-    static IEEE754FloatEditor<IEEE754MinifloatTraits> gMinifloat;
-    static IEEE754FloatEditor<IEEE754Float32Traits> gBinary32;
-    static IEEE754FloatEditor<IEEE754Float64Traits> gBinary64;
-
-    static PositEditor<Posit8Traits> gPosit8;
-    static PositEditor<Posit16Traits> gPosit16;
-    static PositEditor<Posit32Traits> gPosit32;
-    static PositEditor<Posit64Traits> gPosit64;
+    int bad = 0;
+    ResultCache cache;
+    auto entry = [](uint64_t repr, std::string math = "math")
+    {
+        return ResultCache::Entry{PackedDigits::Pack(std::to_string(repr), 10), PackedDigits::Pack("1", 2), math};
+    };
+    auto has = [&](int type, uint64_t repr)
+    {
+        ResultCache::Entry out;
+        return cache.Lookup(type, repr, out) && out.exact10.Unpack() == std::to_string(repr);
+    };
 
-    switch (code)
+    // Room for three entries
+    size_t entryBytes = entry(1).Bytes();
+    cache.SetLimit(3 * entryBytes);
+    for (uint64_t repr = 1; repr <= 3; ++repr)
     {
-    case {TMPL_TYPE_BINARY16}: return &gBinary16;
-    case {TMPL_TYPE_BFLOAT16}: return &gBFloat16;
-    case {TMPL_TYPE_MINIFLOAT}: return &gMinifloat;
-    case {TMPL_TYPE_BINARY32}: return &gBinary32;
-    case {TMPL_TYPE_BINARY64}: return &gBinary64;
-    case {TMPL_TYPE_POSIT8}: return &gPosit8;
-    case {TMPL_TYPE_POSIT16}: return &gPosit16;
-    case {TMPL_TYPE_POSIT32}: return &gPosit32;
-    case {TMPL_TYPE_POSIT64}: return &gPosit64;
+        cache.Insert(1, repr, entry(repr));
     }
+    bad += cache.Bytes() != 3 * entryBytes;
+
+#ifdef FLOATINFO_STATS
+    uint64_t hits = Stats::Counters()[STATS_CACHE_HIT]._calls;
+#endif
+    bad += !has(1, 1) || has(2, 1) || has(1, 4);
+#ifdef FLOATINFO_STATS
+    bad += Stats::Counters()[STATS_CACHE_HIT]._calls != hits + 1;
+#endif
+
+    // 2 is the least recently used now that 1 was looked up
+    cache.Insert(1, 4, entry(4));
+    bad += has(1, 2) || !has(1, 3) || !has(1, 1) || !has(1, 4);
+
+    // Inserting a cached encoding again replaces it and makes it the most recently used
+    cache.Insert(1, 3, entry(3));
+    bad += cache.Bytes() != 3 * entryBytes;
+    cache.Insert(2, 3, entry(3));
+    bad += has(1, 1) || !has(1, 4) || !has(1, 3) || !has(2, 3);
+
+    // Lowering the limit drops the oldest, entries larger than the limit are not kept
+    cache.SetLimit(entryBytes);
+    bad += cache.Bytes() != entryBytes || has(1, 4) || has(1, 3) || !has(2, 3);
+    cache.Insert(1, 5, entry(5, std::string(100, 'm')));
+    bad += has(1, 5) || !has(2, 3);
+    cache.SetLimit(0);
+    bad += cache.Bytes() != 0 || has(2, 3);
+    return bad == 0;
+}
 
-    return nullptr;
-};
+int main()
+{
+    fprintf(stderr, "Running tests...\n");
+
+    struct
+    {
+        const char *name;
+        bool (*run)();
+    } tests[] = {
+        { "initial strings", TestInitialStrings },
+        { "undo partial job", TestUndoPartialJob },
+        { "enumerate end", TestEnumerateEnd },
+        { "ordinals", TestOrdinals },
+        { "result cache", TestResultCache },
+        { "soft float", TestSoftFloat },
+        { "quire", TestQuire },
+        { "math tables", TestMathTables },
+        { "mx", TestMx },
+        { "expression", TestExpression },
+    };
 
+    int numFailed = 0;
+    for (const auto &test : tests)
+    {
+        bool isOk = test.run();
+        fprintf(stderr, "test %s = %d\n", test.name, isOk);
+        numFailed += !isOk;
+    }
+    return numFailed != 0;
 }
+
+#endif
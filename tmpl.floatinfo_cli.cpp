@@ -0,0 +1,1332 @@
+// Copyright 2023 Mustafa Serdar Sanli
+//
+// This file is part of FloatInfo.
+//
+// FloatInfo is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// FloatInfo is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with FloatInfo.  If not, see <https://www.gnu.org/licenses/>.
+
+// Native command line frontend, using the same editors as the web page
+
+#include <ctype.h>
+#include <errno.h>
+#include <limits.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "floatinfo.cpp"
+
+struct NamedCode
+{
+    const char *name;
+    int code;
+};
+
+static const NamedCode gStringCodes[] = {
+    { "SIGN",           {TMPL_IDENTIFIER_SIGN} },
+    { "EXPONENT",       {TMPL_IDENTIFIER_EXPONENT} },
+    { "MANTISSA",       {TMPL_IDENTIFIER_MANTISSA} },
+    { "MBITS",          {TMPL_IDENTIFIER_MBITS} },
+    { "REGIME",         {TMPL_IDENTIFIER_REGIME} },
+    { "NORMALIZED",     {TMPL_IDENTIFIER_NORMALIZED} },
+    { "EXPBIAS",        {TMPL_IDENTIFIER_EXPBIAS} },
+    { "BITSTRING",      {TMPL_STRCODE_BITSTRING} },
+    { "BYTES_PRETTY",   {TMPL_STRCODE_BYTES_PRETTY} },
+    { "URLHASH",        {TMPL_STRCODE_URLHASH} },
+    { "TYPENAME",       {TMPL_STRCODE_TYPENAME} },
+    { "TYPENAME_LONG",  {TMPL_STRCODE_TYPENAME_LONG} },
+    { "EXACT_BASE10",   {TMPL_STRCODE_EXACT_BASE10} },
+    { "EXACT_BASE2",    {TMPL_STRCODE_EXACT_BASE2} },
+    { "MATH",           {TMPL_STRCODE_MATH} },
+    { "SCIENTIFIC",     {TMPL_STRCODE_SCIENTIFIC} },
+    { "HEXFLOAT",       {TMPL_STRCODE_HEXFLOAT} },
+};
+
+static const NamedCode gIntCodes[] = {
+    { "IS_NORMAL",      {TMPL_BOOL_IS_NORMAL} },
+    { "IS_DENORMAL",    {TMPL_BOOL_IS_DENORMAL} },
+    { "IS_FRACTION",    {TMPL_BOOL_IS_FRACTION} },
+    { "IS_INTEGER",     {TMPL_BOOL_IS_INTEGER} },
+    { "IS_IEEE754",     {TMPL_BOOL_IS_IEEE754} },
+    { "IS_POSIT",       {TMPL_BOOL_IS_POSIT} },
+    { "IS_DECIMAL",     {TMPL_BOOL_IS_DECIMAL} },
+    { "IS_ANY",         {TMPL_BOOL_IS_ANY} },
+};
+
+static const NamedCode gConvertStatuses[] = {
+    { "exact",          {TMPL_CONVERT_EXACT} },
+    { "inexact",        {TMPL_CONVERT_INEXACT} },
+    { "overflow",       {TMPL_CONVERT_OVERFLOW} },
+    { "underflow",      {TMPL_CONVERT_UNDERFLOW} },
+    { "nan",            {TMPL_CONVERT_NAN} },
+};
+
+static const NamedCode gValueClasses[] = {
+    { "zero",           {TMPL_VALUECLASS_ZERO} },
+    { "subnormal",      {TMPL_VALUECLASS_SUBNORMAL} },
+    { "normal",         {TMPL_VALUECLASS_NORMAL} },
+    { "infinite",       {TMPL_VALUECLASS_INFINITE} },
+    { "nan",            {TMPL_VALUECLASS_NAN} },
+    { "nar",            {TMPL_VALUECLASS_NAR} },
+};
+
+static const char* ConvertStatusName(int status)
+{
+    for (const NamedCode &c : gConvertStatuses)
+    {
+        if (c.code == status)
+        {
+            return c.name;
+        }
+    }
+    return "?";
+}
+
+static int FindType(const char *name)
+{
+    for (int type = 1; type < {TMPL_TYPE_MAX}; ++type)
+    {
+        if (strcmp(get_type_name(type), name) == 0)
+        {
+            return type;
+        }
+    }
+    return 0;
+}
+
+static int FindStringCode(const char *name)
+{
+    for (const NamedCode &c : gStringCodes)
+    {
+        if (strcmp(c.name, name) == 0)
+        {
+            return c.code;
+        }
+    }
+    return 0;
+}
+
+// Thread counts are positive decimals that fit int, unlike atoi, which takes -1 and garbage
+static bool ParseThreadCount(const char *text, int &out)
+{
+    char *end;
+    errno = 0;
+    long val = strtol(text, &end, 10);
+    if (end == text || *end != '\0' || errno == ERANGE || val <= 0 || val > INT_MAX)
+    {
+        return false;
+    }
+    out = val;
+    return true;
+}
+
+// SetValue + GetString throughput on random binary64 values, with one editor per thread
+static int Bench(int maxThreads)
+{
+    constexpr auto Duration = std::chrono::seconds(1);
+
+    double singleThreadRate = 0;
+    for (int numThreads = 1; numThreads <= maxThreads; numThreads *= 2)
+    {
+        std::atomic<uint64_t> numOps{0};
+        std::vector<std::thread> threads;
+        for (int t = 0; t < numThreads; ++t)
+        {
+            threads.emplace_back([t, &numOps, Duration]()
+            {
+                Editor *e = e_create({TMPL_TYPE_BINARY64});
+                std::mt19937_64 rng(t + 1);
+                uint64_t ops = 0;
+                auto deadline = std::chrono::steady_clock::now() + Duration;
+                while (std::chrono::steady_clock::now() < deadline)
+                {
+                    for (int i = 0; i < 16; ++i)
+                    {
+                        char repr[32];
+                        snprintf(repr, sizeof(repr), "hex:%016llx", (unsigned long long)rng());
+                        e->SetValue({TMPL_SET_REPRSTR}, repr);
+                        e->GetString({TMPL_STRCODE_EXACT_BASE10});
+                        ++ops;
+                    }
+                }
+                numOps += ops;
+                e_destroy(e);
+            });
+        }
+        for (std::thread &t : threads)
+        {
+            t.join();
+        }
+
+        double rate = numOps / std::chrono::duration<double>(Duration).count();
+        if (numThreads == 1)
+        {
+            singleThreadRate = rate;
+        }
+        printf("%3d threads: %10.0f values/s  (%.2fx)\n", numThreads, rate, rate / singleThreadRate);
+    }
+    return 0;
+}
+
+// Line protocol server
+//
+// Every input line is one request, either whitespace separated
+//     [ID] TYPE REPRSTR [FIELD,FIELD...]
+// or a flat JSON object
+//     {"id": 7, "type": "binary64", "repr": "hex:000000000000f03f", "fields": ["EXACT_BASE10", "MATH"]}
+// and gets one response line in the same format, carrying the id of the request
+//     ID<TAB>VALUE<TAB>VALUE...
+//     {"id": 7, "EXACT_BASE10": "1", "MATH": "..."}
+// Requests without an id get their line number. Consecutive lines are handed to the workers in
+// batches, so responses of different batches can come back out of order.
+
+struct ServerField
+{
+    const char *name;
+    int code;
+    bool isInt;
+};
+
+static bool FindServerField(std::string_view name, ServerField &field)
+{
+    for (const NamedCode &c : gStringCodes)
+    {
+        if (name == c.name)
+        {
+            field = { c.name, c.code, false };
+            return true;
+        }
+    }
+    for (const NamedCode &c : gIntCodes)
+    {
+        if (name == c.name)
+        {
+            field = { c.name, c.code, true };
+            return true;
+        }
+    }
+    return false;
+}
+
+struct ServerRequest
+{
+    bool isJson;
+    std::string id; // Ready to print: raw for text requests, a JSON value for JSON requests
+    std::string type;
+    std::string repr;
+    std::vector<std::string> fields;
+};
+
+static void AppendJsonString(std::string &out, std::string_view str)
+{
+    out += '"';
+    for (char c : str)
+    {
+        switch (c)
+        {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\t': out += "\\t"; break;
+            case 0 ... 8:
+            case 11 ... 31:
+            {
+                char buf[8];
+                snprintf(buf, sizeof(buf), "\\u%04x", c);
+                out += buf;
+                break;
+            }
+            default: out += c;
+        }
+    }
+    out += '"';
+}
+
+// Just enough JSON to read one flat request object
+struct JsonReader
+{
+    std::string_view _s;
+    size_t _pos = 0;
+
+    void SkipSpace()
+    {
+        while (_pos < _s.size() && (_s[_pos] == ' ' || _s[_pos] == '\t' || _s[_pos] == '\r'))
+        {
+            ++_pos;
+        }
+    }
+
+    bool Consume(char c)
+    {
+        SkipSpace();
+        if (_pos < _s.size() && _s[_pos] == c)
+        {
+            ++_pos;
+            return true;
+        }
+        return false;
+    }
+
+    bool ReadString(std::string &out)
+    {
+        out.clear();
+        if (!Consume('"'))
+        {
+            return false;
+        }
+        while (_pos < _s.size())
+        {
+            char c = _s[_pos++];
+            if (c == '"')
+            {
+                return true;
+            }
+            if (c != '\\')
+            {
+                out += c;
+                continue;
+            }
+            if (_pos >= _s.size())
+            {
+                return false;
+            }
+            switch (c = _s[_pos++])
+            {
+                case 'b': out += '\b'; break;
+                case 'f': out += '\f'; break;
+                case 'n': out += '\n'; break;
+                case 'r': out += '\r'; break;
+                case 't': out += '\t'; break;
+                case 'u':
+                {
+                    // Requests are plain ascii, anything else is kept as utf-8 for the error message
+                    if (_pos + 4 > _s.size())
+                    {
+                        return false;
+                    }
+                    uint32_t cp = 0;
+                    for (int i = 0; i < 4; ++i)
+                    {
+                        char h = tolower(_s[_pos++]);
+                        if (!isxdigit(h)) return false;
+                        cp = cp << 4 | (h <= '9' ? h - '0' : h - 'a' + 10);
+                    }
+                    if (cp < 0x80)
+                    {
+                        out += char(cp);
+                    }
+                    else if (cp < 0x800)
+                    {
+                        out += char(0xc0 | cp >> 6);
+                        out += char(0x80 | (cp & 0x3f));
+                    }
+                    else
+                    {
+                        out += char(0xe0 | cp >> 12);
+                        out += char(0x80 | (cp >> 6 & 0x3f));
+                        out += char(0x80 | (cp & 0x3f));
+                    }
+                    break;
+                }
+                default: out += c;
+            }
+        }
+        return false;
+    }
+
+    // Numbers, true, false and null, returned verbatim
+    bool ReadToken(std::string &out)
+    {
+        SkipSpace();
+        size_t start = _pos;
+        while (_pos < _s.size() && (isalnum(_s[_pos]) || _s[_pos] == '-' || _s[_pos] == '+' || _s[_pos] == '.'))
+        {
+            ++_pos;
+        }
+        out = _s.substr(start, _pos - start);
+        return _pos > start;
+    }
+
+    bool ReadScalar(std::string &out, bool &isString)
+    {
+        SkipSpace();
+        isString = (_pos < _s.size() && _s[_pos] == '"');
+        return isString ? ReadString(out) : ReadToken(out);
+    }
+};
+
+static bool ParseJsonRequest(std::string_view line, ServerRequest &req, const char *&err)
+{
+    JsonReader r{line};
+    std::string key;
+    std::string value;
+    bool isString;
+
+    err = "malformed json";
+    if (!r.Consume('{'))
+    {
+        return false;
+    }
+    if (r.Consume('}'))
+    {
+        return true;
+    }
+    do
+    {
+        if (!r.ReadString(key) || !r.Consume(':'))
+        {
+            return false;
+        }
+
+        if (key == "fields" && r.Consume('['))
+        {
+            if (r.Consume(']'))
+            {
+                continue;
+            }
+            do
+            {
+                if (!r.ReadString(value))
+                {
+                    return false;
+                }
+                req.fields.push_back(value);
+            } while (r.Consume(','));
+            if (!r.Consume(']'))
+            {
+                return false;
+            }
+            continue;
+        }
+
+        if (!r.ReadScalar(value, isString))
+        {
+            return false;
+        }
+        if (key == "id")
+        {
+            if (isString && value[0] == '#')
+            {
+                err = "ids starting with # are for requests without one";
+                return false;
+            }
+            req.id.clear();
+            if (isString)
+            {
+                AppendJsonString(req.id, value);
+            }
+            else
+            {
+                req.id = value;
+            }
+        }
+        else if (key == "type")
+        {
+            req.type = value;
+        }
+        else if (key == "repr")
+        {
+            req.repr = value;
+        }
+        else if (key == "fields")
+        {
+            // Also accept the comma separated form of the text protocol
+            req.fields.push_back(value);
+        }
+    } while (r.Consume(','));
+
+    if (!r.Consume('}'))
+    {
+        return false;
+    }
+    r.SkipSpace();
+    return r._pos == line.size();
+}
+
+static bool ParseTextRequest(std::string_view line, ServerRequest &req, const char *&err)
+{
+    std::string_view tokens[4];
+    int numTokens = 0;
+    size_t pos = 0;
+    while (true)
+    {
+        while (pos < line.size() && (line[pos] == ' ' || line[pos] == '\t' || line[pos] == '\r'))
+        {
+            ++pos;
+        }
+        if (pos == line.size())
+        {
+            break;
+        }
+        size_t start = pos;
+        while (pos < line.size() && line[pos] != ' ' && line[pos] != '\t' && line[pos] != '\r')
+        {
+            ++pos;
+        }
+        if (numTokens == 4)
+        {
+            err = "too many columns";
+            return false;
+        }
+        tokens[numTokens++] = line.substr(start, pos - start);
+    }
+
+    // An id column is told apart from a type by not naming a type
+    int first = 0;
+    if (numTokens == 4 || (numTokens >= 2 && FindType(std::string(tokens[0]).c_str()) == 0))
+    {
+        if (tokens[0][0] == '#')
+        {
+            err = "ids starting with # are for requests without one";
+            return false;
+        }
+        req.id = tokens[0];
+        first = 1;
+    }
+    if (numTokens - first < 2)
+    {
+        err = "expected [ID] TYPE REPRSTR [FIELD,FIELD...]";
+        return false;
+    }
+    req.type = tokens[first];
+    req.repr = tokens[first + 1];
+    if (numTokens - first == 3)
+    {
+        req.fields.emplace_back(tokens[first + 2]);
+    }
+    return true;
+}
+
+// Holds one editor of each type, created on first use, for the thread that owns it
+struct ServerWorkerState
+{
+    Editor *_editors[{TMPL_TYPE_MAX}] = {};
+    ServerRequest _req;
+    std::vector<ServerField> _fields;
+
+    ~ServerWorkerState()
+    {
+        for (Editor *e : _editors)
+        {
+            if (e != nullptr) e_destroy(e);
+        }
+    }
+
+    void HandleLine(std::string_view line, uint64_t lineNo, std::string &out)
+    {
+        while (!line.empty() && (line.back() == '\r' || line.back() == ' '))
+        {
+            line.remove_suffix(1);
+        }
+        if (line.empty())
+        {
+            return;
+        }
+
+        // Requests without an id are answered with #LINE, which client ids can not be
+        _req.isJson = (line[0] == '{');
+        _req.id = "#" + std::to_string(lineNo);
+        if (_req.isJson)
+        {
+            _req.id = "\"" + _req.id + "\"";
+        }
+        _req.type.clear();
+        _req.repr.clear();
+        _req.fields.clear();
+
+        const char *err = nullptr;
+        bool ok = (_req.isJson ? ParseJsonRequest(line, _req, err) : ParseTextRequest(line, _req, err));
+        if (ok)
+        {
+            err = handleRequest(out);
+        }
+        if (err != nullptr)
+        {
+            appendError(err, out);
+        }
+    }
+
+private:
+    // Appends the response and returns nullptr, or returns the error without appending anything
+    const char *handleRequest(std::string &out)
+    {
+        int type = FindType(_req.type.c_str());
+        if (type == 0)
+        {
+            return "unknown type";
+        }
+
+        _fields.clear();
+        for (const std::string &list : _req.fields)
+        {
+            std::string_view rest = list;
+            while (!rest.empty())
+            {
+                size_t comma = std::min(rest.find(','), rest.size());
+                ServerField field;
+                if (!FindServerField(rest.substr(0, comma), field))
+                {
+                    return "unknown field";
+                }
+                _fields.push_back(field);
+                rest.remove_prefix(std::min(comma + 1, rest.size()));
+            }
+        }
+        if (_fields.empty())
+        {
+            for (const NamedCode &c : gStringCodes)
+            {
+                _fields.push_back({ c.name, c.code, false });
+            }
+        }
+
+        Editor *&e = _editors[type];
+        if (e == nullptr)
+        {
+            e = e_create(type);
+        }
+        if (!e->IsReprString(_req.repr.c_str()))
+        {
+            return "invalid REPRSTR";
+        }
+        e->SetValue({TMPL_SET_REPRSTR}, _req.repr.c_str());
+
+        if (_req.isJson)
+        {
+            out += "{\"id\": ";
+            out += _req.id;
+        }
+        else
+        {
+            out += _req.id;
+        }
+        for (const ServerField &field : _fields)
+        {
+            char intBuf[16];
+            const char *value = intBuf;
+            if (field.isInt)
+            {
+                snprintf(intBuf, sizeof(intBuf), "%d", e->GetInt(field.code));
+            }
+            else
+            {
+                value = e->GetString(field.code);
+            }
+
+            if (_req.isJson)
+            {
+                out += ", \"";
+                out += field.name;
+                out += "\": ";
+                if (field.isInt)
+                {
+                    out += value;
+                }
+                else
+                {
+                    AppendJsonString(out, value);
+                }
+            }
+            else
+            {
+                out += '\t';
+                size_t start = out.size();
+                out += value;
+                // Keep one response per line
+                std::replace(out.begin() + start, out.end(), '\t', ' ');
+                std::replace(out.begin() + start, out.end(), '\n', ' ');
+            }
+        }
+        out += (_req.isJson ? "}\n" : "\n");
+        return nullptr;
+    }
+
+    void appendError(const char *err, std::string &out)
+    {
+        if (_req.isJson)
+        {
+            out += "{\"id\": ";
+            out += _req.id;
+            out += ", \"error\": ";
+            AppendJsonString(out, err);
+            out += "}\n";
+        }
+        else
+        {
+            out += _req.id;
+            out += "\terror: ";
+            out += err;
+            out += '\n';
+        }
+    }
+};
+
+// One input stream and where its responses go, alive until its reader and all its batches are done
+struct ServerConnection
+{
+    int _inFd;
+    int _outFd;
+    std::mutex _writeMutex;
+    bool _isBroken = false;
+
+    ServerConnection(int inFd, int outFd) : _inFd(inFd), _outFd(outFd) {}
+
+    ~ServerConnection()
+    {
+        if (_inFd > 2) close(_inFd);
+        if (_outFd > 2 && _outFd != _inFd) close(_outFd);
+    }
+
+    void Write(const std::string &data)
+    {
+        std::lock_guard<std::mutex> lock(_writeMutex);
+        size_t pos = 0;
+        while (!_isBroken && pos < data.size())
+        {
+            ssize_t n = write(_outFd, data.data() + pos, data.size() - pos);
+            if (n < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            if (n <= 0)
+            {
+                _isBroken = true;
+                break;
+            }
+            pos += n;
+        }
+    }
+};
+
+struct ServerBatch
+{
+    std::shared_ptr<ServerConnection> _conn;
+    uint64_t _firstLineNo;
+    std::string _lines;
+};
+
+class ServerPool
+{
+public:
+    explicit ServerPool(int numThreads)
+    {
+        for (int i = 0; i < numThreads; ++i)
+        {
+            _threads.emplace_back([this]() { work(); });
+        }
+    }
+
+    // Blocks while the workers are behind, so a fast producer does not queue up unbounded input
+    void Push(ServerBatch &&batch)
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _notFull.wait(lock, [this]() { return _queue.size() < MaxQueuedBatches; });
+        _queue.push_back(std::move(batch));
+        _notEmpty.notify_one();
+    }
+
+    // Answers everything queued so far, then stops the workers
+    void Finish()
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _isClosing = true;
+        }
+        _notEmpty.notify_all();
+        for (std::thread &t : _threads)
+        {
+            t.join();
+        }
+    }
+
+private:
+    static constexpr size_t MaxQueuedBatches = 64;
+
+    void work()
+    {
+        ServerWorkerState state;
+        std::string out;
+        while (true)
+        {
+            ServerBatch batch;
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                _notEmpty.wait(lock, [this]() { return _isClosing || !_queue.empty(); });
+                if (_queue.empty())
+                {
+                    return;
+                }
+                batch = std::move(_queue.front());
+                _queue.pop_front();
+            }
+            _notFull.notify_one();
+
+            out.clear();
+            std::string_view rest = batch._lines;
+            uint64_t lineNo = batch._firstLineNo;
+            while (!rest.empty())
+            {
+                size_t eol = std::min(rest.find('\n'), rest.size());
+                state.HandleLine(rest.substr(0, eol), lineNo++, out);
+                rest.remove_prefix(std::min(eol + 1, rest.size()));
+            }
+            if (!out.empty())
+            {
+                batch._conn->Write(out);
+            }
+        }
+    }
+
+    std::vector<std::thread> _threads;
+    std::mutex _mutex;
+    std::condition_variable _notEmpty;
+    std::condition_variable _notFull;
+    std::deque<ServerBatch> _queue;
+    bool _isClosing = false;
+};
+
+// Cuts the input into batches of whole lines. Whatever a read returns is queued right away, so
+// an interactive client is answered without waiting for a batch to fill up.
+static void ServeConnection(ServerPool &pool, std::shared_ptr<ServerConnection> conn)
+{
+    constexpr size_t MaxBatchLines = 256;
+
+    std::vector<char> buf(1 << 16);
+    std::string partial;
+    uint64_t lineNo = 1;
+    while (true)
+    {
+        ssize_t n = read(conn->_inFd, buf.data(), buf.size());
+        if (n < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (n <= 0)
+        {
+            break;
+        }
+
+        std::string_view data(buf.data(), n);
+        while (true)
+        {
+            size_t end = 0;
+            size_t numLines = 0;
+            while (numLines < MaxBatchLines)
+            {
+                size_t eol = data.find('\n', end);
+                if (eol == std::string_view::npos) break;
+                end = eol + 1;
+                ++numLines;
+            }
+            if (numLines == 0)
+            {
+                break;
+            }
+
+            ServerBatch batch{conn, lineNo, std::move(partial)};
+            batch._lines.append(data.data(), end);
+            pool.Push(std::move(batch));
+            partial.clear();
+            data.remove_prefix(end);
+            lineNo += numLines;
+        }
+        partial.append(data);
+    }
+
+    if (!partial.empty())
+    {
+        pool.Push(ServerBatch{conn, lineNo, std::move(partial)});
+    }
+}
+
+static int Serve(int numThreads, const char *socketPath)
+{
+    // Clients going away are noticed through write errors
+    signal(SIGPIPE, SIG_IGN);
+
+    ServerPool pool(numThreads);
+    if (socketPath == nullptr)
+    {
+        ServeConnection(pool, std::make_shared<ServerConnection>(0, 1));
+        pool.Finish();
+        return 0;
+    }
+
+    sockaddr_un addr = {};
+    addr.sun_family = AF_UNIX;
+    if (strlen(socketPath) >= sizeof(addr.sun_path))
+    {
+        fprintf(stderr, "socket path too long [%s]\n", socketPath);
+        return 1;
+    }
+    strcpy(addr.sun_path, socketPath);
+
+    int listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+    unlink(socketPath);
+    if (listenFd < 0 || bind(listenFd, (sockaddr *)&addr, sizeof(addr)) != 0 || listen(listenFd, 64) != 0)
+    {
+        fprintf(stderr, "cannot listen on [%s]: %s\n", socketPath, strerror(errno));
+        return 1;
+    }
+
+    while (true)
+    {
+        int fd = accept(listenFd, nullptr, nullptr);
+        if (fd < 0)
+        {
+            if (errno == EINTR || errno == ECONNABORTED) continue;
+            fprintf(stderr, "accept failed: %s\n", strerror(errno));
+            break;
+        }
+        std::thread([&pool, fd]() { ServeConnection(pool, std::make_shared<ServerConnection>(fd, fd)); }).detach();
+    }
+    pool.Finish();
+    return 1;
+}
+
+// Runs the expression in every type with soft float arithmetic, with the variables given as
+// NAME=DECIMAL rounded to nearest in each type, and prints each result next to the exact value of
+// the expression on the rounded variables, the distance in ulps to that value correctly rounded, and
+// the relative error.
+static int Expr(int argc, char **argv)
+{
+    Expression expr;
+    if (!expr.Compile(argv[0]))
+    {
+        fprintf(stderr, "%s\n", expr.error.c_str());
+        return 1;
+    }
+
+    std::vector<ExactNumber> values(expr.varNames.size());
+    std::vector<bool> isGiven(expr.varNames.size());
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string_view arg = argv[i];
+        size_t eq = std::min(arg.find('='), arg.size());
+        std::string_view num = arg.substr(std::min(eq + 1, arg.size()));
+        bool isNegative = !num.empty() && num[0] == '-';
+        int idx = std::find(expr.varNames.begin(), expr.varNames.end(), arg.substr(0, eq)) - expr.varNames.begin();
+        if (eq == arg.size() || idx == (int)expr.varNames.size()
+            || !ExactNumber::Parse(num.substr(isNegative), values[idx]))
+        {
+            fprintf(stderr, "bad variable [%s]\n", argv[i]);
+            return 1;
+        }
+        values[idx].sign = isNegative;
+        isGiven[idx] = true;
+    }
+    for (size_t v = 0; v < expr.varNames.size(); ++v)
+    {
+        if (!isGiven[v])
+        {
+            fprintf(stderr, "missing variable [%s]\n", expr.varNames[v].c_str());
+            return 1;
+        }
+    }
+
+    printf("TYPE\tRESULT\tEXACT\tULPS\tRELERR\n");
+    for (int type = 1; type < {TMPL_TYPE_MAX}; ++type)
+    {
+        ExpressionFormat format;
+        if (!DispatchRepr(type, [&](auto repr) { format = ExpressionFormat::Of<decltype(repr)>(); }))
+        {
+            continue;
+        }
+
+        std::vector<uint64_t> vars;
+        for (const ExactNumber &val : values)
+        {
+            vars.push_back(format.round(val.ToUnpacked(), ROUND_NEAREST_EVEN));
+        }
+
+        ExpressionEvaluator eval(expr, format, ROUND_NEAREST_EVEN);
+        uint64_t res, ulps;
+        double relError;
+        eval.Evaluate(vars.data(), &res, &ulps, &relError);
+        double exact = eval.RunExact(vars.data()).ToDouble();
+        double resDouble = ExactNumber::FromUnpacked(format.unpack(res)).ToDouble();
+
+        std::string ulpStr = ulps == ExpressionEvaluator::Unordered ? "-" : std::to_string(ulps);
+        printf("%s\t%.17g\t%.17g\t%s\t%.3g\n", get_type_name(type), resDouble, exact, ulpStr.c_str(), relError);
+    }
+    return 0;
+}
+
+// Converts the value to every type that fits 64 bits, rounded to nearest, and prints the encodings
+// with their values, TMPL_CONVERT_* statuses and relative errors
+static int Convert(Editor *e)
+{
+    std::vector<int> types;
+    for (int type = 1; type < {TMPL_TYPE_MAX}; ++type)
+    {
+        if (DispatchRepr(type, [](auto) {}))
+        {
+            types.push_back(type);
+        }
+    }
+
+    size_t n = types.size();
+    std::vector<uint64_t> reprs(n);
+    std::vector<double> values(n), relErrors(n);
+    std::vector<int> statuses(n);
+    e_convert(e, {TMPL_ROUND_NEAREST_EVEN}, types.data(), n, reprs.data(), values.data(), statuses.data(), relErrors.data());
+
+    printf("TYPE\tENCODING\tVALUE\tSTATUS\tRELERR\n");
+    for (size_t i = 0; i < n; ++i)
+    {
+        printf("%s\t0x%llx\t%.17g\t%s\t%.3g\n", get_type_name(types[i]), (unsigned long long)reprs[i], values[i],
+               ConvertStatusName(statuses[i]), relErrors[i]);
+    }
+    return 0;
+}
+
+// Writes EXACT_BASE10 of the value to stdout as it is generated, without holding all of it
+static int Digits(Editor *e)
+{
+    ExactDecimalStream *stream = e_exact_stream_begin(e);
+    if (!stream)
+    {
+        printf("%s\n", e->GetString({TMPL_STRCODE_EXACT_BASE10}));
+        return 0;
+    }
+
+    char buf[4096];
+    while (int n = e_exact_stream_next(stream, buf, sizeof(buf)))
+    {
+        fwrite(buf, 1, n, stdout);
+    }
+    printf("\n");
+    e_exact_stream_end(stream);
+    return 0;
+}
+
+// Prints the number of encodings of each class and of the integers, and the number of values in
+// [lo, hi) when given
+static int Counts(int type, const char *lo, const char *hi)
+{
+    uint64_t classCounts[{TMPL_VALUECLASS_MAX}];
+    uint64_t numIntegers, maxContiguous;
+    if (!e_class_counts(type, classCounts) || !e_integer_counts(type, &numIntegers, &maxContiguous))
+    {
+        fprintf(stderr, "counts are only for the types that fit 64 bits\n");
+        return 1;
+    }
+
+    int numBits = 0;
+    DispatchRepr(type, [&](auto repr) { numBits = decltype(repr)::NumBits; });
+    double numEncodings = ldexp(1, numBits);
+    for (const NamedCode &c : gValueClasses)
+    {
+        if (classCounts[c.code])
+        {
+            printf("%s\t%llu\t%.6g\n", c.name, (unsigned long long)classCounts[c.code], classCounts[c.code] / numEncodings);
+        }
+    }
+    printf("integer\t%llu\t%.6g\n", (unsigned long long)numIntegers, numIntegers / numEncodings);
+    printf("max_contiguous_integer\t%llu\n", (unsigned long long)maxContiguous);
+
+    if (lo)
+    {
+        char *loEnd;
+        char *hiEnd;
+        double loVal = strtod(lo, &loEnd);
+        double hiVal = strtod(hi, &hiEnd);
+        if (loEnd == lo || *loEnd != '\0' || hiEnd == hi || *hiEnd != '\0')
+        {
+            fprintf(stderr, "bad range [%s, %s)\n", lo, hi);
+            return 1;
+        }
+        uint64_t count;
+        e_counts_between(type, &loVal, &hiVal, &count, 1);
+        printf("in [%s, %s)\t%llu\n", lo, hi, (unsigned long long)count);
+    }
+    return 0;
+}
+
+static int Usage()
+{
+    fprintf(stderr, "usage: floatinfo [--stats] TYPE REPRSTR [FIELD...]\n");
+    fprintf(stderr, "       floatinfo [--stats] bench [MAX_THREADS]\n");
+    fprintf(stderr, "       floatinfo [--stats] serve [--threads N] [--socket PATH]\n");
+    fprintf(stderr, "       floatinfo [--stats] expr EXPR [NAME=DECIMAL...]\n");
+    fprintf(stderr, "       floatinfo [--stats] convert TYPE REPRSTR\n");
+    fprintf(stderr, "       floatinfo [--stats] digits TYPE REPRSTR\n");
+    fprintf(stderr, "       floatinfo [--stats] counts TYPE [LO HI]\n");
+    fprintf(stderr, "  --stats  prints the counters of a FLOATINFO_STATS build to stderr at exit\n");
+    fprintf(stderr, "  TYPE     one of:");
+    for (int type = 1; type < {TMPL_TYPE_MAX}; ++type)
+    {
+        fprintf(stderr, " %s", get_type_name(type));
+    }
+    fprintf(stderr, "\n  REPRSTR  little endian bytes as in the url, e.g. hex:000000000000f03f\n");
+    fprintf(stderr, "  FIELD    one of:");
+    for (const NamedCode &c : gStringCodes)
+    {
+        fprintf(stderr, " %s", c.name);
+    }
+    fprintf(stderr, "\n           all fields are printed when none is given\n");
+    fprintf(stderr, "  serve    answers one request per line on stdin or the socket, as\n");
+    fprintf(stderr, "           [ID] TYPE REPRSTR [FIELD,FIELD...] or {\"id\": ..., \"type\": ..., \"repr\": ..., \"fields\": [...]}\n");
+    fprintf(stderr, "           where FIELD may also be one of:");
+    for (const NamedCode &c : gIntCodes)
+    {
+        fprintf(stderr, " %s", c.name);
+    }
+    fprintf(stderr, "\n  expr     runs EXPR, of + - * / ( ) and decimals, in every type that fits 64 bits,\n");
+    fprintf(stderr, "           and compares each result with the exact value\n");
+    fprintf(stderr, "  convert  rounds the value to every type that fits 64 bits\n");
+    fprintf(stderr, "  digits   streams EXACT_BASE10 as it is generated\n");
+    fprintf(stderr, "  counts   counts the encodings of each class and the integers, and the values in [LO, HI)\n");
+    return 1;
+}
+
+static int Run(int argc, char **argv)
+{
+    if (argc >= 2 && strcmp(argv[1], "bench") == 0)
+    {
+        int maxThreads = std::thread::hardware_concurrency();
+        if (argc >= 3 && !ParseThreadCount(argv[2], maxThreads))
+        {
+            fprintf(stderr, "bad thread count [%s]\n", argv[2]);
+            return Usage();
+        }
+        return Bench(std::max(maxThreads, 1));
+    }
+
+    if (argc >= 2 && strcmp(argv[1], "serve") == 0)
+    {
+        int numThreads = std::thread::hardware_concurrency();
+        const char *socketPath = nullptr;
+        for (int i = 2; i < argc; ++i)
+        {
+            if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+            {
+                if (!ParseThreadCount(argv[++i], numThreads))
+                {
+                    fprintf(stderr, "bad thread count [%s]\n", argv[i]);
+                    return Usage();
+                }
+            }
+            else if (strcmp(argv[i], "--socket") == 0 && i + 1 < argc)
+            {
+                socketPath = argv[++i];
+            }
+            else
+            {
+                return Usage();
+            }
+        }
+        return Serve(std::max(numThreads, 1), socketPath);
+    }
+
+    if (argc >= 3 && strcmp(argv[1], "expr") == 0)
+    {
+        return Expr(argc - 2, argv + 2);
+    }
+
+    if ((argc == 3 || argc == 5) && strcmp(argv[1], "counts") == 0)
+    {
+        int type = FindType(argv[2]);
+        if (type == 0)
+        {
+            fprintf(stderr, "unknown type [%s]\n", argv[2]);
+            return Usage();
+        }
+        return Counts(type, argc == 5 ? argv[3] : nullptr, argc == 5 ? argv[4] : nullptr);
+    }
+
+    bool isConvert = (argc == 4 && strcmp(argv[1], "convert") == 0);
+    bool isDigits = (argc == 4 && strcmp(argv[1], "digits") == 0);
+    if (isConvert || isDigits)
+    {
+        --argc;
+        ++argv;
+    }
+
+    if (argc < 3)
+    {
+        return Usage();
+    }
+
+    int type = FindType(argv[1]);
+    if (type == 0)
+    {
+        fprintf(stderr, "unknown type [%s]\n", argv[1]);
+        return Usage();
+    }
+
+    Editor *e = get_fe(type);
+    if (!e->IsReprString(argv[2]))
+    {
+        fprintf(stderr, "invalid REPRSTR [%s]\n", argv[2]);
+        return Usage();
+    }
+    if (isDigits)
+    {
+        // Leaves the exact value to the stream
+        e->SetValueDeferred({TMPL_SET_REPRSTR}, argv[2]);
+        return Digits(e);
+    }
+    e->SetValue({TMPL_SET_REPRSTR}, argv[2]);
+
+    if (isConvert)
+    {
+        return Convert(e);
+    }
+
+    if (argc == 3)
+    {
+        for (const NamedCode &c : gStringCodes)
+        {
+            printf("%s\t%s\n", c.name, e->GetString(c.code));
+        }
+        return 0;
+    }
+
+    for (int i = 3; i < argc; ++i)
+    {
+        int code = FindStringCode(argv[i]);
+        if (code == 0)
+        {
+            fprintf(stderr, "unknown field [%s]\n", argv[i]);
+            return Usage();
+        }
+        printf("%s\n", e->GetString(code));
+    }
+    return 0;
+}
+
+#ifdef RUN_TEST_CLI
+
+// Malformed requests are answered with an error line carrying their id, or #LINE without one
+static bool TestServerRequests()
+{
+    static const char *const cases[][2] = {
+        { "binary16 hex:003c EXACT_BASE10", "#1\t1.0000000000\n" },
+        { "4 binary16 hex:003c EXACT_BASE10", "4\t1.0000000000\n" },
+        { "4 binary16", "4\terror: expected [ID] TYPE REPRSTR [FIELD,FIELD...]\n" },
+        { "binary16 1.0", "#4\terror: invalid REPRSTR\n" },
+        { "5 binary16 hex:zz3c EXACT_BASE10", "5\terror: invalid REPRSTR\n" },
+        { "6 binary16 hex:3c", "6\terror: invalid REPRSTR\n" },
+        { "6 e2m1 hex:1f", "6\terror: invalid REPRSTR\n" },
+        { "#1 binary16 hex:003c", "#8\terror: ids starting with # are for requests without one\n" },
+        { "4 binary17 hex:003c", "4\terror: unknown type\n" },
+        { "{\"type\": \"binary16\", \"repr\": \"hex:003c\", \"fields\": [\"EXACT_BASE10\"]}", "{\"id\": \"#10\", \"EXACT_BASE10\": \"1.0000000000\"}\n" },
+        { "{\"id\": 3, \"type\": \"binary16\"}", "{\"id\": 3, \"error\": \"invalid REPRSTR\"}\n" },
+        { "{\"id\": \"#1\", \"type\": \"binary16\", \"repr\": \"hex:003c\"}", "{\"id\": \"#12\", \"error\": \"ids starting with # are for requests without one\"}\n" },
+        { "{\"id\": 3, \"type\": \"binary16\", \"repr\": \"hex:003c\"", "{\"id\": 3, \"error\": \"malformed json\"}\n" },
+        { "binary16 hex:003c EXACT_BASE10 extra junk", "#14\terror: too many columns\n" },
+        { "7 binary16 hex:003c EXACT_BASE10 extra", "#15\terror: too many columns\n" },
+    };
+
+    ServerWorkerState state;
+    int bad = 0;
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); ++i)
+    {
+        std::string out;
+        state.HandleLine(cases[i][0], i + 1, out);
+        if (out != cases[i][1])
+        {
+            fprintf(stderr, "line %zu: [%s] gave [%s]\n", i + 1, cases[i][0], out.c_str());
+            ++bad;
+        }
+    }
+    return bad == 0;
+}
+
+// Variables that are not in the expression, given without a value or not given at all are errors,
+// as are indices past the variables
+static bool TestExprVariables()
+{
+    static const std::vector<const char *> cases[] = {
+        { "a +" },
+        { "a + b", "a=1" },
+        { "a + b", "a=1", "b=2", "c=3" },
+        { "a + b", "a=1", "b" },
+        { "a + b", "a=1", "b=x" },
+    };
+
+    int bad = 0;
+    for (std::vector<const char *> args : cases)
+    {
+        bad += Expr(args.size(), (char **)args.data()) != 1;
+    }
+
+    Expression *expr = e_expr_compile("b * a - b");
+    bad += e_expr_num_vars(expr) != 2 || strcmp(e_expr_var_name(expr, 1), "a") != 0;
+    bad += e_expr_var_name(expr, 2) != nullptr || e_expr_var_name(expr, -1) != nullptr;
+    e_expr_destroy(expr);
+    return bad == 0;
+}
+
+// Thread counts that are not positive ints are rejected rather than wrapped or read as 0
+static bool TestThreadCounts()
+{
+    int bad = 0;
+    int n = 0;
+    bad += !ParseThreadCount("1", n) || n != 1 || !ParseThreadCount("64", n) || n != 64;
+    for (const char *text : { "", "0", "-1", "-4294967295", "2147483648", "99999999999999999999", "4x", "x", " " })
+    {
+        bad += ParseThreadCount(text, n);
+    }
+    return bad == 0;
+}
+
+int main()
+{
+    fprintf(stderr, "Running tests...\n");
+    bool isOk = TestServerRequests();
+    fprintf(stderr, "test server requests = %d\n", isOk);
+    bool isExprOk = TestExprVariables();
+    fprintf(stderr, "test expr variables = %d\n", isExprOk);
+    bool isThreadsOk = TestThreadCounts();
+    fprintf(stderr, "test thread counts = %d\n", isThreadsOk);
+    return !isOk || !isExprOk || !isThreadsOk;
+}
+
+#else
+
+int main(int argc, char **argv)
+{
+    bool printStats = (argc >= 2 && strcmp(argv[1], "--stats") == 0);
+    if (printStats)
+    {
+        --argc;
+        ++argv;
+    }
+
+    int res = Run(argc, argv);
+    if (printStats)
+    {
+        fprintf(stderr, "%s\n", e_get_stats());
+    }
+    return res;
+}
+
+#endif